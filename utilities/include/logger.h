@@ -17,6 +17,42 @@
  #define LOGGER_H
  
  #include <stddef.h>
+ #include <stdint.h>
+ 
+ /**
+  * @def LOGGER_ASYNC_MESSAGE_SIZE
+  * @brief Maximum message length kept by a queued record, terminator included.
+  *
+  * Longer messages are truncated in asynchronous mode. It is also the room
+  * for the captured arguments of logger_logf().
+  */
+ #ifndef LOGGER_ASYNC_MESSAGE_SIZE
+ #define LOGGER_ASYNC_MESSAGE_SIZE 256u
+ #endif
+ 
+ /**
+  * @def LOGGER_ASYNC_TIMESTAMP_SIZE
+  * @brief Maximum timestamp length kept by a queued record, terminator included.
+  */
+ #ifndef LOGGER_ASYNC_TIMESTAMP_SIZE
+ #define LOGGER_ASYNC_TIMESTAMP_SIZE 32u
+ #endif
+ 
+ /**
+  * @def LOGGER_ASYNC_BATCH
+  * @brief Number of records taken from the queue at once by the consumer.
+  */
+ #ifndef LOGGER_ASYNC_BATCH
+ #define LOGGER_ASYNC_BATCH 16u
+ #endif
+ 
+ /**
+  * @def LOGGER_MAX_SINKS
+  * @brief Number of sinks that can be registered with logger_add_sink().
+  */
+ #ifndef LOGGER_MAX_SINKS
+ #define LOGGER_MAX_SINKS 8u
+ #endif
  
  /**
   * @brief Log levels.
@@ -29,6 +65,64 @@
      LOGGER_LEVEL_MAX
  } LoggerLevel;
  
+ /**
+  * @def LOGGER_MIN_LEVEL
+  * @brief Lowest level compiled in by the LOGGER_* macros.
+  *
+  * Calls below it are removed by the compiler, arguments included. Set
+  * to LOGGER_LEVEL_INFO in release builds, LOGGER_LEVEL_MAX to remove all.
+  */
+ #ifndef LOGGER_MIN_LEVEL
+ #define LOGGER_MIN_LEVEL LOGGER_LEVEL_DEBUG
+ #endif
+ 
+ /**
+  * @def LOGGER_MAX_MODULES
+  * @brief Number of modules with their own level, the default module included.
+  */
+ #ifndef LOGGER_MAX_MODULES
+ #define LOGGER_MAX_MODULES 32u
+ #endif
+ 
+ /**
+  * @def LOGGER_MODULE_NAME_SIZE
+  * @brief Maximum module name length, terminator included.
+  */
+ #ifndef LOGGER_MODULE_NAME_SIZE
+ #define LOGGER_MODULE_NAME_SIZE 16u
+ #endif
+ 
+ /**
+  * @def LOGGER_MODULE_DEFAULT
+  * @brief Module of logger_log_message() and logger_logf(); follows the global level.
+  */
+ #define LOGGER_MODULE_DEFAULT 0
+ 
+ /**
+  * @brief Logs a printf-style message if level is compiled in (see LOGGER_MIN_LEVEL).
+  */
+ #define LOGGER_LOGF(level, ...) \
+     do { \
+         if ((level) >= LOGGER_MIN_LEVEL) { \
+             logger_logf((level), __VA_ARGS__); \
+         } \
+     } while (0)
+ 
+ /**
+  * @brief Same as LOGGER_LOGF() for a module registered with logger_register_module().
+  */
+ #define LOGGER_MODULE_LOGF(module, level, ...) \
+     do { \
+         if ((level) >= LOGGER_MIN_LEVEL) { \
+             logger_logf_module((module), (level), __VA_ARGS__); \
+         } \
+     } while (0)
+ 
+ #define LOGGER_DEBUG(...) LOGGER_LOGF(LOGGER_LEVEL_DEBUG, __VA_ARGS__)
+ #define LOGGER_INFO(...)  LOGGER_LOGF(LOGGER_LEVEL_INFO, __VA_ARGS__)
+ #define LOGGER_WARN(...)  LOGGER_LOGF(LOGGER_LEVEL_WARN, __VA_ARGS__)
+ #define LOGGER_ERROR(...) LOGGER_LOGF(LOGGER_LEVEL_ERROR, __VA_ARGS__)
+ 
  /**
   * @brief Logger callback function type.
   *
@@ -38,6 +132,82 @@
   */
  typedef void (*LoggerCallback)(LoggerLevel level, const char *timestamp, const char *message);
  
+ /**
+  * @brief Timestamps added by the logger to records logged without one.
+  */
+ typedef enum {
+     LOGGER_TIMESTAMP_NONE = 0,      /**< Only the timestamps passed by the caller. */
+     LOGGER_TIMESTAMP_MONOTONIC,     /**< Seconds since boot, "12345.123456789". */
+     LOGGER_TIMESTAMP_REALTIME       /**< UTC wall clock, "2025-04-16T10:00:00.123456789Z". */
+ } LoggerTimestampMode;
+ 
+ /**
+  * @brief What a producer does when the asynchronous queue is full.
+  */
+ typedef enum {
+     LOGGER_OVERFLOW_DROP = 0,   /**< Discard the message. */
+     LOGGER_OVERFLOW_COUNT,      /**< Discard the message, then report the number lost in a WARN record. */
+     LOGGER_OVERFLOW_BLOCK       /**< Wait until the consumer makes room. */
+ } LoggerOverflowPolicy;
+ 
+ /**
+  * @brief Hook called when a message is queued into an empty queue.
+  */
+ typedef void (*LoggerNotify)(void *arg);
+ 
+ /**
+  * @brief Asynchronous mode configuration.
+  */
+ typedef struct {
+     uint32_t capacity;              /**< Queue length in records (power of two, at least 2). */
+     LoggerOverflowPolicy overflow;  /**< Full queue policy. */
+     int use_thread;                 /**< 1 = start a flusher thread, 0 = the application calls logger_drain(). */
+     LoggerNotify notify;            /**< Without a thread: called when the queue stops being empty (may be NULL). */
+     void *notify_arg;               /**< Argument passed to notify. */
+ } LoggerAsyncConfig;
+ 
+ /**
+  * @brief How a registered sink receives its records.
+  */
+ typedef enum {
+     LOGGER_SINK_INLINE = 0,         /**< Called by the thread delivering the record. */
+     LOGGER_SINK_ASYNC               /**< Own queue and thread: a slow sink only delays itself. */
+ } LoggerSinkMode;
+ 
+ /**
+  * @brief Registered sink configuration.
+  */
+ typedef struct {
+     LoggerCallback output;          /**< Output function. */
+     LoggerLevel level;              /**< Minimum level of the records it receives. */
+     LoggerSinkMode mode;            /**< Delivery mode. */
+     uint32_t capacity;              /**< Asynchronous sinks: queue length in records (power of two, at least 2). */
+     LoggerOverflowPolicy overflow;  /**< Asynchronous sinks: LOGGER_OVERFLOW_DROP or LOGGER_OVERFLOW_COUNT. */
+ } LoggerSinkConfig;
+ 
+ /**
+  * @brief Buffered file sink configuration.
+  */
+ typedef struct {
+     size_t buffer_size;             /**< Bytes per buffer (at least 64); longer lines are written directly. */
+     uint32_t buffer_count;          /**< Buffers filled before one writev() (at most sysconf(_SC_IOV_MAX)). */
+     uint32_t flush_interval_ms;     /**< Longest time a line stays buffered, 0 = no limit. */
+     LoggerLevel flush_level;        /**< Lines at or above it are written at once, LOGGER_LEVEL_MAX = never. */
+     int sync_on_flush;              /**< 1 = fdatasync() after every flush but the buffer-full ones. */
+     int drop_cache;                 /**< With sync_on_flush, 1 = drop the synced pages from the page cache. */
+ } LoggerFileSinkConfig;
+ 
+ /**
+  * @brief Buffered file sink counters.
+  */
+ typedef struct {
+     uint64_t records;               /**< Lines accepted. */
+     uint64_t bytes;                 /**< Bytes written. */
+     uint64_t writes;                /**< writev() calls. */
+     uint64_t syncs;                 /**< fdatasync() calls. */
+     uint64_t errors;                /**< Failed writes or syncs (the data is lost). */
+ } LoggerFileSinkStats;
+ 
  /**
   * @brief Initializes the logger.
   *
@@ -52,6 +222,33 @@
   */
  void logger_enable_thread_safety(int enable);
  
+ /**
+  * @brief Makes the logger timestamp the records logged without one.
+  *
+  * The logging call only reads CLOCK_MONOTONIC and keeps the raw nanoseconds
+  * in the record; the text is produced at delivery, or offline for the binary
+  * file. Wall clock times are the monotonic time plus the offset between the
+  * two clocks sampled by this call, so they never go backwards.
+  *
+  * @param mode Timestamp mode.
+  */
+ void logger_set_timestamp_mode(LoggerTimestampMode mode);
+ 
+ /**
+  * @brief Returns the timestamp mode.
+  */
+ LoggerTimestampMode logger_get_timestamp_mode(void);
+ 
+ /**
+  * @def LOGGER_PRINTF_CHECK
+  * @brief Lets the compiler check logger_logf() arguments against the format.
+  */
+ #if defined(__GNUC__)
+ #define LOGGER_PRINTF_CHECK(fmt, args) __attribute__((format(printf, fmt, args)))
+ #else
+ #define LOGGER_PRINTF_CHECK(fmt, args)
+ #endif
+ 
  /**
   * @brief Logs a message.
   *
@@ -61,6 +258,164 @@
   */
  void logger_log_message(LoggerLevel level, const char *message, const char *timestamp);
  
+ /**
+  * @brief Logs a printf-style message without formatting it.
+  *
+  * Only the format pointer and the raw arguments (strings copied) are
+  * captured; the text is produced by the consumer, or never when a binary
+  * file is set. The format must therefore stay valid for the life of the
+  * process, in practice a string literal. Supported conversions are those
+  * of printf except %n (ignored); long double is kept as a double.
+  *
+  * @param level Log level.
+  * @param format printf format string literal.
+  */
+ void logger_logf(LoggerLevel level, const char *format, ...) LOGGER_PRINTF_CHECK(2, 3);
+ 
+ /**
+  * @brief Same as logger_log_message() for a module.
+  *
+  * @param module Module id from logger_register_module().
+  * @param level Log level.
+  * @param message Message string.
+  * @param timestamp Optional timestamp string, or NULL.
+  */
+ void logger_log_module_message(int module, LoggerLevel level, const char *message, const char *timestamp);
+ 
+ /**
+  * @brief Same as logger_logf() for a module.
+  *
+  * @param module Module id from logger_register_module().
+  * @param level Log level.
+  * @param format printf format string literal.
+  */
+ void logger_logf_module(int module, LoggerLevel level, const char *format, ...) LOGGER_PRINTF_CHECK(3, 4);
+ 
+ /**
+  * @brief Sets the global minimum level.
+  *
+  * Messages below the threshold of their module are discarded before any
+  * lock, copy or formatting. Modules without a level of their own follow
+  * the global level.
+  *
+  * @param level Minimum level, LOGGER_LEVEL_MAX to discard everything.
+  */
+ void logger_set_level(LoggerLevel level);
+ 
+ /**
+  * @brief Returns the global minimum level.
+  */
+ LoggerLevel logger_get_level(void);
+ 
+ /**
+  * @brief Returns the id of a module, registering it on first use.
+  *
+  * @param name Module name, truncated to LOGGER_MODULE_NAME_SIZE - 1 characters.
+  * @return Module id, -1 when LOGGER_MAX_MODULES modules exist.
+  */
+ int logger_register_module(const char *name);
+ 
+ /**
+  * @brief Gives a module its own minimum level.
+  *
+  * @param module Module id.
+  * @param level Minimum level, LOGGER_LEVEL_MAX to silence the module.
+  * @return 0 on success, -1 on an unknown module or invalid level.
+  */
+ int logger_set_module_level(int module, LoggerLevel level);
+ 
+ /**
+  * @brief Makes a module follow the global level again.
+  *
+  * @param module Module id.
+  */
+ void logger_reset_module_level(int module);
+ 
+ /**
+  * @brief Tells whether a message would pass the level filter, to skip
+  *        building expensive arguments.
+  *
+  * @param module Module id.
+  * @param level Log level.
+  * @return 1 if enabled, 0 otherwise.
+  */
+ int logger_is_enabled(int module, LoggerLevel level);
+ 
+ /**
+  * @brief Fills a sink configuration with the defaults: no output, every
+  *        level, inline, queue of 1024 records counting its drops.
+  *
+  * @param config Configuration to fill.
+  */
+ void logger_get_default_sink_config(LoggerSinkConfig *config);
+ 
+ /**
+  * @brief Registers a sink receiving every record, from its own minimum level,
+  *        besides the logger_initialize() callback.
+  *
+  * The global and module levels are applied first: a sink can only be
+  * stricter. Inline sinks run where the callback runs, under the logger
+  * lock; asynchronous ones get a copy of the record in their own queue and
+  * run on their own thread. Register sinks before logging when thread
+  * safety is disabled.
+  *
+  * A full sink queue loses the record: waiting for room would hold the
+  * logger lock and stall every logging thread, so LOGGER_OVERFLOW_BLOCK
+  * is refused.
+  *
+  * @param config Sink configuration.
+  * @return Sink id, -1 on an invalid configuration, a full table or a
+  *         failed queue or thread creation.
+  */
+ int logger_add_sink(const LoggerSinkConfig *config);
+ 
+ /**
+  * @brief Changes the minimum level of a sink.
+  *
+  * @param sink Sink id.
+  * @param level Minimum level, LOGGER_LEVEL_MAX to pause the sink.
+  * @return 0 on success, -1 on an unknown sink or invalid level.
+  */
+ int logger_set_sink_level(int sink, LoggerLevel level);
+ 
+ /**
+  * @brief Unregisters a sink, after delivering what its queue holds.
+  *
+  * @param sink Sink id.
+  */
+ void logger_remove_sink(int sink);
+ 
+ /**
+  * @brief Returns the number of records an asynchronous sink discarded
+  *        because its queue was full.
+  *
+  * @param sink Sink id.
+  */
+ uint64_t logger_get_sink_dropped_count(int sink);
+ 
+ /**
+  * @brief Sends every record to a binary file instead of the callback.
+  *
+  * Deferred records are written with their raw arguments, each format
+  * string once, so nothing is formatted at run time. Read the file with
+  * logger_decode_binary_file() or the logger_decode tool.
+  *
+  * @param file FILE pointer opened for binary writing, NULL to go back to the callback.
+  */
+ void logger_set_binary_file(void *file);
+ 
+ /**
+  * @brief Converts a binary log file to text lines.
+  *
+  * Output lines have the format of logger_file_output(). Decoding stops at
+  * a record cut short, e.g. by a crash of the writer.
+  *
+  * @param input FILE pointer of the binary log.
+  * @param output FILE pointer receiving the text.
+  * @return Number of records decoded, -1 if input is not a binary log.
+  */
+ long logger_decode_binary_file(void *input, void *output);
+ 
  /**
   * @brief Sets a file stream for the built-in file logger.
   *
@@ -73,5 +428,160 @@
   */
  void logger_file_output(LoggerLevel level, const char *timestamp, const char *message);
  
+ /**
+  * @brief Fills a file sink configuration with the defaults: 4 buffers of
+  *        64 KiB, flush every second and on ERROR, no sync.
+  *
+  * @param config Configuration to fill.
+  */
+ void logger_get_default_file_sink_config(LoggerFileSinkConfig *config);
+ 
+ /**
+  * @brief Opens the buffered file sink, appending to path.
+  *
+  * Lines are formatted like logger_file_output() into large buffers and
+  * written with one writev() when all buffers are full, when a line at
+  * flush_level arrives, when flush_interval_ms has elapsed, on
+  * logger_flush(), logger_shutdown() and logger_file_sink_close(). Install
+  * it with logger_initialize(logger_file_sink_output).
+  *
+  * @param path File to append to, created if needed.
+  * @param config Configuration, NULL for the defaults.
+  * @return 0 on success, -1 if already open, on an invalid configuration
+  *         or when the file or buffers cannot be obtained.
+  */
+ int logger_file_sink_open(const char *path, const LoggerFileSinkConfig *config);
+ 
+ /**
+  * @brief Buffered file sink callback.
+  */
+ void logger_file_sink_output(LoggerLevel level, const char *timestamp, const char *message);
+ 
+ /**
+  * @brief Writes the buffered lines now (and syncs if configured).
+  */
+ void logger_file_sink_flush(void);
+ 
+ /**
+  * @brief Milliseconds before buffered lines are due for an interval flush.
+  *
+  * The flusher thread of the asynchronous mode uses it to flush while no
+  * line arrives; a caller draining the logger itself can do the same.
+  *
+  * @return Delay in ms (0 = due now), -1 if nothing is buffered or no interval is set.
+  */
+ int32_t logger_file_sink_idle_ms(void);
+ 
+ /**
+  * @brief Flushes and closes the buffered file sink.
+  */
+ void logger_file_sink_close(void);
+ 
+ /**
+  * @brief Reads the file sink counters.
+  *
+  * @param stats Destination.
+  */
+ void logger_file_sink_get_stats(LoggerFileSinkStats *stats);
+ 
+ /**
+  * @brief Opens the crash-safe ring sink on a memory-mapped file.
+  *
+  * Each line is copied into a ring of records kept in a shared mapping of
+  * path, so the last size bytes of log survive a crash of the process
+  * without any write system call. Writers reserve space lock-free and may
+  * run concurrently. An existing ring of the same size is continued after
+  * its newest record. Install it with logger_initialize(logger_ring_sink_output),
+  * read it back with logger_ring_sink_read() or the logger_ring_read tool.
+  *
+  * @param path File holding the ring, created if needed.
+  * @param size Ring size in bytes (rounded up to pages, at least 8 KiB).
+  * @return 0 on success, -1 if already open or on a file or mapping error.
+  */
+ int logger_ring_sink_open(const char *path, size_t size);
+ 
+ /**
+  * @brief Ring sink callback. Lines longer than a quarter of the ring are truncated.
+  */
+ void logger_ring_sink_output(LoggerLevel level, const char *timestamp, const char *message);
+ 
+ /**
+  * @brief Forces the ring to disk (msync), for a crash of the machine.
+  *
+  * @return 0 on success, -1 if the ring is not open or on error.
+  */
+ int logger_ring_sink_sync(void);
+ 
+ /**
+  * @brief Unmaps the ring sink. The file keeps its content.
+  */
+ void logger_ring_sink_close(void);
+ 
+ /**
+  * @brief Prints the records of a ring file, oldest first.
+  *
+  * Lines have the format of logger_file_output(). Records torn by a crash
+  * or partly overwritten are skipped. The ring may be in use by a writer.
+  *
+  * @param path Ring file.
+  * @param output FILE pointer receiving the text.
+  * @return Number of records printed, -1 if path is not a ring file.
+  */
+ long logger_ring_sink_read(const char *path, void *output);
+ 
+ /**
+  * @brief Fills a configuration with the defaults: 1024 records, drop and
+  *        count on overflow, flusher thread.
+  *
+  * @param config Configuration to fill.
+  */
+ void logger_get_default_async_config(LoggerAsyncConfig *config);
+ 
+ /**
+  * @brief Switches the logger to asynchronous mode.
+  *
+  * logger_log_message() then copies the message and timestamp into a
+  * lock-free multi-producer queue and returns, and the callback runs on
+  * the consumer side only: the flusher thread, or whoever calls
+  * logger_drain() (e.g. a workersManager worker woken by notify).
+  *
+  * @param config Configuration, NULL for the defaults.
+  * @return 0 on success, -1 if already asynchronous, on an invalid
+  *         configuration or when the queue or thread cannot be created.
+  */
+ int logger_start_async(const LoggerAsyncConfig *config);
+ 
+ /**
+  * @brief Delivers queued records to the callback.
+  *
+  * Consumers are serialized, so the callback never runs concurrently.
+  *
+  * @param max_records Maximum number of records to deliver, 0 for all.
+  * @return Number of records delivered.
+  */
+ uint32_t logger_drain(uint32_t max_records);
+ 
+ /**
+  * @brief Waits until every message logged before the call was delivered,
+  *        asynchronous sinks included.
+  *
+  * The binary file and the buffered file sink are flushed afterwards.
+  */
+ void logger_flush(void);
+ 
+ /**
+  * @brief Delivers the queued records, stops the flusher thread and goes
+  *        back to synchronous mode.
+  *
+  * Messages logged by other threads while the call runs are delivered
+  * synchronously, possibly before the last queued ones.
+  */
+ void logger_shutdown(void);
+ 
+ /**
+  * @brief Number of messages discarded because the queue was full.
+  */
+ uint64_t logger_get_dropped_count(void);
+ 
  #endif /* LOGGER_H */
  
\ No newline at end of file
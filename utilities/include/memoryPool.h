@@ -0,0 +1,119 @@
+/**
+ *  \file memoryPool.h
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 15 APR 2025
+ *
+ *  @brief Lock-free pool of fixed size blocks.
+ *
+ *  Blocks are carved out of a caller provided or allocated storage area,
+ *  so a pool set up over a static array never touches the heap. Acquire
+ *  and release are O(1) and lock-free, and may be called from any thread.
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #ifndef __MEMORY_POOL_H__
+ #define __MEMORY_POOL_H__
+
+ #include <stddef.h>
+ #include <stdint.h>
+
+ #ifdef __cplusplus
+ extern "C" {
+ #endif
+
+ /**
+  * @def MEMORYPOOL_ALIGN
+  * @brief Alignment of every block (power of two).
+  */
+ #ifndef MEMORYPOOL_ALIGN
+ #define MEMORYPOOL_ALIGN 16u
+ #endif
+
+ /**
+  * @def MEMORYPOOL_BLOCK_SIZE
+  * @brief Size of a block once rounded up to MEMORYPOOL_ALIGN.
+  */
+ #define MEMORYPOOL_BLOCK_SIZE(blockSize) \
+     ((((size_t)(blockSize)) + MEMORYPOOL_ALIGN - 1u) & ~((size_t)MEMORYPOOL_ALIGN - 1u))
+
+ /**
+  * @def MEMORYPOOL_STORAGE_SIZE
+  * @brief Storage needed by a pool, usable to size a static array.
+  *
+  * The array must be aligned on MEMORYPOOL_ALIGN.
+  */
+ #define MEMORYPOOL_STORAGE_SIZE(count, blockSize) \
+     (((size_t)(count) * MEMORYPOOL_BLOCK_SIZE(blockSize)) + ((size_t)(count) * sizeof(uint32_t)))
+
+ /**
+  * @brief Pool of count blocks of blockSize bytes.
+  */
+ typedef struct {
+     uint8_t *blocks;                    /**< Block storage, count * MEMORYPOOL_BLOCK_SIZE(blockSize) bytes. */
+     uint32_t *nextFree;                 /**< Free list links (index + 1, 0 = end). */
+     size_t blockSize;                   /**< Rounded block size in bytes. */
+     uint32_t count;                     /**< Number of blocks. */
+     uint64_t freeHead;                  /**< ABA tag in the upper 32 bits, index + 1 in the lower. */
+     uint8_t owned;                      /**< Storage was allocated by init. */
+ } memoryPool_t;
+
+ /**
+  * @brief Size of the storage area needed by a pool.
+  *
+  * @param count Number of blocks.
+  * @param blockSize Size of one block in bytes.
+  * @return Size in bytes.
+  */
+ size_t memoryPool_storageSize(uint32_t count, size_t blockSize);
+
+ /**
+  * @brief Initialize a pool with every block free.
+  *
+  * @param pool Pool to initialize.
+  * @param storage Storage of memoryPool_storageSize() bytes aligned on
+  *                MEMORYPOOL_ALIGN, NULL to allocate it.
+  * @param count Number of blocks (at least 1).
+  * @param blockSize Size of one block in bytes.
+  * @return 0 on success, -1 on invalid arguments or allocation failure.
+  */
+ int memoryPool_init(memoryPool_t *pool, void *storage, uint32_t count, size_t blockSize);
+
+ /**
+  * @brief Release the storage allocated by memoryPool_init().
+  *
+  * @param pool Pool to destroy.
+  */
+ void memoryPool_destroy(memoryPool_t *pool);
+
+ /**
+  * @brief Take a block from the pool.
+  *
+  * @param pool Pool to take from.
+  * @return Block of blockSize bytes (content undefined), NULL if exhausted.
+  */
+ void *memoryPool_acquire(memoryPool_t *pool);
+
+ /**
+  * @brief Give a block back to the pool.
+  *
+  * @param pool Pool the block was acquired from.
+  * @param block Block returned by memoryPool_acquire(), NULL is ignored.
+  */
+ void memoryPool_release(memoryPool_t *pool, void *block);
+
+ /**
+  * @brief Tell whether a pointer is a block of the pool.
+  */
+ uint8_t memoryPool_owns(const memoryPool_t *pool, const void *block);
+
+ #ifdef __cplusplus
+ }
+ #endif
+
+ #endif // __MEMORY_POOL_H__
@@ -0,0 +1,259 @@
+/**
+ *  \file ringBuffer.h
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 14 APR 2025
+ *
+ *  @brief Bounded lock-free ring buffers (SPSC and MPMC) of fixed size items.
+ *
+ *  Items are copied in and out of a caller provided or allocated storage
+ *  area, push and pop never lock and never allocate. The capacity must be a
+ *  power of two.
+ *
+ *  An optional notify hook is called by the producer when a push finds the
+ *  consumer caught up (the ring was empty), e.g. to wake the consumer
+ *  thread. A consumer that pops until the ring reports empty never misses
+ *  a notification.
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #ifndef __RING_BUFFER_H__
+ #define __RING_BUFFER_H__
+
+ #include <stddef.h>
+ #include <stdint.h>
+
+ #ifdef __cplusplus
+ extern "C" {
+ #endif
+
+ /**
+  * @def RINGBUFFER_CACHE_LINE
+  * @brief Alignment used to keep producer and consumer indexes on separate cache lines.
+  */
+ #ifndef RINGBUFFER_CACHE_LINE
+ #define RINGBUFFER_CACHE_LINE 64
+ #endif
+
+ /**
+  * @brief Hook called by a producer when it pushes into an empty ring.
+  */
+ typedef void (*ringBufferNotify_t)(void *arg);
+
+ /**
+  * @brief Single producer, single consumer ring buffer.
+  *
+  * Exactly one thread may push and exactly one thread may pop at a time.
+  */
+ typedef struct {
+     struct {
+         uint8_t *data;                  /**< Item storage, capacity * itemSize bytes. */
+         uint32_t mask;                  /**< capacity - 1. */
+         uint32_t itemSize;              /**< Size of one item in bytes. */
+         ringBufferNotify_t notify;      /**< Optional push-into-empty hook. */
+         void *notifyArg;                /**< Argument passed to notify. */
+         uint8_t owned;                  /**< Storage was allocated by init. */
+     } config;
+
+     struct {
+         uint32_t tail;                  /**< Next slot to write (published to the consumer). */
+         uint32_t headCache;             /**< Last consumer index seen by the producer. */
+     } producer __attribute__((aligned(RINGBUFFER_CACHE_LINE)));
+
+     struct {
+         uint32_t head;                  /**< Next slot to read (published to the producer). */
+         uint32_t tailCache;             /**< Last producer index seen by the consumer. */
+     } consumer __attribute__((aligned(RINGBUFFER_CACHE_LINE)));
+ } ringBufferSpsc_t;
+
+ /**
+  * @brief Multi producer, multi consumer ring buffer.
+  *
+  * Any number of threads may push and pop concurrently. Each slot carries a
+  * sequence number, so producers and consumers only contend on their own
+  * index and never on each other.
+  */
+ typedef struct {
+     struct {
+         uint32_t *sequence;             /**< Per-slot sequence numbers. */
+         uint8_t *data;                  /**< Item storage, capacity * itemSize bytes. */
+         uint32_t mask;                  /**< capacity - 1. */
+         uint32_t itemSize;              /**< Size of one item in bytes. */
+         ringBufferNotify_t notify;      /**< Optional push-into-empty hook. */
+         void *notifyArg;                /**< Argument passed to notify. */
+         uint8_t owned;                  /**< Storage was allocated by init. */
+     } config;
+
+     uint32_t enqueuePos __attribute__((aligned(RINGBUFFER_CACHE_LINE)));   /**< Next slot claimed by a producer. */
+     uint32_t dequeuePos __attribute__((aligned(RINGBUFFER_CACHE_LINE)));   /**< Next slot claimed by a consumer. */
+ } ringBufferMpmc_t;
+
+ /**
+  * @brief Size of the storage area needed by an SPSC ring.
+  *
+  * @param capacity Number of items (power of two).
+  * @param itemSize Size of one item in bytes.
+  * @return Size in bytes.
+  */
+ size_t ringBufferSpsc_storageSize(uint32_t capacity, uint32_t itemSize);
+
+ /**
+  * @brief Initialize an SPSC ring.
+  *
+  * @param ring Ring to initialize.
+  * @param storage Storage of ringBufferSpsc_storageSize() bytes, NULL to allocate it.
+  * @param capacity Number of items (power of two, at most 2^31).
+  * @param itemSize Size of one item in bytes.
+  * @return 0 on success, -1 on invalid arguments or allocation failure.
+  */
+ int ringBufferSpsc_init(ringBufferSpsc_t *ring, void *storage, uint32_t capacity, uint32_t itemSize);
+
+ /**
+  * @brief Release the storage allocated by ringBufferSpsc_init().
+  *
+  * @param ring Ring to destroy.
+  */
+ void ringBufferSpsc_destroy(ringBufferSpsc_t *ring);
+
+ /**
+  * @brief Install the push-into-empty hook. Call before the ring is shared.
+  *
+  * @param ring Ring to configure.
+  * @param notify Hook, NULL to disable.
+  * @param arg Argument passed to the hook.
+  */
+ void ringBufferSpsc_setNotify(ringBufferSpsc_t *ring, ringBufferNotify_t notify, void *arg);
+
+ /**
+  * @brief Push one item (producer side).
+  *
+  * @param ring Ring to push to.
+  * @param item Item of itemSize bytes to copy in.
+  * @return 0 on success, -1 if the ring is full.
+  */
+ int ringBufferSpsc_push(ringBufferSpsc_t *ring, const void *item);
+
+ /**
+  * @brief Pop one item (consumer side).
+  *
+  * @param ring Ring to pop from.
+  * @param item Destination of itemSize bytes.
+  * @return 0 on success, -1 if the ring is empty.
+  */
+ int ringBufferSpsc_pop(ringBufferSpsc_t *ring, void *item);
+
+ /**
+  * @brief Push up to count contiguous items with a single index update.
+  *
+  * @param ring Ring to push to.
+  * @param items Array of count items.
+  * @param count Number of items to push.
+  * @return Number of items pushed.
+  */
+ uint32_t ringBufferSpsc_pushBatch(ringBufferSpsc_t *ring, const void *items, uint32_t count);
+
+ /**
+  * @brief Pop up to count items with a single index update.
+  *
+  * @param ring Ring to pop from.
+  * @param items Destination array of count items.
+  * @param count Maximum number of items to pop.
+  * @return Number of items popped.
+  */
+ uint32_t ringBufferSpsc_popBatch(ringBufferSpsc_t *ring, void *items, uint32_t count);
+
+ /**
+  * @brief Number of items in the ring (approximate while in use).
+  */
+ uint32_t ringBufferSpsc_count(const ringBufferSpsc_t *ring);
+
+ /**
+  * @brief Size of the storage area needed by an MPMC ring.
+  *
+  * @param capacity Number of items (power of two).
+  * @param itemSize Size of one item in bytes.
+  * @return Size in bytes.
+  */
+ size_t ringBufferMpmc_storageSize(uint32_t capacity, uint32_t itemSize);
+
+ /**
+  * @brief Initialize an MPMC ring.
+  *
+  * @param ring Ring to initialize.
+  * @param storage Storage of ringBufferMpmc_storageSize() bytes aligned for
+  *                uint32_t, NULL to allocate it.
+  * @param capacity Number of items (power of two, at least 2, at most 2^31).
+  * @param itemSize Size of one item in bytes.
+  * @return 0 on success, -1 on invalid arguments or allocation failure.
+  */
+ int ringBufferMpmc_init(ringBufferMpmc_t *ring, void *storage, uint32_t capacity, uint32_t itemSize);
+
+ /**
+  * @brief Release the storage allocated by ringBufferMpmc_init().
+  *
+  * @param ring Ring to destroy.
+  */
+ void ringBufferMpmc_destroy(ringBufferMpmc_t *ring);
+
+ /**
+  * @brief Install the push-into-empty hook. Call before the ring is shared.
+  *
+  * @param ring Ring to configure.
+  * @param notify Hook, NULL to disable.
+  * @param arg Argument passed to the hook.
+  */
+ void ringBufferMpmc_setNotify(ringBufferMpmc_t *ring, ringBufferNotify_t notify, void *arg);
+
+ /**
+  * @brief Push one item from any thread.
+  *
+  * @param ring Ring to push to.
+  * @param item Item of itemSize bytes to copy in.
+  * @return 0 on success, -1 if the ring is full.
+  */
+ int ringBufferMpmc_push(ringBufferMpmc_t *ring, const void *item);
+
+ /**
+  * @brief Pop one item from any thread.
+  *
+  * @param ring Ring to pop from.
+  * @param item Destination of itemSize bytes.
+  * @return 0 on success, -1 if the ring is empty.
+  */
+ int ringBufferMpmc_pop(ringBufferMpmc_t *ring, void *item);
+
+ /**
+  * @brief Push up to count items, claiming the slots with a single CAS.
+  *
+  * @param ring Ring to push to.
+  * @param items Array of count items.
+  * @param count Number of items to push.
+  * @return Number of items pushed.
+  */
+ uint32_t ringBufferMpmc_pushBatch(ringBufferMpmc_t *ring, const void *items, uint32_t count);
+
+ /**
+  * @brief Pop up to count items, claiming the slots with a single CAS.
+  *
+  * @param ring Ring to pop from.
+  * @param items Destination array of count items.
+  * @param count Maximum number of items to pop.
+  * @return Number of items popped.
+  */
+ uint32_t ringBufferMpmc_popBatch(ringBufferMpmc_t *ring, void *items, uint32_t count);
+
+ /**
+  * @brief Number of items in the ring (approximate while in use).
+  */
+ uint32_t ringBufferMpmc_count(const ringBufferMpmc_t *ring);
+
+ #ifdef __cplusplus
+ }
+ #endif
+
+ #endif // __RING_BUFFER_H__
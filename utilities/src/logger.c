@@ -8,22 +8,129 @@
  *  
  *  @brief MISRA C:2012 compliant logger implementation.
  *
+ *  In asynchronous mode producers copy their message into a lock-free MPMC
+ *  ring and return. A single consumer at a time (the flusher thread or a
+ *  logger_drain() caller, serialized by logger_mutex) pops batches and
+ *  runs the callback. Progress is tracked in ring positions: a flush waits
+ *  until the consumer has delivered every position claimed before it.
+ *
+ *  logger_logf() records carry the format pointer and the captured
+ *  arguments instead of text (see loggerFormat.c); they are rendered at
+ *  delivery, or written as they are to the binary file. Likewise the
+ *  timestamps added by the logger travel as monotonic nanoseconds and
+ *  become text only where a callback needs it.
+ *
+ *  Every delivered record is also offered to the registered sinks. Inline
+ *  ones are called on the spot; asynchronous ones receive a copy of the
+ *  record in a queue of their own, emptied by their own thread.
+ *
  *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
  *  \n
  *  \license MIT
  */
 
  #include "logger.h"
+ #include "loggerFormat.h"
+ #include "ringBuffer.h"
+ #include <stdarg.h>
  #include <stdio.h>
  #include <string.h>
+ #include <sched.h>
+ #include <time.h>
  #include <pthread.h>
  
- #define LOGGER_LEVEL_COUNT ((int)LOGGER_LEVEL_MAX)
+ #define LOGGER_WAIT_NS 1000000L
+ #define LOGGER_RENDER_SIZE (2u * LOGGER_ASYNC_MESSAGE_SIZE)
+ 
+ /**
+  * @brief Asynchronous mode state.
+  */
+ typedef enum {
+     LOGGER_MODE_SYNC = 0,
+     LOGGER_MODE_ASYNC
+ } LoggerMode;
+ 
+ /**
+  * @brief Message copied into the queue.
+  */
+ typedef struct {
+     LoggerLevel level;
+     uint8_t has_timestamp;
+     uint8_t deferred;                               /* logger_logf() record. */
+     uint16_t args_size;                             /* Captured argument bytes of a deferred record. */
+     uint64_t time_ns;                               /* Logger timestamp, 0 = none. */
+     const char *format;                             /* Format of a deferred record. */
+     char timestamp[LOGGER_ASYNC_TIMESTAMP_SIZE];
+     union {
+         char message[LOGGER_ASYNC_MESSAGE_SIZE];
+         uint8_t args[LOGGER_ASYNC_MESSAGE_SIZE];
+     } data;
+ } LoggerRecord;
  
  static LoggerCallback logger_callback_function = (LoggerCallback)0;
  static int logger_use_thread_safety = 1;
  static pthread_mutex_t logger_mutex = PTHREAD_MUTEX_INITIALIZER;
  static FILE *logger_output_file = (FILE *)0;
+ static FILE *logger_binary_file = (FILE *)0;
+ 
+ static LoggerMode logger_mode = LOGGER_MODE_SYNC;
+ static LoggerAsyncConfig logger_async_config;
+ static ringBufferMpmc_t logger_queue;
+ static uint32_t logger_producers = 0u;          /* Producers between the mode check and the push. */
+ static uint32_t logger_delivered = 0u;          /* Ring positions delivered to the callback. */
+ static uint64_t logger_dropped = 0u;
+ static uint64_t logger_dropped_reported = 0u;
+ static uint32_t logger_waiters = 0u;            /* Threads waiting for the consumer to progress. */
+ static uint8_t logger_wake_pending = 0u;
+ static uint8_t logger_stop = 0u;
+ static uint8_t logger_thread_running = 0u;
+ static pthread_t logger_thread;
+ static pthread_mutex_t logger_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+ static pthread_cond_t logger_wake_cond = PTHREAD_COND_INITIALIZER;
+ static pthread_cond_t logger_progress_cond = PTHREAD_COND_INITIALIZER;
+ static __thread uint8_t logger_is_consumer = 0u;
+ 
+ static uint8_t logger_global_level = (uint8_t)LOGGER_LEVEL_DEBUG;
+ static uint8_t logger_thresholds[LOGGER_MAX_MODULES];           /* Effective level of each module. */
+ static uint8_t logger_module_override[LOGGER_MAX_MODULES];      /* Module has a level of its own. */
+ static char logger_module_names[LOGGER_MAX_MODULES][LOGGER_MODULE_NAME_SIZE] = { "default" };
+ static uint32_t logger_module_count = 1u;
+ 
+ /**
+  * @brief Registered sink slot state.
+  */
+ typedef enum {
+     LOGGER_SINK_FREE = 0,
+     LOGGER_SINK_ACTIVE,
+     LOGGER_SINK_CLOSING                             /* Unregistered, its thread still running. */
+ } LoggerSinkState;
+ 
+ /**
+  * @brief Registered sink.
+  */
+ typedef struct {
+     uint8_t state;
+     uint8_t level;                                  /* Minimum level, read without the lock. */
+     LoggerSinkConfig config;
+     ringBufferMpmc_t queue;                         /* Asynchronous sinks only, from here on. */
+     uint32_t delivered;                             /* Ring positions given to the output. */
+     uint64_t dropped;
+     uint64_t dropped_reported;
+     uint32_t waiters;
+     uint32_t users;                                 /* logger_flush() calls using the queue and the thread. */
+     uint8_t wake_pending;
+     uint8_t stop;
+     pthread_t thread;
+     pthread_mutex_t mutex;
+     pthread_cond_t wake_cond;
+     pthread_cond_t progress_cond;
+ } LoggerSink;
+ 
+ static LoggerSink logger_sinks[LOGGER_MAX_SINKS];
+ static uint32_t logger_sink_count = 0u;                 /* Slots in use are below it. */
+ 
+ static uint8_t logger_timestamp_mode = (uint8_t)LOGGER_TIMESTAMP_NONE;
+ static int64_t logger_time_offset_ns = 0;      /* Wall clock minus monotonic clock. */
  
  void logger_initialize(LoggerCallback callback)
  {
@@ -40,31 +147,917 @@
      logger_output_file = (FILE *)file;
  }
  
- void logger_log_message(LoggerLevel level, const char *message, const char *timestamp)
+ static void logger_copy_string(char *dest, const char *src, size_t size)
  {
-     if ((level >= LOGGER_LEVEL_MAX) || (message == (const char *)0)) {
-         return;
+     const char *end = (const char *)memchr(src, '\0', size - 1u);
+     size_t length = (end != (const char *)0) ? (size_t)(end - src) : (size - 1u);
+ 
+     (void)memcpy(dest, src, length);
+     dest[length] = '\0';
+ }
+ 
+ static void logger_deadline(struct timespec *ts)
+ {
+     (void)clock_gettime(CLOCK_REALTIME, ts);
+     ts->tv_nsec += LOGGER_WAIT_NS;
+     if (ts->tv_nsec >= 1000000000L) {
+         ts->tv_sec++;
+         ts->tv_nsec -= 1000000000L;
      }
+ }
  
-     if (logger_use_thread_safety != 0) {
+ static void logger_deadline_ms(struct timespec *ts, uint32_t ms)
+ {
+     (void)clock_gettime(CLOCK_REALTIME, ts);
+     ts->tv_sec += (time_t)(ms / 1000u);
+     ts->tv_nsec += (long)(ms % 1000u) * 1000000L;
+     if (ts->tv_nsec >= 1000000000L) {
+         ts->tv_sec++;
+         ts->tv_nsec -= 1000000000L;
+     }
+ }
+ 
+ /* Push-into-empty hook of the queue when the logger owns the flusher thread. */
+ static void logger_wake_flusher(void *arg)
+ {
+     (void)arg;
+     (void)pthread_mutex_lock(&logger_async_mutex);
+     logger_wake_pending = 1u;
+     (void)pthread_cond_signal(&logger_wake_cond);
+     (void)pthread_mutex_unlock(&logger_async_mutex);
+ }
+ 
+ /* Waits up to LOGGER_WAIT_NS for the consumer to deliver something. */
+ static void logger_wait_progress(void)
+ {
+     struct timespec ts;
+ 
+     logger_deadline(&ts);
+     (void)pthread_mutex_lock(&logger_async_mutex);
+     logger_waiters++;
+     if (logger_thread_running != 0u) {
+         logger_wake_pending = 1u;
+         (void)pthread_cond_signal(&logger_wake_cond);
+     }
+     (void)pthread_cond_timedwait(&logger_progress_cond, &logger_async_mutex, &ts);
+     logger_waiters--;
+     (void)pthread_mutex_unlock(&logger_async_mutex);
+ }
+ 
+ /* Logger timestamp of a record logged now, 0 if the caller gave one or stamping is off. */
+ static uint64_t logger_stamp(const char *timestamp)
+ {
+     if ((timestamp != (const char *)0) ||
+         (__atomic_load_n(&logger_timestamp_mode, __ATOMIC_RELAXED) == (uint8_t)LOGGER_TIMESTAMP_NONE)) {
+         return 0u;
+     }
+     return logger_time_now();
+ }
+ 
+ /* Text of a logger timestamp for the callback, into a LOGGER_TIME_TEXT_SIZE buffer. */
+ static const char *logger_stamp_text(char *text, uint64_t time_ns)
+ {
+     logger_time_format(text, time_ns, __atomic_load_n(&logger_time_offset_ns, __ATOMIC_RELAXED),
+                        (LoggerTimestampMode)__atomic_load_n(&logger_timestamp_mode, __ATOMIC_RELAXED));
+     return text;
+ }
+ 
+ /* Waits up to LOGGER_WAIT_NS for the thread of an asynchronous sink to deliver something. */
+ static void logger_sink_wait_progress(LoggerSink *sink)
+ {
+     struct timespec ts;
+ 
+     logger_deadline(&ts);
+     (void)pthread_mutex_lock(&sink->mutex);
+     sink->waiters++;
+     sink->wake_pending = 1u;
+     (void)pthread_cond_signal(&sink->wake_cond);
+     (void)pthread_cond_timedwait(&sink->progress_cond, &sink->mutex, &ts);
+     sink->waiters--;
+     (void)pthread_mutex_unlock(&sink->mutex);
+ }
+ 
+ /* Push-into-empty hook of the queue of an asynchronous sink. */
+ static void logger_sink_wake(void *arg)
+ {
+     LoggerSink *sink = (LoggerSink *)arg;
+ 
+     (void)pthread_mutex_lock(&sink->mutex);
+     sink->wake_pending = 1u;
+     (void)pthread_cond_signal(&sink->wake_cond);
+     (void)pthread_mutex_unlock(&sink->mutex);
+ }
+ 
+ /* Gives a queued record to the output of an asynchronous sink, on its thread. */
+ static void logger_sink_output(const LoggerSink *sink, const LoggerRecord *record)
+ {
+     char text[LOGGER_RENDER_SIZE];
+     char stamp[LOGGER_TIME_TEXT_SIZE];
+     const char *message = record->data.message;
+     const char *timestamp = (record->has_timestamp != 0u) ? record->timestamp : (const char *)0;
+ 
+     if (record->deferred != 0u) {
+         (void)logger_format_render(text, sizeof(text), record->format, record->data.args, record->args_size);
+         message = text;
+     }
+     if ((timestamp == (const char *)0) && (record->time_ns != 0u)) {
+         timestamp = logger_stamp_text(stamp, record->time_ns);
+     }
+     sink->config.output(record->level, timestamp, message);
+ }
+ 
+ static void *logger_sink_thread(void *arg)
+ {
+     LoggerSink *sink = (LoggerSink *)arg;
+     LoggerRecord batch[LOGGER_ASYNC_BATCH];
+ 
+     /* Records this sink logs itself must not wait on a queue it may be holding up. */
+     logger_is_consumer = 1u;
+     for (;;) {
+         uint32_t n = ringBufferMpmc_popBatch(&sink->queue, batch, LOGGER_ASYNC_BATCH);
+ 
+         for (uint32_t i = 0u; i < n; i++) {
+             logger_sink_output(sink, &batch[i]);
+         }
+ 
+         if (sink->config.overflow == LOGGER_OVERFLOW_COUNT) {
+             uint64_t dropped = __atomic_load_n(&sink->dropped, __ATOMIC_RELAXED);
+             if (dropped != sink->dropped_reported) {
+                 char report[64];
+                 (void)snprintf(report, sizeof(report), "logger: %llu messages dropped",
+                                (unsigned long long)(dropped - sink->dropped_reported));
+                 sink->config.output(LOGGER_LEVEL_WARN, (const char *)0, report);
+                 sink->dropped_reported = dropped;
+             }
+         }
+ 
+         (void)pthread_mutex_lock(&sink->mutex);
+         if (n != 0u) {
+             (void)__atomic_add_fetch(&sink->delivered, n, __ATOMIC_RELEASE);
+             if (sink->waiters != 0u) {
+                 (void)pthread_cond_broadcast(&sink->progress_cond);
+             }
+         } else {
+             while ((sink->wake_pending == 0u) && (sink->stop == 0u)) {
+                 (void)pthread_cond_wait(&sink->wake_cond, &sink->mutex);
+             }
+             sink->wake_pending = 0u;
+         }
+         uint8_t stop = sink->stop;
+         (void)pthread_mutex_unlock(&sink->mutex);
+ 
+         if ((stop != 0u) && (ringBufferMpmc_count(&sink->queue) == 0u)) {
+             break;
+         }
+     }
+     return (void *)0;
+ }
+ 
+ /* Never waits: the caller holds logger_mutex, a full sink loses the record. */
+ static void logger_sink_enqueue(LoggerSink *sink, const LoggerRecord *record)
+ {
+     if (ringBufferMpmc_push(&sink->queue, record) != 0) {
+         (void)__atomic_add_fetch(&sink->dropped, 1u, __ATOMIC_RELAXED);
+     }
+ }
+ 
+ /*
+  * Offers a delivered record to the registered sinks. message is NULL for a
+  * deferred record. The text, the timestamp and the queued copy are built
+  * at most once, and only if a sink wants them.
+  */
+ static void logger_sinks_deliver(LoggerLevel level, uint64_t time_ns, const char *timestamp, const char *message,
+                                  const char *format, const uint8_t *args, size_t args_size)
+ {
+     char text[LOGGER_RENDER_SIZE];
+     char stamp[LOGGER_TIME_TEXT_SIZE];
+     LoggerRecord record;
+     uint8_t record_ready = 0u;
+     uint32_t count = __atomic_load_n(&logger_sink_count, __ATOMIC_ACQUIRE);
+ 
+     for (uint32_t i = 0u; i < count; i++) {
+         LoggerSink *sink = &logger_sinks[i];
+ 
+         if ((__atomic_load_n(&sink->state, __ATOMIC_ACQUIRE) != (uint8_t)LOGGER_SINK_ACTIVE) ||
+             ((uint8_t)level < __atomic_load_n(&sink->level, __ATOMIC_RELAXED))) {
+             continue;
+         }
+ 
+         if (sink->config.mode == LOGGER_SINK_ASYNC) {
+             if (record_ready == 0u) {
+                 record.level = level;
+                 record.time_ns = time_ns;
+                 record.has_timestamp = (timestamp != (const char *)0) ? 1u : 0u;
+                 if (record.has_timestamp != 0u) {
+                     logger_copy_string(record.timestamp, timestamp, sizeof(record.timestamp));
+                 }
+                 if (message != (const char *)0) {
+                     record.deferred = 0u;
+                     logger_copy_string(record.data.message, message, sizeof(record.data.message));
+                 } else {
+                     record.deferred = 1u;
+                     record.format = format;
+                     record.args_size = (uint16_t)args_size;
+                     (void)memcpy(record.data.args, args, args_size);
+                 }
+                 record_ready = 1u;
+             }
+             logger_sink_enqueue(sink, &record);
+         } else {
+             if (message == (const char *)0) {
+                 (void)logger_format_render(text, sizeof(text), format, args, args_size);
+                 message = text;
+             }
+             if ((timestamp == (const char *)0) && (time_ns != 0u)) {
+                 timestamp = logger_stamp_text(stamp, time_ns);
+             }
+             sink->config.output(level, timestamp, message);
+         }
+     }
+ }
+ 
+ /* Waits until the asynchronous sinks delivered every record queued before the call. */
+ static void logger_sinks_flush(void)
+ {
+     uint32_t count = __atomic_load_n(&logger_sink_count, __ATOMIC_ACQUIRE);
+ 
+     for (uint32_t i = 0u; i < count; i++) {
+         LoggerSink *sink = &logger_sinks[i];
+         uint32_t target = 0u;
+         uint8_t used = 0u;
+ 
+         /* A user keeps logger_remove_sink() from destroying the sink under the wait. */
          (void)pthread_mutex_lock(&logger_mutex);
+         if ((sink->state == (uint8_t)LOGGER_SINK_ACTIVE) && (sink->config.mode == LOGGER_SINK_ASYNC)) {
+             (void)__atomic_add_fetch(&sink->users, 1u, __ATOMIC_RELAXED);
+             target = __atomic_load_n(&sink->queue.enqueuePos, __ATOMIC_ACQUIRE);
+             used = 1u;
+         }
+         (void)pthread_mutex_unlock(&logger_mutex);
+         if (used == 0u) {
+             continue;
+         }
+ 
+         /* The thread of a closing sink still delivers its whole queue before it exits. */
+         while ((int32_t)(__atomic_load_n(&sink->delivered, __ATOMIC_ACQUIRE) - target) < 0) {
+             logger_sink_wait_progress(sink);
+         }
+         (void)__atomic_sub_fetch(&sink->users, 1u, __ATOMIC_RELEASE);
      }
+ }
  
-     if (logger_callback_function != (LoggerCallback)0) {
+ /* Delivery of a text record, consumer side or synchronous caller. */
+ static void logger_deliver_text(LoggerLevel level, uint64_t time_ns, const char *timestamp, const char *message)
+ {
+     if (logger_binary_file != (FILE *)0) {
+         logger_binary_write_text(logger_binary_file, level, time_ns, timestamp, message);
+     } else if (logger_callback_function != (LoggerCallback)0) {
+         char stamp[LOGGER_TIME_TEXT_SIZE];
+         if ((timestamp == (const char *)0) && (time_ns != 0u)) {
+             timestamp = logger_stamp_text(stamp, time_ns);
+         }
          logger_callback_function(level, timestamp, message);
+     } else {
+         /* No output. */
+     }
+     if (__atomic_load_n(&logger_sink_count, __ATOMIC_RELAXED) != 0u) {
+         logger_sinks_deliver(level, time_ns, timestamp, message, (const char *)0, (const uint8_t *)0, 0u);
+     }
+ }
+ 
+ /* Delivery of a deferred record: rendered for the callback, raw for the binary file. */
+ static void logger_deliver_deferred(LoggerLevel level, uint64_t time_ns, const char *format,
+                                     const uint8_t *args, size_t args_size)
+ {
+     if (logger_binary_file != (FILE *)0) {
+         logger_binary_write_deferred(logger_binary_file, level, time_ns, format, args, args_size);
+     } else if (logger_callback_function != (LoggerCallback)0) {
+         char text[LOGGER_RENDER_SIZE];
+         char stamp[LOGGER_TIME_TEXT_SIZE];
+         (void)logger_format_render(text, sizeof(text), format, args, args_size);
+         logger_callback_function(level, (time_ns != 0u) ? logger_stamp_text(stamp, time_ns) : (const char *)0, text);
+     } else {
+         /* No output. */
+     }
+     if (__atomic_load_n(&logger_sink_count, __ATOMIC_RELAXED) != 0u) {
+         logger_sinks_deliver(level, time_ns, (const char *)0, (const char *)0, format, args, args_size);
      }
+ }
+ 
+ /* Enters the producer side of the queue, returns 0 in synchronous mode. */
+ static int logger_async_begin(void)
+ {
+     if (__atomic_load_n(&logger_mode, __ATOMIC_ACQUIRE) != LOGGER_MODE_ASYNC) {
+         return 0;
+     }
+ 
+     (void)__atomic_add_fetch(&logger_producers, 1u, __ATOMIC_SEQ_CST);
+     if (__atomic_load_n(&logger_mode, __ATOMIC_SEQ_CST) == LOGGER_MODE_ASYNC) {
+         return 1;
+     }
+     (void)__atomic_sub_fetch(&logger_producers, 1u, __ATOMIC_RELEASE);
+     return 0;
+ }
+ 
+ static void logger_async_end(void)
+ {
+     (void)__atomic_sub_fetch(&logger_producers, 1u, __ATOMIC_RELEASE);
+ }
  
+ static void logger_lock(void)
+ {
+     if (logger_use_thread_safety != 0) {
+         (void)pthread_mutex_lock(&logger_mutex);
+     }
+ }
+ 
+ static void logger_unlock(void)
+ {
      if (logger_use_thread_safety != 0) {
          (void)pthread_mutex_unlock(&logger_mutex);
      }
  }
  
- void logger_file_output(LoggerLevel level, const char *timestamp, const char *message)
+ static void logger_enqueue(const LoggerRecord *record)
+ {
+     while (ringBufferMpmc_push(&logger_queue, record) != 0) {
+         /* The consumer itself must never wait on its own queue. */
+         if ((logger_async_config.overflow != LOGGER_OVERFLOW_BLOCK) || (logger_is_consumer != 0u)) {
+             (void)__atomic_add_fetch(&logger_dropped, 1u, __ATOMIC_RELAXED);
+             return;
+         }
+         logger_wait_progress();
+     }
+ }
+ 
+ /* Delivers up to max records, logger_mutex held. */
+ static uint32_t logger_drain_locked(uint32_t max_records)
+ {
+     LoggerRecord batch[LOGGER_ASYNC_BATCH];
+     uint32_t total = 0u;
+ 
+     logger_is_consumer = 1u;
+     while ((max_records == 0u) || (total < max_records)) {
+         uint32_t wanted = LOGGER_ASYNC_BATCH;
+         if ((max_records != 0u) && ((max_records - total) < wanted)) {
+             wanted = max_records - total;
+         }
+ 
+         uint32_t n = ringBufferMpmc_popBatch(&logger_queue, batch, wanted);
+         if (n == 0u) {
+             break;
+         }
+         for (uint32_t i = 0u; i < n; i++) {
+             if (batch[i].deferred != 0u) {
+                 logger_deliver_deferred(batch[i].level, batch[i].time_ns, batch[i].format,
+                                         batch[i].data.args, batch[i].args_size);
+             } else {
+                 logger_deliver_text(batch[i].level, batch[i].time_ns,
+                                     (batch[i].has_timestamp != 0u) ? batch[i].timestamp : (const char *)0,
+                                     batch[i].data.message);
+             }
+         }
+         (void)__atomic_add_fetch(&logger_delivered, n, __ATOMIC_RELEASE);
+         total += n;
+     }
+ 
+     if (logger_async_config.overflow == LOGGER_OVERFLOW_COUNT) {
+         uint64_t dropped = __atomic_load_n(&logger_dropped, __ATOMIC_RELAXED);
+         if (dropped != logger_dropped_reported) {
+             char report[64];
+             (void)snprintf(report, sizeof(report), "logger: %llu messages dropped",
+                            (unsigned long long)(dropped - logger_dropped_reported));
+             logger_deliver_text(LOGGER_LEVEL_WARN, logger_stamp((const char *)0), (const char *)0, report);
+             logger_dropped_reported = dropped;
+         }
+     }
+     logger_is_consumer = 0u;
+ 
+     if (total != 0u) {
+         (void)pthread_mutex_lock(&logger_async_mutex);
+         if (logger_waiters != 0u) {
+             (void)pthread_cond_broadcast(&logger_progress_cond);
+         }
+         (void)pthread_mutex_unlock(&logger_async_mutex);
+     }
+     return total;
+ }
+ 
+ static uint32_t logger_drain_all(uint32_t max_records)
+ {
+     uint32_t delivered;
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     delivered = logger_drain_locked(max_records);
+     (void)pthread_mutex_unlock(&logger_mutex);
+     return delivered;
+ }
+ 
+ static void *logger_flusher(void *arg)
+ {
+     (void)arg;
+ 
+     for (;;) {
+         (void)logger_drain_all(0u);
+ 
+         /* Lines buffered by the file sink must not outlive its flush interval while idle. */
+         int32_t idle = logger_file_sink_idle_ms();
+         if (idle == 0) {
+             logger_file_sink_flush();
+             idle = logger_file_sink_idle_ms();
+         }
+ 
+         (void)pthread_mutex_lock(&logger_async_mutex);
+         while ((logger_wake_pending == 0u) && (logger_stop == 0u)) {
+             if (idle < 0) {
+                 (void)pthread_cond_wait(&logger_wake_cond, &logger_async_mutex);
+             } else {
+                 struct timespec ts;
+                 logger_deadline_ms(&ts, (uint32_t)idle);
+                 if (pthread_cond_timedwait(&logger_wake_cond, &logger_async_mutex, &ts) != 0) {
+                     break;
+                 }
+             }
+         }
+         logger_wake_pending = 0u;
+         uint8_t stop = logger_stop;
+         (void)pthread_mutex_unlock(&logger_async_mutex);
+ 
+         if ((stop != 0u) && (ringBufferMpmc_count(&logger_queue) == 0u)) {
+             break;
+         }
+     }
+     return (void *)0;
+ }
+ 
+ void logger_get_default_async_config(LoggerAsyncConfig *config)
+ {
+     if (config == (LoggerAsyncConfig *)0) {
+         return;
+     }
+ 
+     config->capacity = 1024u;
+     config->overflow = LOGGER_OVERFLOW_COUNT;
+     config->use_thread = 1;
+     config->notify = (LoggerNotify)0;
+     config->notify_arg = (void *)0;
+ }
+ 
+ int logger_start_async(const LoggerAsyncConfig *config)
+ {
+     LoggerAsyncConfig defaults;
+ 
+     if (config == (const LoggerAsyncConfig *)0) {
+         logger_get_default_async_config(&defaults);
+         config = &defaults;
+     }
+     if ((__atomic_load_n(&logger_mode, __ATOMIC_ACQUIRE) != LOGGER_MODE_SYNC) ||
+         (config->overflow > LOGGER_OVERFLOW_BLOCK) ||
+         (ringBufferMpmc_init(&logger_queue, (void *)0, config->capacity, (uint32_t)sizeof(LoggerRecord)) != 0)) {
+         return -1;
+     }
+ 
+     logger_async_config = *config;
+     logger_delivered = 0u;
+     logger_dropped = 0u;
+     logger_dropped_reported = 0u;
+     logger_wake_pending = 0u;
+     logger_stop = 0u;
+ 
+     if (config->use_thread != 0) {
+         ringBufferMpmc_setNotify(&logger_queue, logger_wake_flusher, (void *)0);
+         if (pthread_create(&logger_thread, (const pthread_attr_t *)0, logger_flusher, (void *)0) != 0) {
+             ringBufferMpmc_destroy(&logger_queue);
+             return -1;
+         }
+         logger_thread_running = 1u;
+     } else {
+         ringBufferMpmc_setNotify(&logger_queue, config->notify, config->notify_arg);
+     }
+ 
+     __atomic_store_n(&logger_mode, LOGGER_MODE_ASYNC, __ATOMIC_RELEASE);
+     return 0;
+ }
+ 
+ uint32_t logger_drain(uint32_t max_records)
+ {
+     if (__atomic_load_n(&logger_mode, __ATOMIC_ACQUIRE) != LOGGER_MODE_ASYNC) {
+         return 0u;
+     }
+     return logger_drain_all(max_records);
+ }
+ 
+ static void logger_flush_outputs(void)
+ {
+     (void)pthread_mutex_lock(&logger_mutex);
+     if (logger_binary_file != (FILE *)0) {
+         (void)fflush(logger_binary_file);
+     }
+     (void)pthread_mutex_unlock(&logger_mutex);
+     logger_file_sink_flush();
+ }
+ 
+ void logger_flush(void)
+ {
+     if (logger_is_consumer != 0u) {
+         return;
+     }
+     if (__atomic_load_n(&logger_mode, __ATOMIC_ACQUIRE) != LOGGER_MODE_ASYNC) {
+         logger_sinks_flush();
+         logger_flush_outputs();
+         return;
+     }
+ 
+     /* Every position below the enqueue index is claimed, if not yet published. */
+     uint32_t target = __atomic_load_n(&logger_queue.enqueuePos, __ATOMIC_ACQUIRE);
+     while ((int32_t)(__atomic_load_n(&logger_delivered, __ATOMIC_ACQUIRE) - target) < 0) {
+         if (logger_thread_running != 0u) {
+             logger_wait_progress();
+         } else if (logger_drain(0u) == 0u) {
+             (void)sched_yield();
+         }
+     }
+     logger_sinks_flush();
+     logger_flush_outputs();
+ }
+ 
+ void logger_shutdown(void)
+ {
+     LoggerMode expected = LOGGER_MODE_ASYNC;
+ 
+     if (!__atomic_compare_exchange_n(&logger_mode, &expected, LOGGER_MODE_SYNC, 0,
+                                      __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+         return;
+     }
+ 
+     /* Producers that saw the asynchronous mode finish their push, blocked ones need a consumer. */
+     while (__atomic_load_n(&logger_producers, __ATOMIC_SEQ_CST) != 0u) {
+         if (logger_thread_running == 0u) {
+             (void)logger_drain_all(0u);
+         }
+         (void)sched_yield();
+     }
+ 
+     if (logger_thread_running != 0u) {
+         (void)pthread_mutex_lock(&logger_async_mutex);
+         logger_stop = 1u;
+         (void)pthread_cond_signal(&logger_wake_cond);
+         (void)pthread_mutex_unlock(&logger_async_mutex);
+         (void)pthread_join(logger_thread, (void **)0);
+         logger_thread_running = 0u;
+     }
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     (void)logger_drain_locked(0u);
+     ringBufferMpmc_destroy(&logger_queue);
+     (void)pthread_mutex_unlock(&logger_mutex);
+     logger_flush_outputs();
+ }
+ 
+ uint64_t logger_get_dropped_count(void)
+ {
+     return __atomic_load_n(&logger_dropped, __ATOMIC_RELAXED);
+ }
+ 
+ /* The only check on the path of a discarded message: one relaxed load. */
+ static int logger_passes(int module, LoggerLevel level)
+ {
+     if ((module < 0) || (module >= (int)LOGGER_MAX_MODULES)) {
+         module = LOGGER_MODULE_DEFAULT;
+     }
+     return ((uint8_t)level >= __atomic_load_n(&logger_thresholds[module], __ATOMIC_RELAXED)) ? 1 : 0;
+ }
+ 
+ void logger_set_level(LoggerLevel level)
+ {
+     if (level > LOGGER_LEVEL_MAX) {
+         return;
+     }
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     logger_global_level = (uint8_t)level;
+     for (uint32_t i = 0u; i < LOGGER_MAX_MODULES; i++) {
+         if (logger_module_override[i] == 0u) {
+             __atomic_store_n(&logger_thresholds[i], (uint8_t)level, __ATOMIC_RELAXED);
+         }
+     }
+     (void)pthread_mutex_unlock(&logger_mutex);
+ }
+ 
+ LoggerLevel logger_get_level(void)
+ {
+     return (LoggerLevel)__atomic_load_n(&logger_global_level, __ATOMIC_RELAXED);
+ }
+ 
+ int logger_register_module(const char *name)
+ {
+     int module = -1;
+ 
+     if (name == (const char *)0) {
+         return -1;
+     }
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     for (uint32_t i = 0u; i < logger_module_count; i++) {
+         if (strncmp(logger_module_names[i], name, LOGGER_MODULE_NAME_SIZE - 1u) == 0) {
+             module = (int)i;
+             break;
+         }
+     }
+     if ((module < 0) && (logger_module_count < LOGGER_MAX_MODULES)) {
+         module = (int)logger_module_count++;
+         logger_copy_string(logger_module_names[module], name, LOGGER_MODULE_NAME_SIZE);
+     }
+     (void)pthread_mutex_unlock(&logger_mutex);
+ 
+     return module;
+ }
+ 
+ int logger_set_module_level(int module, LoggerLevel level)
+ {
+     if ((module < 0) || (module >= (int)LOGGER_MAX_MODULES) || (level > LOGGER_LEVEL_MAX)) {
+         return -1;
+     }
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     logger_module_override[module] = 1u;
+     __atomic_store_n(&logger_thresholds[module], (uint8_t)level, __ATOMIC_RELAXED);
+     (void)pthread_mutex_unlock(&logger_mutex);
+     return 0;
+ }
+ 
+ void logger_reset_module_level(int module)
+ {
+     if ((module < 0) || (module >= (int)LOGGER_MAX_MODULES)) {
+         return;
+     }
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     logger_module_override[module] = 0u;
+     __atomic_store_n(&logger_thresholds[module], logger_global_level, __ATOMIC_RELAXED);
+     (void)pthread_mutex_unlock(&logger_mutex);
+ }
+ 
+ int logger_is_enabled(int module, LoggerLevel level)
+ {
+     return (level < LOGGER_LEVEL_MAX) ? logger_passes(module, level) : 0;
+ }
+ 
+ void logger_log_message(LoggerLevel level, const char *message, const char *timestamp)
+ {
+     logger_log_module_message(LOGGER_MODULE_DEFAULT, level, message, timestamp);
+ }
+ 
+ void logger_log_module_message(int module, LoggerLevel level, const char *message, const char *timestamp)
+ {
+     if ((level >= LOGGER_LEVEL_MAX) || (message == (const char *)0) || (logger_passes(module, level) == 0)) {
+         return;
+     }
+ 
+     if (logger_async_begin() != 0) {
+         LoggerRecord record;
+ 
+         record.level = level;
+         record.deferred = 0u;
+         record.time_ns = logger_stamp(timestamp);
+         record.has_timestamp = (timestamp != (const char *)0) ? 1u : 0u;
+         if (record.has_timestamp != 0u) {
+             logger_copy_string(record.timestamp, timestamp, sizeof(record.timestamp));
+         }
+         logger_copy_string(record.data.message, message, sizeof(record.data.message));
+         logger_enqueue(&record);
+         logger_async_end();
+         return;
+     }
+ 
+     uint64_t time_ns = logger_stamp(timestamp);
+     logger_lock();
+     logger_deliver_text(level, time_ns, timestamp, message);
+     logger_unlock();
+ }
+ 
+ static void logger_vlogf(LoggerLevel level, const char *format, va_list ap)
+ {
+     uint64_t time_ns = logger_stamp((const char *)0);
+ 
+     if (logger_async_begin() != 0) {
+         LoggerRecord record;
+ 
+         record.level = level;
+         record.deferred = 1u;
+         record.time_ns = time_ns;
+         record.has_timestamp = 0u;
+         record.format = format;
+         record.args_size = (uint16_t)logger_format_capture(record.data.args, sizeof(record.data.args), format, ap);
+         logger_enqueue(&record);
+         logger_async_end();
+     } else {
+         uint8_t args[LOGGER_ASYNC_MESSAGE_SIZE];
+         size_t args_size = logger_format_capture(args, sizeof(args), format, ap);
+ 
+         logger_lock();
+         logger_deliver_deferred(level, time_ns, format, args, args_size);
+         logger_unlock();
+     }
+ }
+ 
+ void logger_logf(LoggerLevel level, const char *format, ...)
+ {
+     va_list ap;
+ 
+     if ((level >= LOGGER_LEVEL_MAX) || (format == (const char *)0) || (logger_passes(LOGGER_MODULE_DEFAULT, level) == 0)) {
+         return;
+     }
+ 
+     va_start(ap, format);
+     logger_vlogf(level, format, ap);
+     va_end(ap);
+ }
+ 
+ void logger_logf_module(int module, LoggerLevel level, const char *format, ...)
+ {
+     va_list ap;
+ 
+     if ((level >= LOGGER_LEVEL_MAX) || (format == (const char *)0) || (logger_passes(module, level) == 0)) {
+         return;
+     }
+ 
+     va_start(ap, format);
+     logger_vlogf(level, format, ap);
+     va_end(ap);
+ }
+ 
+ void logger_get_default_sink_config(LoggerSinkConfig *config)
+ {
+     if (config == (LoggerSinkConfig *)0) {
+         return;
+     }
+ 
+     config->output = (LoggerCallback)0;
+     config->level = LOGGER_LEVEL_DEBUG;
+     config->mode = LOGGER_SINK_INLINE;
+     config->capacity = 1024u;
+     config->overflow = LOGGER_OVERFLOW_COUNT;
+ }
+ 
+ int logger_add_sink(const LoggerSinkConfig *config)
+ {
+     LoggerSink *sink = (LoggerSink *)0;
+     int id = -1;
+ 
+     if ((config == (const LoggerSinkConfig *)0) || (config->output == (LoggerCallback)0) ||
+         (config->level > LOGGER_LEVEL_MAX) || (config->mode > LOGGER_SINK_ASYNC) ||
+         (config->overflow > LOGGER_OVERFLOW_COUNT)) {
+         return -1;
+     }
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     for (uint32_t i = 0u; i < LOGGER_MAX_SINKS; i++) {
+         if (logger_sinks[i].state == (uint8_t)LOGGER_SINK_FREE) {
+             id = (int)i;
+             sink = &logger_sinks[i];
+             break;
+         }
+     }
+     if (sink == (LoggerSink *)0) {
+         (void)pthread_mutex_unlock(&logger_mutex);
+         return -1;
+     }
+ 
+     (void)memset(sink, 0, sizeof(*sink));
+     sink->config = *config;
+     sink->level = (uint8_t)config->level;
+     if (config->mode == LOGGER_SINK_ASYNC) {
+         if (ringBufferMpmc_init(&sink->queue, (void *)0, config->capacity, (uint32_t)sizeof(LoggerRecord)) != 0) {
+             (void)pthread_mutex_unlock(&logger_mutex);
+             return -1;
+         }
+         (void)pthread_mutex_init(&sink->mutex, (const pthread_mutexattr_t *)0);
+         (void)pthread_cond_init(&sink->wake_cond, (const pthread_condattr_t *)0);
+         (void)pthread_cond_init(&sink->progress_cond, (const pthread_condattr_t *)0);
+         ringBufferMpmc_setNotify(&sink->queue, logger_sink_wake, sink);
+         if (pthread_create(&sink->thread, (const pthread_attr_t *)0, logger_sink_thread, sink) != 0) {
+             ringBufferMpmc_destroy(&sink->queue);
+             (void)pthread_mutex_destroy(&sink->mutex);
+             (void)pthread_cond_destroy(&sink->wake_cond);
+             (void)pthread_cond_destroy(&sink->progress_cond);
+             (void)pthread_mutex_unlock(&logger_mutex);
+             return -1;
+         }
+     }
+ 
+     __atomic_store_n(&sink->state, (uint8_t)LOGGER_SINK_ACTIVE, __ATOMIC_RELEASE);
+     if ((uint32_t)id >= logger_sink_count) {
+         __atomic_store_n(&logger_sink_count, (uint32_t)id + 1u, __ATOMIC_RELEASE);
+     }
+     (void)pthread_mutex_unlock(&logger_mutex);
+ 
+     return id;
+ }
+ 
+ int logger_set_sink_level(int sink, LoggerLevel level)
  {
-     const char *level_names[LOGGER_LEVEL_COUNT] = {
-         "DEBUG", "INFO", "WARN", "ERROR"
-     };
+     int result = -1;
  
+     if ((sink < 0) || (sink >= (int)LOGGER_MAX_SINKS) || (level > LOGGER_LEVEL_MAX)) {
+         return -1;
+     }
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     if (logger_sinks[sink].state == (uint8_t)LOGGER_SINK_ACTIVE) {
+         __atomic_store_n(&logger_sinks[sink].level, (uint8_t)level, __ATOMIC_RELAXED);
+         result = 0;
+     }
+     (void)pthread_mutex_unlock(&logger_mutex);
+     return result;
+ }
+ 
+ void logger_remove_sink(int sink)
+ {
+     LoggerSink *entry;
+ 
+     if ((sink < 0) || (sink >= (int)LOGGER_MAX_SINKS)) {
+         return;
+     }
+     entry = &logger_sinks[sink];
+ 
+     /* Deliveries run under logger_mutex: none reaches the sink once it is closing. */
+     (void)pthread_mutex_lock(&logger_mutex);
+     if (entry->state != (uint8_t)LOGGER_SINK_ACTIVE) {
+         (void)pthread_mutex_unlock(&logger_mutex);
+         return;
+     }
+     __atomic_store_n(&entry->state, (uint8_t)LOGGER_SINK_CLOSING, __ATOMIC_RELEASE);
+     (void)pthread_mutex_unlock(&logger_mutex);
+ 
+     if (entry->config.mode == LOGGER_SINK_ASYNC) {
+         (void)pthread_mutex_lock(&entry->mutex);
+         entry->stop = 1u;
+         (void)pthread_cond_signal(&entry->wake_cond);
+         (void)pthread_mutex_unlock(&entry->mutex);
+         (void)pthread_join(entry->thread, (void **)0);
+         while (__atomic_load_n(&entry->users, __ATOMIC_ACQUIRE) != 0u) {
+             (void)sched_yield();
+         }
+         ringBufferMpmc_destroy(&entry->queue);
+         (void)pthread_mutex_destroy(&entry->mutex);
+         (void)pthread_cond_destroy(&entry->wake_cond);
+         (void)pthread_cond_destroy(&entry->progress_cond);
+     }
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     __atomic_store_n(&entry->state, (uint8_t)LOGGER_SINK_FREE, __ATOMIC_RELEASE);
+     uint32_t count = logger_sink_count;
+     while ((count > 0u) && (logger_sinks[count - 1u].state == (uint8_t)LOGGER_SINK_FREE)) {
+         count--;
+     }
+     __atomic_store_n(&logger_sink_count, count, __ATOMIC_RELEASE);
+     (void)pthread_mutex_unlock(&logger_mutex);
+ }
+ 
+ uint64_t logger_get_sink_dropped_count(int sink)
+ {
+     if ((sink < 0) || (sink >= (int)LOGGER_MAX_SINKS)) {
+         return 0u;
+     }
+     return __atomic_load_n(&logger_sinks[sink].dropped, __ATOMIC_RELAXED);
+ }
+ 
+ void logger_set_binary_file(void *file)
+ {
+     (void)pthread_mutex_lock(&logger_mutex);
+     if (logger_binary_file != (FILE *)0) {
+         (void)fflush(logger_binary_file);
+     }
+     logger_binary_file = (FILE *)file;
+     if (logger_binary_file != (FILE *)0) {
+         if (__atomic_load_n(&logger_time_offset_ns, __ATOMIC_RELAXED) == 0) {
+             __atomic_store_n(&logger_time_offset_ns, logger_time_offset(), __ATOMIC_RELAXED);
+         }
+         logger_binary_begin(logger_binary_file, __atomic_load_n(&logger_time_offset_ns, __ATOMIC_RELAXED));
+     }
+     (void)pthread_mutex_unlock(&logger_mutex);
+ }
+ 
+ void logger_set_timestamp_mode(LoggerTimestampMode mode)
+ {
+     if (mode > LOGGER_TIMESTAMP_REALTIME) {
+         return;
+     }
+ 
+     (void)pthread_mutex_lock(&logger_mutex);
+     __atomic_store_n(&logger_time_offset_ns, logger_time_offset(), __ATOMIC_RELAXED);
+     __atomic_store_n(&logger_timestamp_mode, (uint8_t)mode, __ATOMIC_RELAXED);
+     (void)pthread_mutex_unlock(&logger_mutex);
+ }
+ 
+ LoggerTimestampMode logger_get_timestamp_mode(void)
+ {
+     return (LoggerTimestampMode)__atomic_load_n(&logger_timestamp_mode, __ATOMIC_RELAXED);
+ }
+ 
+ void logger_file_output(LoggerLevel level, const char *timestamp, const char *message)
+ {
      if ((level >= LOGGER_LEVEL_MAX) || (message == (const char *)0)) {
          return;
      }
@@ -74,9 +1067,9 @@
      }
  
      if (timestamp != (const char *)0) {
-         (void)fprintf(logger_output_file, "[%s] [%s] %s\n", timestamp, level_names[level], message);
+         (void)fprintf(logger_output_file, "[%s] [%s] %s\n", timestamp, logger_level_name(level), message);
      } else {
-         (void)fprintf(logger_output_file, "[%s] %s\n", level_names[level], message);
+         (void)fprintf(logger_output_file, "[%s] %s\n", logger_level_name(level), message);
      }
  
      (void)fflush(logger_output_file);
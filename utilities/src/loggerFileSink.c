@@ -0,0 +1,287 @@
+/**
+ *  \file loggerFileSink.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 16 APR 2025
+ *
+ *  @brief Buffered log file sink.
+ *
+ *  Lines are formatted into a set of large buffers and the filled ones are
+ *  written with a single writev(), so a burst of records costs one system
+ *  call per buffer_count * buffer_size bytes instead of one per line.
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include "logger.h"
+ #include "loggerFormat.h"
+ #include <errno.h>
+ #include <fcntl.h>
+ #include <pthread.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <sys/uio.h>
+ #include <time.h>
+ #include <unistd.h>
+
+ #define LOGGER_FILE_SINK_PREFIX_SIZE 64u
+
+ static pthread_mutex_t logger_sink_mutex = PTHREAD_MUTEX_INITIALIZER;
+ static LoggerFileSinkConfig logger_sink_config;
+ static LoggerFileSinkStats logger_sink_stats;
+ static int logger_sink_fd = -1;
+ static char *logger_sink_storage = (char *)0;
+ static struct iovec *logger_sink_iov = (struct iovec *)0;
+ static uint32_t logger_sink_current = 0u;           /* Buffer being filled. */
+ static uint64_t logger_sink_last_flush = 0u;        /* Monotonic ms. */
+
+ static uint64_t logger_sink_now_ms(void)
+ {
+     struct timespec ts;
+
+     (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+     return ((uint64_t)ts.tv_sec * 1000u) + ((uint64_t)ts.tv_nsec / 1000000u);
+ }
+
+ /* Writes all of iov, resuming after partial writes. */
+ static int logger_sink_writev(struct iovec *iov, int count)
+ {
+     while (count > 0) {
+         ssize_t written = writev(logger_sink_fd, iov, count);
+         if (written < 0) {
+             if (errno == EINTR) {
+                 continue;
+             }
+             logger_sink_stats.errors++;
+             return -1;
+         }
+         logger_sink_stats.writes++;
+         logger_sink_stats.bytes += (uint64_t)written;
+
+         while ((count > 0) && ((size_t)written >= iov->iov_len)) {
+             written -= (ssize_t)iov->iov_len;
+             iov++;
+             count--;
+         }
+         if (count > 0) {
+             iov->iov_base = (char *)iov->iov_base + written;
+             iov->iov_len -= (size_t)written;
+         }
+     }
+     return 0;
+ }
+
+ /* Writes every buffered byte, logger_sink_mutex held. */
+ static void logger_sink_flush_locked(int sync)
+ {
+     int count = (int)logger_sink_current + 1;
+
+     if (logger_sink_iov[logger_sink_current].iov_len == 0u) {
+         count--;
+     }
+     if (count > 0) {
+         (void)logger_sink_writev(logger_sink_iov, count);
+         /* Partial writes moved the bases: reset every buffer. */
+         for (uint32_t i = 0u; i < logger_sink_config.buffer_count; i++) {
+             logger_sink_iov[i].iov_base = &logger_sink_storage[(size_t)i * logger_sink_config.buffer_size];
+             logger_sink_iov[i].iov_len = 0u;
+         }
+         logger_sink_current = 0u;
+     }
+
+     if ((sync != 0) && (logger_sink_config.sync_on_flush != 0)) {
+         if (fdatasync(logger_sink_fd) == 0) {
+             logger_sink_stats.syncs++;
+             if (logger_sink_config.drop_cache != 0) {
+                 (void)posix_fadvise(logger_sink_fd, 0, 0, POSIX_FADV_DONTNEED);
+             }
+         } else {
+             logger_sink_stats.errors++;
+         }
+     }
+     logger_sink_last_flush = logger_sink_now_ms();
+ }
+
+ void logger_get_default_file_sink_config(LoggerFileSinkConfig *config)
+ {
+     if (config == (LoggerFileSinkConfig *)0) {
+         return;
+     }
+
+     config->buffer_size = 64u * 1024u;
+     config->buffer_count = 4u;
+     config->flush_interval_ms = 1000u;
+     config->flush_level = LOGGER_LEVEL_ERROR;
+     config->sync_on_flush = 0;
+     config->drop_cache = 0;
+ }
+
+ int logger_file_sink_open(const char *path, const LoggerFileSinkConfig *config)
+ {
+     LoggerFileSinkConfig defaults;
+     long iov_max = sysconf(_SC_IOV_MAX);
+     int fd;
+
+     if (config == (const LoggerFileSinkConfig *)0) {
+         logger_get_default_file_sink_config(&defaults);
+         config = &defaults;
+     }
+     if ((path == (const char *)0) || (config->buffer_size < LOGGER_FILE_SINK_PREFIX_SIZE) ||
+         (config->buffer_count == 0u) || ((iov_max > 0) && (config->buffer_count > (uint32_t)iov_max)) ||
+         (config->flush_level > LOGGER_LEVEL_MAX)) {
+         return -1;
+     }
+
+     (void)pthread_mutex_lock(&logger_sink_mutex);
+     if (logger_sink_fd >= 0) {
+         (void)pthread_mutex_unlock(&logger_sink_mutex);
+         return -1;
+     }
+
+     fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+     logger_sink_storage = (char *)malloc((size_t)config->buffer_count * config->buffer_size);
+     logger_sink_iov = (struct iovec *)calloc(config->buffer_count, sizeof(struct iovec));
+     if ((fd < 0) || (logger_sink_storage == (char *)0) || (logger_sink_iov == (struct iovec *)0)) {
+         if (fd >= 0) {
+             (void)close(fd);
+         }
+         free(logger_sink_storage);
+         free(logger_sink_iov);
+         logger_sink_storage = (char *)0;
+         logger_sink_iov = (struct iovec *)0;
+         (void)pthread_mutex_unlock(&logger_sink_mutex);
+         return -1;
+     }
+
+     logger_sink_config = *config;
+     logger_sink_fd = fd;
+     (void)memset(&logger_sink_stats, 0, sizeof(logger_sink_stats));
+     for (uint32_t i = 0u; i < config->buffer_count; i++) {
+         logger_sink_iov[i].iov_base = &logger_sink_storage[(size_t)i * config->buffer_size];
+         logger_sink_iov[i].iov_len = 0u;
+     }
+     logger_sink_current = 0u;
+     logger_sink_last_flush = logger_sink_now_ms();
+     (void)pthread_mutex_unlock(&logger_sink_mutex);
+
+     return 0;
+ }
+
+ void logger_file_sink_output(LoggerLevel level, const char *timestamp, const char *message)
+ {
+     char prefix[LOGGER_FILE_SINK_PREFIX_SIZE];
+     size_t prefix_length;
+     size_t message_length;
+
+     if ((level >= LOGGER_LEVEL_MAX) || (message == (const char *)0)) {
+         return;
+     }
+
+     if (timestamp != (const char *)0) {
+         (void)snprintf(prefix, sizeof(prefix), "[%s] [%s] ", timestamp, logger_level_name(level));
+     } else {
+         (void)snprintf(prefix, sizeof(prefix), "[%s] ", logger_level_name(level));
+     }
+     prefix_length = strlen(prefix);
+     message_length = strlen(message);
+
+     (void)pthread_mutex_lock(&logger_sink_mutex);
+     if (logger_sink_fd < 0) {
+         (void)pthread_mutex_unlock(&logger_sink_mutex);
+         return;
+     }
+
+     size_t length = prefix_length + message_length + 1u;
+     struct iovec *iov = &logger_sink_iov[logger_sink_current];
+     if ((iov->iov_len + length) > logger_sink_config.buffer_size) {
+         if ((logger_sink_current + 1u) < logger_sink_config.buffer_count) {
+             logger_sink_current++;
+         } else {
+             logger_sink_flush_locked(0);
+         }
+         iov = &logger_sink_iov[logger_sink_current];
+     }
+
+     if (length > logger_sink_config.buffer_size) {
+         /* Longer than a buffer: write it in place, after what is buffered. */
+         struct iovec line[3] = {
+             { prefix, prefix_length },
+             { (void *)(uintptr_t)message, message_length },
+             { (void *)(uintptr_t)"\n", 1u }
+         };
+         logger_sink_flush_locked(0);
+         (void)logger_sink_writev(line, 3);
+     } else {
+         char *end = (char *)iov->iov_base + iov->iov_len;
+         (void)memcpy(end, prefix, prefix_length);
+         (void)memcpy(&end[prefix_length], message, message_length);
+         end[prefix_length + message_length] = '\n';
+         iov->iov_len += length;
+     }
+     logger_sink_stats.records++;
+
+     if (level >= logger_sink_config.flush_level) {
+         logger_sink_flush_locked(1);
+     } else if ((logger_sink_config.flush_interval_ms != 0u) &&
+                ((logger_sink_now_ms() - logger_sink_last_flush) >= logger_sink_config.flush_interval_ms)) {
+         logger_sink_flush_locked(1);
+     } else {
+         /* Stays buffered. */
+     }
+     (void)pthread_mutex_unlock(&logger_sink_mutex);
+ }
+
+ void logger_file_sink_flush(void)
+ {
+     (void)pthread_mutex_lock(&logger_sink_mutex);
+     if (logger_sink_fd >= 0) {
+         logger_sink_flush_locked(1);
+     }
+     (void)pthread_mutex_unlock(&logger_sink_mutex);
+ }
+
+ int32_t logger_file_sink_idle_ms(void)
+ {
+     int32_t wait = -1;
+
+     (void)pthread_mutex_lock(&logger_sink_mutex);
+     if ((logger_sink_fd >= 0) && (logger_sink_config.flush_interval_ms != 0u) &&
+         ((logger_sink_current != 0u) || (logger_sink_iov[0].iov_len != 0u))) {
+         uint64_t elapsed = logger_sink_now_ms() - logger_sink_last_flush;
+         wait = (elapsed >= logger_sink_config.flush_interval_ms) ? 0 :
+                (int32_t)(logger_sink_config.flush_interval_ms - elapsed);
+     }
+     (void)pthread_mutex_unlock(&logger_sink_mutex);
+
+     return wait;
+ }
+
+ void logger_file_sink_close(void)
+ {
+     (void)pthread_mutex_lock(&logger_sink_mutex);
+     if (logger_sink_fd >= 0) {
+         logger_sink_flush_locked(1);
+         (void)close(logger_sink_fd);
+         logger_sink_fd = -1;
+         free(logger_sink_storage);
+         free(logger_sink_iov);
+         logger_sink_storage = (char *)0;
+         logger_sink_iov = (struct iovec *)0;
+     }
+     (void)pthread_mutex_unlock(&logger_sink_mutex);
+ }
+
+ void logger_file_sink_get_stats(LoggerFileSinkStats *stats)
+ {
+     if (stats == (LoggerFileSinkStats *)0) {
+         return;
+     }
+
+     (void)pthread_mutex_lock(&logger_sink_mutex);
+     *stats = logger_sink_stats;
+     (void)pthread_mutex_unlock(&logger_sink_mutex);
+ }
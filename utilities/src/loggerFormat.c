@@ -0,0 +1,772 @@
+/**
+ *  \file loggerFormat.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 16 APR 2025
+ *
+ *  @brief Deferred formatting, logger timestamps and binary log records.
+ *
+ *  Binary log file layout, native byte order:
+ *  \n "LOGB" + version byte, then records tagged by one byte:
+ *  \n 'C' i64 offset                                 - wall clock minus monotonic, ns
+ *  \n 'F' u64 id, u16 length, bytes                  - format string, once per id
+ *  \n 'D' u8 level, u64 time, u64 id, u16 size, args - deferred record
+ *  \n 'T' u8 level, u64 time, u16 length, timestamp, u16 length, message
+ *
+ *  The id of a format is its address in the writing process, time is the
+ *  monotonic nanoseconds stamped by the logger (0 = none). A record cut
+ *  short by a crash ends the decoding.
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include "loggerFormat.h"
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+
+ #define LOGGER_BINARY_VERSION 2u
+ #define LOGGER_NS_PER_SECOND 1000000000
+ #define LOGGER_FORMAT_SEEN_SIZE 256u
+ #define LOGGER_FORMAT_SEEN_PROBES 8u
+ #define LOGGER_SPEC_SIZE 32u
+ #define LOGGER_DECODE_SIZE 1024u
+
+ /**
+  * @brief Length modifier of a conversion.
+  */
+ typedef enum {
+     LOGGER_LENGTH_NONE = 0,
+     LOGGER_LENGTH_HH,
+     LOGGER_LENGTH_H,
+     LOGGER_LENGTH_L,
+     LOGGER_LENGTH_LL,
+     LOGGER_LENGTH_J,
+     LOGGER_LENGTH_Z,
+     LOGGER_LENGTH_T,
+     LOGGER_LENGTH_BIG_L
+ } LoggerLength;
+
+ /**
+  * @brief One parsed conversion specification.
+  */
+ typedef struct {
+     char flags[8];
+     size_t flags_length;
+     int width;                  /* -1 = none */
+     int precision;              /* -1 = none */
+     uint8_t star_width;
+     uint8_t star_precision;
+     LoggerLength length;
+     char conversion;
+ } LoggerSpec;
+
+ /**
+  * @brief Text up to the second of the last timestamp formatted by a thread.
+  */
+ typedef struct {
+     int64_t second;
+     int wall;
+     size_t length;
+     char text[LOGGER_TIME_TEXT_SIZE];
+ } LoggerTimeCache;
+
+ static const char *logger_format_seen[LOGGER_FORMAT_SEEN_SIZE];
+ static __thread LoggerTimeCache logger_time_cache = { -1, 0, 0u, { '\0' } };
+
+ const char *logger_level_name(LoggerLevel level)
+ {
+     static const char *const names[LOGGER_LEVEL_MAX] = {
+         "DEBUG", "INFO", "WARN", "ERROR"
+     };
+
+     return (level < LOGGER_LEVEL_MAX) ? names[level] : "?";
+ }
+
+ static uint16_t logger_format_length(const char *text, size_t max)
+ {
+     const char *end = (const char *)memchr(text, '\0', max);
+
+     return (uint16_t)((end != (const char *)0) ? (size_t)(end - text) : max);
+ }
+
+ /* Parses the specification following a '%', returns the position after it. */
+ static const char *logger_format_parse(const char *p, LoggerSpec *spec)
+ {
+     (void)memset(spec, 0, sizeof(*spec));
+     spec->width = -1;
+     spec->precision = -1;
+
+     while ((*p != '\0') && (strchr("-+ #0'", *p) != (char *)0)) {
+         if (spec->flags_length < (sizeof(spec->flags) - 1u)) {
+             spec->flags[spec->flags_length++] = *p;
+         }
+         p++;
+     }
+
+     if (*p == '*') {
+         spec->star_width = 1u;
+         p++;
+     } else {
+         while ((*p >= '0') && (*p <= '9')) {
+             spec->width = ((spec->width < 0) ? 0 : (spec->width * 10)) + (*p - '0');
+             p++;
+         }
+     }
+
+     if (*p == '.') {
+         p++;
+         spec->precision = 0;
+         if (*p == '*') {
+             spec->star_precision = 1u;
+             p++;
+         } else {
+             while ((*p >= '0') && (*p <= '9')) {
+                 spec->precision = (spec->precision * 10) + (*p - '0');
+                 p++;
+             }
+         }
+     }
+
+     switch (*p) {
+     case 'h':
+         p++;
+         spec->length = LOGGER_LENGTH_H;
+         if (*p == 'h') {
+             p++;
+             spec->length = LOGGER_LENGTH_HH;
+         }
+         break;
+     case 'l':
+         p++;
+         spec->length = LOGGER_LENGTH_L;
+         if (*p == 'l') {
+             p++;
+             spec->length = LOGGER_LENGTH_LL;
+         }
+         break;
+     case 'q':
+         p++;
+         spec->length = LOGGER_LENGTH_LL;
+         break;
+     case 'j':
+         p++;
+         spec->length = LOGGER_LENGTH_J;
+         break;
+     case 'z':
+         p++;
+         spec->length = LOGGER_LENGTH_Z;
+         break;
+     case 't':
+         p++;
+         spec->length = LOGGER_LENGTH_T;
+         break;
+     case 'L':
+         p++;
+         spec->length = LOGGER_LENGTH_BIG_L;
+         break;
+     default:
+         break;
+     }
+
+     spec->conversion = *p;
+     return (*p != '\0') ? (p + 1) : p;
+ }
+
+ static int logger_format_put(uint8_t *args, size_t size, size_t *used, const void *value, size_t length)
+ {
+     if ((size - *used) < length) {
+         return -1;
+     }
+     (void)memcpy(&args[*used], value, length);
+     *used += length;
+     return 0;
+ }
+
+ static int64_t logger_format_signed(LoggerLength length, va_list *ap)
+ {
+     switch (length) {
+     case LOGGER_LENGTH_HH:
+         return (int64_t)(signed char)va_arg(*ap, int);
+     case LOGGER_LENGTH_H:
+         return (int64_t)(short)va_arg(*ap, int);
+     case LOGGER_LENGTH_L:
+         return (int64_t)va_arg(*ap, long);
+     case LOGGER_LENGTH_LL:
+     case LOGGER_LENGTH_BIG_L:
+         return (int64_t)va_arg(*ap, long long);
+     case LOGGER_LENGTH_J:
+         return (int64_t)va_arg(*ap, intmax_t);
+     case LOGGER_LENGTH_Z:
+         return (int64_t)va_arg(*ap, size_t);
+     case LOGGER_LENGTH_T:
+         return (int64_t)va_arg(*ap, ptrdiff_t);
+     default:
+         return (int64_t)va_arg(*ap, int);
+     }
+ }
+
+ static uint64_t logger_format_unsigned(LoggerLength length, va_list *ap)
+ {
+     switch (length) {
+     case LOGGER_LENGTH_HH:
+         return (uint64_t)(unsigned char)va_arg(*ap, unsigned int);
+     case LOGGER_LENGTH_H:
+         return (uint64_t)(unsigned short)va_arg(*ap, unsigned int);
+     case LOGGER_LENGTH_L:
+         return (uint64_t)va_arg(*ap, unsigned long);
+     case LOGGER_LENGTH_LL:
+     case LOGGER_LENGTH_BIG_L:
+         return (uint64_t)va_arg(*ap, unsigned long long);
+     case LOGGER_LENGTH_J:
+         return (uint64_t)va_arg(*ap, uintmax_t);
+     case LOGGER_LENGTH_Z:
+         return (uint64_t)va_arg(*ap, size_t);
+     case LOGGER_LENGTH_T:
+         return (uint64_t)va_arg(*ap, ptrdiff_t);
+     default:
+         return (uint64_t)va_arg(*ap, unsigned int);
+     }
+ }
+
+ size_t logger_format_capture(uint8_t *args, size_t size, const char *format, va_list ap)
+ {
+     va_list copy;
+     size_t used = 0u;
+     int ok = 0;
+
+     va_copy(copy, ap);
+     while ((*format != '\0') && (ok == 0)) {
+         LoggerSpec spec;
+
+         if (*format++ != '%') {
+             continue;
+         }
+         format = logger_format_parse(format, &spec);
+
+         if (spec.star_width != 0u) {
+             int64_t value = (int64_t)va_arg(copy, int);
+             ok = logger_format_put(args, size, &used, &value, sizeof(value));
+         }
+         if ((ok == 0) && (spec.star_precision != 0u)) {
+             int64_t value = (int64_t)va_arg(copy, int);
+             ok = logger_format_put(args, size, &used, &value, sizeof(value));
+         }
+         if (ok != 0) {
+             break;
+         }
+
+         switch (spec.conversion) {
+         case 'd':
+         case 'i': {
+             int64_t value = logger_format_signed(spec.length, &copy);
+             ok = logger_format_put(args, size, &used, &value, sizeof(value));
+             break;
+         }
+         case 'u':
+         case 'o':
+         case 'x':
+         case 'X': {
+             uint64_t value = logger_format_unsigned(spec.length, &copy);
+             ok = logger_format_put(args, size, &used, &value, sizeof(value));
+             break;
+         }
+         case 'c': {
+             int64_t value = (int64_t)va_arg(copy, int);
+             ok = logger_format_put(args, size, &used, &value, sizeof(value));
+             break;
+         }
+         case 'e':
+         case 'E':
+         case 'f':
+         case 'F':
+         case 'g':
+         case 'G':
+         case 'a':
+         case 'A': {
+             double value = (spec.length == LOGGER_LENGTH_BIG_L) ? (double)va_arg(copy, long double) : va_arg(copy, double);
+             ok = logger_format_put(args, size, &used, &value, sizeof(value));
+             break;
+         }
+         case 'p': {
+             uint64_t value = (uint64_t)(uintptr_t)va_arg(copy, void *);
+             ok = logger_format_put(args, size, &used, &value, sizeof(value));
+             break;
+         }
+         case 's': {
+             const char *str = va_arg(copy, const char *);
+             if (str == (const char *)0) {
+                 str = "(null)";
+             }
+             if ((size - used) <= sizeof(uint16_t)) {
+                 ok = -1;
+                 break;
+             }
+             size_t room = size - used - sizeof(uint16_t);
+             uint16_t length = logger_format_length(str, (room < 0xFFFFu) ? room : 0xFFFFu);
+             (void)logger_format_put(args, size, &used, &length, sizeof(length));
+             (void)logger_format_put(args, size, &used, str, length);
+             break;
+         }
+         case 'n':
+             (void)va_arg(copy, void *);
+             break;
+         case '%':
+             break;
+         default:
+             /* Unknown conversion: the type of what follows is unknown too. */
+             ok = -1;
+             break;
+         }
+     }
+     va_end(copy);
+
+     return used;
+ }
+
+ static int logger_format_get(const uint8_t *args, size_t args_size, size_t *offset, void *value, size_t length)
+ {
+     if ((args_size - *offset) < length) {
+         return -1;
+     }
+     (void)memcpy(value, &args[*offset], length);
+     *offset += length;
+     return 0;
+ }
+
+ /* Rebuilds a specification with literal width/precision and the given length modifier. */
+ static void logger_format_spec(char *out, const LoggerSpec *spec, int width, int precision, const char *modifier)
+ {
+     size_t pos = 0u;
+
+     out[pos++] = '%';
+     (void)memcpy(&out[pos], spec->flags, spec->flags_length);
+     pos += spec->flags_length;
+     if (width >= 0) {
+         pos += (size_t)snprintf(&out[pos], LOGGER_SPEC_SIZE - pos, "%d", width);
+     }
+     if (precision >= 0) {
+         pos += (size_t)snprintf(&out[pos], LOGGER_SPEC_SIZE - pos, ".%d", precision);
+     }
+     (void)snprintf(&out[pos], LOGGER_SPEC_SIZE - pos, "%s%c", modifier, spec->conversion);
+ }
+
+ size_t logger_format_render(char *out, size_t size, const char *format, const uint8_t *args, size_t args_size)
+ {
+     size_t pos = 0u;
+     size_t offset = 0u;
+
+     if (size == 0u) {
+         return 0u;
+     }
+
+     while ((*format != '\0') && (pos < (size - 1u))) {
+         LoggerSpec spec;
+         char text[LOGGER_SPEC_SIZE];
+         int written = 0;
+
+         if (*format != '%') {
+             out[pos++] = *format++;
+             continue;
+         }
+         format = logger_format_parse(format + 1, &spec);
+
+         int width = spec.width;
+         int precision = spec.precision;
+         int ok = 0;
+         if (spec.star_width != 0u) {
+             int64_t value = 0;
+             ok = logger_format_get(args, args_size, &offset, &value, sizeof(value));
+             width = (int)value;
+             if (width < 0) {
+                 /* A negative '*' width means left-justified. */
+                 width = -width;
+                 if ((spec.flags_length < (sizeof(spec.flags) - 1u)) && (memchr(spec.flags, '-', spec.flags_length) == (void *)0)) {
+                     spec.flags[spec.flags_length++] = '-';
+                 }
+             }
+         }
+         if ((ok == 0) && (spec.star_precision != 0u)) {
+             int64_t value = 0;
+             ok = logger_format_get(args, args_size, &offset, &value, sizeof(value));
+             precision = (value < 0) ? -1 : (int)value;
+         }
+
+         switch (spec.conversion) {
+         case 'd':
+         case 'i':
+         case 'u':
+         case 'o':
+         case 'x':
+         case 'X': {
+             uint64_t value = 0u;
+             if ((ok == 0) && (logger_format_get(args, args_size, &offset, &value, sizeof(value)) == 0)) {
+                 logger_format_spec(text, &spec, width, precision, "ll");
+                 written = ((spec.conversion == 'd') || (spec.conversion == 'i')) ?
+                           snprintf(&out[pos], size - pos, text, (long long)value) :
+                           snprintf(&out[pos], size - pos, text, (unsigned long long)value);
+             } else {
+                 ok = -1;
+             }
+             break;
+         }
+         case 'c': {
+             int64_t value = 0;
+             if ((ok == 0) && (logger_format_get(args, args_size, &offset, &value, sizeof(value)) == 0)) {
+                 logger_format_spec(text, &spec, width, precision, "");
+                 written = snprintf(&out[pos], size - pos, text, (int)value);
+             } else {
+                 ok = -1;
+             }
+             break;
+         }
+         case 'e':
+         case 'E':
+         case 'f':
+         case 'F':
+         case 'g':
+         case 'G':
+         case 'a':
+         case 'A': {
+             double value = 0.0;
+             if ((ok == 0) && (logger_format_get(args, args_size, &offset, &value, sizeof(value)) == 0)) {
+                 logger_format_spec(text, &spec, width, precision, "");
+                 written = snprintf(&out[pos], size - pos, text, value);
+             } else {
+                 ok = -1;
+             }
+             break;
+         }
+         case 'p': {
+             uint64_t value = 0u;
+             if ((ok == 0) && (logger_format_get(args, args_size, &offset, &value, sizeof(value)) == 0)) {
+                 logger_format_spec(text, &spec, width, -1, "");
+                 written = snprintf(&out[pos], size - pos, text, (void *)(uintptr_t)value);
+             } else {
+                 ok = -1;
+             }
+             break;
+         }
+         case 's': {
+             uint16_t length = 0u;
+             if ((ok == 0) && (logger_format_get(args, args_size, &offset, &length, sizeof(length)) == 0) &&
+                 ((args_size - offset) >= length)) {
+                 int shown = ((precision >= 0) && (precision < (int)length)) ? precision : (int)length;
+                 logger_format_spec(text, &spec, width, -1, "");
+                 /* The captured bytes are not terminated: print them through "%.*s". */
+                 text[strlen(text) - 1u] = '\0';
+                 (void)strncat(text, ".*s", LOGGER_SPEC_SIZE - strlen(text) - 1u);
+                 written = snprintf(&out[pos], size - pos, text, shown, (const char *)&args[offset]);
+                 offset += length;
+             } else {
+                 ok = -1;
+             }
+             break;
+         }
+         case 'n':
+             /* Skipped at capture: prints nothing. */
+             break;
+         case '%':
+             out[pos++] = '%';
+             break;
+         default:
+             ok = -1;
+             break;
+         }
+
+         if (ok != 0) {
+             out[pos++] = '?';
+         } else if (written > 0) {
+             pos += (size_t)written;
+         }
+         if (pos > (size - 1u)) {
+             pos = size - 1u;
+         }
+     }
+     out[pos] = '\0';
+
+     return pos;
+ }
+
+ uint64_t logger_time_now(void)
+ {
+     struct timespec ts;
+     uint64_t now;
+
+     (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+     now = ((uint64_t)ts.tv_sec * (uint64_t)LOGGER_NS_PER_SECOND) + (uint64_t)ts.tv_nsec;
+     return (now != 0u) ? now : 1u;
+ }
+
+ int64_t logger_time_offset(void)
+ {
+     struct timespec real;
+     uint64_t monotonic = logger_time_now();
+
+     (void)clock_gettime(CLOCK_REALTIME, &real);
+     return (((int64_t)real.tv_sec * LOGGER_NS_PER_SECOND) + (int64_t)real.tv_nsec) - (int64_t)monotonic;
+ }
+
+ void logger_time_format(char *out, uint64_t time_ns, int64_t offset_ns, LoggerTimestampMode mode)
+ {
+     LoggerTimeCache *cache = &logger_time_cache;
+     int wall = (mode == LOGGER_TIMESTAMP_REALTIME) ? 1 : 0;
+     int64_t time = (int64_t)time_ns + ((wall != 0) ? offset_ns : 0);
+     uint32_t fraction;
+     char *p;
+
+     if (time < 0) {
+         time = 0;
+     }
+     fraction = (uint32_t)(time % LOGGER_NS_PER_SECOND);
+     time /= LOGGER_NS_PER_SECOND;
+
+     if ((cache->second != time) || (cache->wall != wall)) {
+         if (wall != 0) {
+             time_t seconds = (time_t)time;
+             struct tm tm;
+             cache->length = (gmtime_r(&seconds, &tm) != (struct tm *)0) ?
+                             strftime(cache->text, sizeof(cache->text), "%Y-%m-%dT%H:%M:%S", &tm) : 0u;
+         } else {
+             cache->length = (size_t)snprintf(cache->text, sizeof(cache->text), "%lld", (long long)time);
+         }
+         cache->second = time;
+         cache->wall = wall;
+     }
+
+     /* Prefix, '.', 9 digits and 'Z' fit in LOGGER_TIME_TEXT_SIZE for any 64-bit time. */
+     (void)memcpy(out, cache->text, cache->length);
+     p = &out[cache->length];
+     *p = '.';
+     for (uint32_t i = 9u; i > 0u; i--) {
+         p[i] = (char)('0' + (int)(fraction % 10u));
+         fraction /= 10u;
+     }
+     p = &p[10];
+     if (wall != 0) {
+         *p = 'Z';
+         p++;
+     }
+     *p = '\0';
+ }
+
+ static void logger_binary_put(FILE *file, const void *data, size_t length)
+ {
+     (void)fwrite(data, 1u, length, file);
+ }
+
+ void logger_binary_begin(FILE *file, int64_t offset_ns)
+ {
+     static const uint8_t header[5] = { 'L', 'O', 'G', 'B', LOGGER_BINARY_VERSION };
+     uint8_t tag = (uint8_t)'C';
+
+     (void)memset(logger_format_seen, 0, sizeof(logger_format_seen));
+     logger_binary_put(file, header, sizeof(header));
+     logger_binary_put(file, &tag, sizeof(tag));
+     logger_binary_put(file, &offset_ns, sizeof(offset_ns));
+ }
+
+ void logger_binary_write_text(FILE *file, LoggerLevel level, uint64_t time_ns,
+                               const char *timestamp, const char *message)
+ {
+     uint8_t head[2] = { (uint8_t)'T', (uint8_t)level };
+     uint16_t ts_length = (timestamp != (const char *)0) ? logger_format_length(timestamp, 0xFFFFu) : 0u;
+     uint16_t msg_length = logger_format_length(message, 0xFFFFu);
+
+     logger_binary_put(file, head, sizeof(head));
+     logger_binary_put(file, &time_ns, sizeof(time_ns));
+     logger_binary_put(file, &ts_length, sizeof(ts_length));
+     logger_binary_put(file, timestamp, ts_length);
+     logger_binary_put(file, &msg_length, sizeof(msg_length));
+     logger_binary_put(file, message, msg_length);
+ }
+
+ /* Returns 1 the first time a format is seen since logger_binary_begin(). */
+ static int logger_binary_first_use(const char *format)
+ {
+     uint32_t slot = (uint32_t)(((uintptr_t)format >> 3) * 2654435761u) % LOGGER_FORMAT_SEEN_SIZE;
+
+     for (uint32_t i = 0u; i < LOGGER_FORMAT_SEEN_PROBES; i++) {
+         const char **entry = &logger_format_seen[(slot + i) % LOGGER_FORMAT_SEEN_SIZE];
+         if (*entry == format) {
+             return 0;
+         }
+         if (*entry == (const char *)0) {
+             *entry = format;
+             return 1;
+         }
+     }
+     /* Table full around this slot: write the format again, the decoder accepts repeats. */
+     return 1;
+ }
+
+ void logger_binary_write_deferred(FILE *file, LoggerLevel level, uint64_t time_ns, const char *format,
+                                   const uint8_t *args, size_t args_size)
+ {
+     uint64_t id = (uint64_t)(uintptr_t)format;
+     uint16_t size = (uint16_t)args_size;
+
+     if (logger_binary_first_use(format) != 0) {
+         uint8_t tag = (uint8_t)'F';
+         uint16_t length = logger_format_length(format, 0xFFFFu);
+         logger_binary_put(file, &tag, sizeof(tag));
+         logger_binary_put(file, &id, sizeof(id));
+         logger_binary_put(file, &length, sizeof(length));
+         logger_binary_put(file, format, length);
+     }
+
+     uint8_t head[2] = { (uint8_t)'D', (uint8_t)level };
+     logger_binary_put(file, head, sizeof(head));
+     logger_binary_put(file, &time_ns, sizeof(time_ns));
+     logger_binary_put(file, &id, sizeof(id));
+     logger_binary_put(file, &size, sizeof(size));
+     logger_binary_put(file, args, args_size);
+ }
+
+ /**
+  * @brief Format string known to the decoder.
+  */
+ typedef struct {
+     uint64_t id;
+     char *text;
+ } LoggerDecodedFormat;
+
+ static int logger_decode_read(FILE *in, void *data, size_t length)
+ {
+     return (fread(data, 1u, length, in) == length) ? 0 : -1;
+ }
+
+ /* Reads a u16 length and that many bytes into a new terminated string. */
+ static char *logger_decode_string(FILE *in)
+ {
+     uint16_t length = 0u;
+     char *text;
+
+     if (logger_decode_read(in, &length, sizeof(length)) != 0) {
+         return (char *)0;
+     }
+     text = (char *)malloc((size_t)length + 1u);
+     if ((text != (char *)0) && (logger_decode_read(in, text, length) != 0)) {
+         free(text);
+         return (char *)0;
+     }
+     if (text != (char *)0) {
+         text[length] = '\0';
+     }
+     return text;
+ }
+
+ static void logger_decode_print(FILE *out, uint8_t level, uint64_t time_ns, int64_t offset_ns,
+                                 const char *timestamp, const char *message)
+ {
+     char stamp[LOGGER_TIME_TEXT_SIZE];
+
+     if (((timestamp == (const char *)0) || (timestamp[0] == '\0')) && (time_ns != 0u)) {
+         logger_time_format(stamp, time_ns, offset_ns, LOGGER_TIMESTAMP_REALTIME);
+         timestamp = stamp;
+     }
+     if ((timestamp != (const char *)0) && (timestamp[0] != '\0')) {
+         (void)fprintf(out, "[%s] [%s] %s\n", timestamp, logger_level_name((LoggerLevel)level), message);
+     } else {
+         (void)fprintf(out, "[%s] %s\n", logger_level_name((LoggerLevel)level), message);
+     }
+ }
+
+ long logger_decode_binary_file(void *input, void *output)
+ {
+     FILE *in = (FILE *)input;
+     FILE *out = (FILE *)output;
+     LoggerDecodedFormat *formats = (LoggerDecodedFormat *)0;
+     size_t format_count = 0u;
+     static uint8_t args[0xFFFFu];
+     char text[LOGGER_DECODE_SIZE];
+     uint8_t header[5];
+     long records = 0;
+     int64_t offset = 0;
+     int error = 0;
+     uint8_t tag;
+
+     if ((in == (FILE *)0) || (out == (FILE *)0) || (logger_decode_read(in, header, sizeof(header)) != 0) ||
+         (memcmp(header, "LOGB", 4u) != 0) || (header[4] != LOGGER_BINARY_VERSION)) {
+         return -1;
+     }
+
+     while ((error == 0) && (logger_decode_read(in, &tag, sizeof(tag)) == 0)) {
+         if (tag == (uint8_t)'C') {
+             if (logger_decode_read(in, &offset, sizeof(offset)) != 0) {
+                 break;
+             }
+         } else if (tag == (uint8_t)'F') {
+             uint64_t id = 0u;
+             char *format;
+             LoggerDecodedFormat *grown;
+             if ((logger_decode_read(in, &id, sizeof(id)) != 0) || ((format = logger_decode_string(in)) == (char *)0)) {
+                 break;
+             }
+             grown = (LoggerDecodedFormat *)realloc(formats, (format_count + 1u) * sizeof(*formats));
+             if (grown == (LoggerDecodedFormat *)0) {
+                 free(format);
+                 records = -1;
+                 break;
+             }
+             formats = grown;
+             formats[format_count].id = id;
+             formats[format_count].text = format;
+             format_count++;
+         } else if (tag == (uint8_t)'D') {
+             uint8_t level = 0u;
+             uint64_t time = 0u;
+             uint64_t id = 0u;
+             uint16_t size = 0u;
+             const char *format = (const char *)0;
+             if ((logger_decode_read(in, &level, sizeof(level)) != 0) || (logger_decode_read(in, &time, sizeof(time)) != 0) ||
+                 (logger_decode_read(in, &id, sizeof(id)) != 0) ||
+                 (logger_decode_read(in, &size, sizeof(size)) != 0) || (logger_decode_read(in, args, size) != 0)) {
+                 break;
+             }
+             /* Latest definition wins: an address may be reused by another run of the writer. */
+             for (size_t i = format_count; i > 0u; i--) {
+                 if (formats[i - 1u].id == id) {
+                     format = formats[i - 1u].text;
+                     break;
+                 }
+             }
+             if (format == (const char *)0) {
+                 (void)snprintf(text, sizeof(text), "<unknown format %llx>", (unsigned long long)id);
+             } else {
+                 (void)logger_format_render(text, sizeof(text), format, args, size);
+             }
+             logger_decode_print(out, level, time, offset, (const char *)0, text);
+             records++;
+         } else if (tag == (uint8_t)'T') {
+             uint8_t level = 0u;
+             uint64_t time = 0u;
+             char *timestamp = (char *)0;
+             char *message = (char *)0;
+             if ((logger_decode_read(in, &level, sizeof(level)) != 0) || (logger_decode_read(in, &time, sizeof(time)) != 0) ||
+                 ((timestamp = logger_decode_string(in)) == (char *)0) ||
+                 ((message = logger_decode_string(in)) == (char *)0)) {
+                 free(timestamp);
+                 break;
+             }
+             logger_decode_print(out, level, time, offset, timestamp, message);
+             free(timestamp);
+             free(message);
+             records++;
+         } else {
+             /* Not a record boundary: the rest cannot be trusted. */
+             error = 1;
+         }
+     }
+
+     for (size_t i = 0u; i < format_count; i++) {
+         free(formats[i].text);
+     }
+     free(formats);
+
+     return records;
+ }
@@ -0,0 +1,102 @@
+/**
+ *  \file loggerFormat.h
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 16 APR 2025
+ *
+ *  @brief Deferred formatting and binary log records (internal).
+ *
+ *  Arguments of a printf-style call are captured in order into a compact
+ *  blob: integers, characters and pointers as 8 bytes, floating point as a
+ *  double, strings as a 16-bit length and their bytes. The blob is turned
+ *  into text later, against the same format string.
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #ifndef LOGGER_FORMAT_H
+ #define LOGGER_FORMAT_H
+
+ #include <stdarg.h>
+ #include <stdio.h>
+ #include "logger.h"
+
+ /**
+  * @brief Name of a level ("DEBUG", "INFO", "WARN", "ERROR").
+  */
+ const char *logger_level_name(LoggerLevel level);
+
+ /**
+  * @brief Captures the arguments described by format into args.
+  *
+  * Capture stops at the first argument that does not fit or at an
+  * unsupported conversion; rendering prints '?' for the missing ones.
+  *
+  * @return Number of bytes used in args.
+  */
+ size_t logger_format_capture(uint8_t *args, size_t size, const char *format, va_list ap);
+
+ /**
+  * @brief Renders a format and its captured arguments as text.
+  *
+  * @return Length of the text, truncated to size - 1.
+  */
+ size_t logger_format_render(char *out, size_t size, const char *format, const uint8_t *args, size_t args_size);
+
+ /**
+  * @def LOGGER_TIME_TEXT_SIZE
+  * @brief Room for a timestamp written by logger_time_format(), terminator included.
+  */
+ #define LOGGER_TIME_TEXT_SIZE 32u
+
+ /**
+  * @brief CLOCK_MONOTONIC in nanoseconds, never 0.
+  */
+ uint64_t logger_time_now(void);
+
+ /**
+  * @brief CLOCK_REALTIME minus CLOCK_MONOTONIC, in nanoseconds.
+  */
+ int64_t logger_time_offset(void);
+
+ /**
+  * @brief Writes a logger_time_now() value as text.
+  *
+  * The text up to the second is cached per thread, so consecutive records
+  * only convert their fraction.
+  *
+  * @param out Buffer of LOGGER_TIME_TEXT_SIZE bytes.
+  * @param time_ns Monotonic time.
+  * @param offset_ns Offset to the wall clock, used with LOGGER_TIMESTAMP_REALTIME.
+  * @param mode LOGGER_TIMESTAMP_REALTIME for UTC, otherwise seconds since boot.
+  */
+ void logger_time_format(char *out, uint64_t time_ns, int64_t offset_ns, LoggerTimestampMode mode);
+
+ /**
+  * @brief Writes the file header and the clock offset, and forgets the
+  *        formats already written.
+  */
+ void logger_binary_begin(FILE *file, int64_t offset_ns);
+
+ /**
+  * @brief Writes a text record.
+  *
+  * @param time_ns Logger timestamp, 0 if none.
+  */
+ void logger_binary_write_text(FILE *file, LoggerLevel level, uint64_t time_ns,
+                               const char *timestamp, const char *message);
+
+ /**
+  * @brief Writes a deferred record, preceded by its format string the first
+  *        time the format is seen.
+  *
+  * @param time_ns Logger timestamp, 0 if none.
+  */
+ void logger_binary_write_deferred(FILE *file, LoggerLevel level, uint64_t time_ns, const char *format,
+                                   const uint8_t *args, size_t args_size);
+
+ #endif /* LOGGER_FORMAT_H */
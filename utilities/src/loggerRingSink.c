@@ -0,0 +1,410 @@
+/**
+ *  \file loggerRingSink.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 16 APR 2025
+ *
+ *  @brief Crash-safe log ring in a memory-mapped file.
+ *
+ *  The file is a header page followed by a data area used as a ring of
+ *  8-byte aligned records. A writer reserves its bytes with a CAS on the
+ *  head, clears the marker, copies header and text, and stores the marker
+ *  last. The sequence number of a record is its position in the byte stream
+ *  reserved since the ring was created, taken by the same CAS, so sequence
+ *  and offset orders agree. The marker mixes the sequence number, the
+ *  length and a checksum of the level and text, so a record torn by a
+ *  crash, an old one partly overwritten, or one whose bytes were mixed with
+ *  those of a writer that lapped it, never validates. A writer lapped during
+ *  its copy also leaves its marker at 0. Records never straddle the end of
+ *  the ring.
+ *
+ *  Records live in the page cache as soon as they are copied: they survive
+ *  a crash of the process, and reach the disk on msync() or writeback.
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include "logger.h"
+ #include "loggerFormat.h"
+ #include <fcntl.h>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+
+ #define LOGGER_RING_MAGIC "LOGRING"
+ #define LOGGER_RING_VERSION 3u
+ #define LOGGER_RING_HEADER_SIZE 4096u
+ #define LOGGER_RING_ALIGN 8u
+
+ /**
+  * @brief File header, at offset 0.
+  */
+ typedef struct {
+     char magic[8];
+     uint32_t version;
+     uint32_t header_size;
+     uint64_t capacity;                  /* Data area size in bytes. */
+ } LoggerRingFileHeader;
+
+ /**
+  * @brief Record header, followed by the timestamp and message bytes.
+  */
+ typedef struct {
+     uint32_t marker;                    /* Written last, see logger_ring_marker(), 0 = invalid. */
+     uint32_t length;                    /* Whole record, padded to LOGGER_RING_ALIGN. */
+     uint64_t sequence;                  /* Stream position of the record, sequence % capacity = offset. */
+     uint8_t level;
+     uint8_t reserved;
+     uint16_t timestamp_length;
+     uint16_t message_length;
+     uint16_t reserved2;
+ } LoggerRingRecord;
+
+ /**
+  * @brief Valid record found by a scan.
+  */
+ typedef struct {
+     uint64_t sequence;
+     uint64_t offset;
+ } LoggerRingEntry;
+
+ static pthread_mutex_t logger_ring_mutex = PTHREAD_MUTEX_INITIALIZER;
+ static uint8_t *logger_ring_map = (uint8_t *)0;
+ static uint64_t logger_ring_capacity = 0u;
+ static size_t logger_ring_map_size = 0u;
+ static uint64_t logger_ring_head = 0u;              /* Bytes reserved in the stream, position = head % capacity. */
+ static uint32_t logger_ring_writers = 0u;           /* Writers using the mapping, drained by close. */
+
+ /* FNV-1a over the text, seeded with the level and the field lengths. */
+ static uint64_t logger_ring_checksum(uint8_t level, const char *timestamp, size_t timestamp_length,
+                                      const char *message, size_t message_length)
+ {
+     uint64_t hash = 0xCBF29CE484222325ull ^ (uint64_t)level ^ ((uint64_t)timestamp_length << 8) ^
+                     ((uint64_t)message_length << 24);
+
+     for (size_t i = 0u; i < timestamp_length; i++) {
+         hash = (hash ^ (uint8_t)timestamp[i]) * 0x100000001B3ull;
+     }
+     for (size_t i = 0u; i < message_length; i++) {
+         hash = (hash ^ (uint8_t)message[i]) * 0x100000001B3ull;
+     }
+     return hash;
+ }
+
+ static uint32_t logger_ring_marker(uint64_t sequence, uint32_t length, uint64_t checksum)
+ {
+     uint64_t mix = (sequence ^ ((uint64_t)length << 40) ^ checksum) * 0x9E3779B97F4A7C15ull;
+
+     /* Never 0, the value of a marker being written. */
+     return (uint32_t)(mix >> 32) | 1u;
+ }
+
+ /* Returns the length of the valid record at offset, 0 if there is none. */
+ static uint32_t logger_ring_valid(const uint8_t *data, uint64_t capacity, uint64_t offset)
+ {
+     const LoggerRingRecord *record = (const LoggerRingRecord *)(const void *)&data[offset];
+
+     if ((capacity - offset) < sizeof(LoggerRingRecord)) {
+         return 0u;
+     }
+     uint32_t marker = __atomic_load_n(&record->marker, __ATOMIC_ACQUIRE);
+     uint32_t length = record->length;
+     if ((marker == 0u) || (length < sizeof(LoggerRingRecord)) || ((length % LOGGER_RING_ALIGN) != 0u) ||
+         (length > (capacity - offset)) ||
+         ((sizeof(LoggerRingRecord) + record->timestamp_length + record->message_length) > length)) {
+         return 0u;
+     }
+     const char *text = (const char *)&record[1];
+     uint64_t checksum = logger_ring_checksum(record->level, text, record->timestamp_length,
+                                              &text[record->timestamp_length], record->message_length);
+     return (marker == logger_ring_marker(record->sequence, length, checksum)) ? length : 0u;
+ }
+
+ static int logger_ring_compare(const void *a, const void *b)
+ {
+     uint64_t x = ((const LoggerRingEntry *)a)->sequence;
+     uint64_t y = ((const LoggerRingEntry *)b)->sequence;
+
+     return (x > y) - (x < y);
+ }
+
+ /* Lists the valid records of a data area in sequence order. */
+ static LoggerRingEntry *logger_ring_scan(const uint8_t *data, uint64_t capacity, size_t *count)
+ {
+     LoggerRingEntry *entries = (LoggerRingEntry *)malloc((size_t)(capacity / sizeof(LoggerRingRecord) + 1u) * sizeof(*entries));
+     uint64_t offset = 0u;
+
+     *count = 0u;
+     if (entries == (LoggerRingEntry *)0) {
+         return entries;
+     }
+
+     while (offset < capacity) {
+         uint32_t length = logger_ring_valid(data, capacity, offset);
+         if (length == 0u) {
+             offset += LOGGER_RING_ALIGN;
+             continue;
+         }
+         entries[*count].sequence = ((const LoggerRingRecord *)(const void *)&data[offset])->sequence;
+         entries[*count].offset = offset;
+         (*count)++;
+         offset += length;
+     }
+     qsort(entries, *count, sizeof(*entries), logger_ring_compare);
+
+     return entries;
+ }
+
+ static int logger_ring_header_valid(const LoggerRingFileHeader *header, uint64_t file_size)
+ {
+     return ((memcmp(header->magic, LOGGER_RING_MAGIC, sizeof(header->magic)) == 0) &&
+             (header->version == LOGGER_RING_VERSION) && (header->header_size == LOGGER_RING_HEADER_SIZE) &&
+             (header->capacity != 0u) && ((header->capacity % LOGGER_RING_ALIGN) == 0u) &&
+             (header->capacity <= (file_size - LOGGER_RING_HEADER_SIZE))) ? 1 : 0;
+ }
+
+ int logger_ring_sink_open(const char *path, size_t size)
+ {
+     long page = sysconf(_SC_PAGESIZE);
+     struct stat st;
+     uint64_t capacity;
+     size_t map_size;
+     uint8_t *map;
+     int fd;
+
+     if ((path == (const char *)0) || (size < (2u * LOGGER_RING_HEADER_SIZE)) || (page <= 0)) {
+         return -1;
+     }
+     capacity = (((uint64_t)size + (uint64_t)page - 1u) / (uint64_t)page) * (uint64_t)page;
+     map_size = (size_t)(LOGGER_RING_HEADER_SIZE + capacity);
+
+     (void)pthread_mutex_lock(&logger_ring_mutex);
+     if (logger_ring_map != (uint8_t *)0) {
+         (void)pthread_mutex_unlock(&logger_ring_mutex);
+         return -1;
+     }
+
+     fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+     if ((fd < 0) || (fstat(fd, &st) != 0)) {
+         if (fd >= 0) {
+             (void)close(fd);
+         }
+         (void)pthread_mutex_unlock(&logger_ring_mutex);
+         return -1;
+     }
+
+     /* An existing ring of the same size is continued, anything else is replaced. */
+     int reuse = 0;
+     if ((uint64_t)st.st_size == (uint64_t)map_size) {
+         LoggerRingFileHeader header;
+         reuse = ((pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header)) &&
+                  (logger_ring_header_valid(&header, (uint64_t)st.st_size) != 0) && (header.capacity == capacity)) ? 1 : 0;
+     }
+     if ((reuse == 0) && ((ftruncate(fd, 0) != 0) || (posix_fallocate(fd, 0, (off_t)map_size) != 0))) {
+         (void)close(fd);
+         (void)pthread_mutex_unlock(&logger_ring_mutex);
+         return -1;
+     }
+
+     map = (uint8_t *)mmap((void *)0, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+     (void)close(fd);
+     if (map == (uint8_t *)MAP_FAILED) {
+         (void)pthread_mutex_unlock(&logger_ring_mutex);
+         return -1;
+     }
+
+     logger_ring_head = 0u;
+     if (reuse != 0) {
+         size_t count = 0u;
+         LoggerRingEntry *entries = logger_ring_scan(&map[LOGGER_RING_HEADER_SIZE], capacity, &count);
+         if (count != 0u) {
+             /* The newest record is also the furthest in the stream: continue right after it. */
+             const LoggerRingEntry *last = &entries[count - 1u];
+             const LoggerRingRecord *record = (const LoggerRingRecord *)(const void *)&map[LOGGER_RING_HEADER_SIZE + last->offset];
+             logger_ring_head = last->sequence + record->length;
+         }
+         free(entries);
+     } else {
+         LoggerRingFileHeader *header = (LoggerRingFileHeader *)(void *)map;
+         (void)memcpy(header->magic, LOGGER_RING_MAGIC, sizeof(header->magic));
+         header->version = LOGGER_RING_VERSION;
+         header->header_size = LOGGER_RING_HEADER_SIZE;
+         header->capacity = capacity;
+     }
+
+     logger_ring_capacity = capacity;
+     logger_ring_map_size = map_size;
+     __atomic_store_n(&logger_ring_map, map, __ATOMIC_RELEASE);
+     (void)pthread_mutex_unlock(&logger_ring_mutex);
+
+     return 0;
+ }
+
+ /* Reserves length bytes that do not straddle the end, returns their offset and stream position. */
+ static uint64_t logger_ring_reserve(uint32_t length, uint64_t *sequence)
+ {
+     uint64_t head = __atomic_load_n(&logger_ring_head, __ATOMIC_RELAXED);
+     uint64_t offset;
+     uint64_t next;
+
+     do {
+         offset = head % logger_ring_capacity;
+         if ((logger_ring_capacity - offset) < length) {
+             /* The end of the ring is left as it is; scans step over it. */
+             next = head + (logger_ring_capacity - offset) + length;
+             offset = 0u;
+         } else {
+             next = head + length;
+         }
+     } while (!__atomic_compare_exchange_n(&logger_ring_head, &head, next, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+     *sequence = next - length;
+     return offset;
+ }
+
+ void logger_ring_sink_output(LoggerLevel level, const char *timestamp, const char *message)
+ {
+     uint8_t *map;
+
+     if ((level >= LOGGER_LEVEL_MAX) || (message == (const char *)0)) {
+         return;
+     }
+
+     /* Announce the writer before looking at the mapping: close unmaps only when none is left. */
+     (void)__atomic_add_fetch(&logger_ring_writers, 1u, __ATOMIC_SEQ_CST);
+     map = __atomic_load_n(&logger_ring_map, __ATOMIC_SEQ_CST);
+     if (map == (uint8_t *)0) {
+         (void)__atomic_sub_fetch(&logger_ring_writers, 1u, __ATOMIC_RELEASE);
+         return;
+     }
+
+     /* A record takes at most a quarter of the ring; a writer can still be lapped, checked after the copy. */
+     size_t room = (size_t)(logger_ring_capacity / 4u) - sizeof(LoggerRingRecord);
+     size_t timestamp_length = (timestamp != (const char *)0) ? strlen(timestamp) : 0u;
+     size_t message_length = strlen(message);
+     if (timestamp_length > 0xFFFFu) {
+         timestamp_length = 0xFFFFu;
+     }
+     if (message_length > 0xFFFFu) {
+         message_length = 0xFFFFu;
+     }
+     if ((timestamp_length + message_length) > room) {
+         timestamp_length = (timestamp_length < room) ? timestamp_length : room;
+         message_length = room - timestamp_length;
+     }
+
+     uint32_t length = (uint32_t)((sizeof(LoggerRingRecord) + timestamp_length + message_length + (LOGGER_RING_ALIGN - 1u)) &
+                                  ~((size_t)LOGGER_RING_ALIGN - 1u));
+     uint64_t sequence;
+     uint64_t offset = logger_ring_reserve(length, &sequence);
+     LoggerRingRecord *record = (LoggerRingRecord *)(void *)&map[LOGGER_RING_HEADER_SIZE + offset];
+     char *text = (char *)&record[1];
+
+     __atomic_store_n(&record->marker, 0u, __ATOMIC_RELAXED);
+     __atomic_thread_fence(__ATOMIC_RELEASE);
+     record->length = length;
+     record->sequence = sequence;
+     record->level = (uint8_t)level;
+     record->reserved = 0u;
+     record->timestamp_length = (uint16_t)timestamp_length;
+     record->message_length = (uint16_t)message_length;
+     record->reserved2 = 0u;
+     (void)memcpy(text, timestamp, timestamp_length);
+     (void)memcpy(&text[timestamp_length], message, message_length);
+
+     /* Once the head is a whole ring past this record, newer writers may have copied into its bytes. */
+     __atomic_thread_fence(__ATOMIC_SEQ_CST);
+     if ((__atomic_load_n(&logger_ring_head, __ATOMIC_RELAXED) - sequence) <= logger_ring_capacity) {
+         uint64_t checksum = logger_ring_checksum((uint8_t)level, timestamp, timestamp_length, message, message_length);
+         __atomic_store_n(&record->marker, logger_ring_marker(sequence, length, checksum), __ATOMIC_RELEASE);
+     }
+     (void)__atomic_sub_fetch(&logger_ring_writers, 1u, __ATOMIC_RELEASE);
+ }
+
+ int logger_ring_sink_sync(void)
+ {
+     int result = -1;
+
+     (void)pthread_mutex_lock(&logger_ring_mutex);
+     if (logger_ring_map != (uint8_t *)0) {
+         result = msync(logger_ring_map, logger_ring_map_size, MS_SYNC);
+     }
+     (void)pthread_mutex_unlock(&logger_ring_mutex);
+
+     return result;
+ }
+
+ void logger_ring_sink_close(void)
+ {
+     (void)pthread_mutex_lock(&logger_ring_mutex);
+     if (logger_ring_map != (uint8_t *)0) {
+         uint8_t *map = logger_ring_map;
+         __atomic_store_n(&logger_ring_map, (uint8_t *)0, __ATOMIC_SEQ_CST);
+         /* New writers now see no mapping; the ones already in finish their copy. */
+         while (__atomic_load_n(&logger_ring_writers, __ATOMIC_SEQ_CST) != 0u) {
+             (void)sched_yield();
+         }
+         (void)munmap(map, logger_ring_map_size);
+     }
+     (void)pthread_mutex_unlock(&logger_ring_mutex);
+ }
+
+ long logger_ring_sink_read(const char *path, void *output)
+ {
+     FILE *out = (FILE *)output;
+     LoggerRingFileHeader header;
+     LoggerRingEntry *entries;
+     struct stat st;
+     size_t count = 0u;
+     long records;
+     uint8_t *map;
+     int fd;
+
+     if ((path == (const char *)0) || (out == (FILE *)0)) {
+         return -1;
+     }
+     fd = open(path, O_RDONLY | O_CLOEXEC);
+     if (fd < 0) {
+         return -1;
+     }
+     if ((fstat(fd, &st) != 0) || ((uint64_t)st.st_size < (uint64_t)LOGGER_RING_HEADER_SIZE) ||
+         (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) ||
+         (logger_ring_header_valid(&header, (uint64_t)st.st_size) == 0)) {
+         (void)close(fd);
+         return -1;
+     }
+
+     map = (uint8_t *)mmap((void *)0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+     (void)close(fd);
+     if (map == (uint8_t *)MAP_FAILED) {
+         return -1;
+     }
+
+     const uint8_t *data = &map[LOGGER_RING_HEADER_SIZE];
+     entries = logger_ring_scan(data, header.capacity, &count);
+     for (size_t i = 0u; i < count; i++) {
+         const LoggerRingRecord *record = (const LoggerRingRecord *)(const void *)&data[entries[i].offset];
+         const char *text = (const char *)&record[1];
+         const char *name = logger_level_name((LoggerLevel)record->level);
+
+         if (record->timestamp_length != 0u) {
+             (void)fprintf(out, "[%.*s] [%s] %.*s\n", (int)record->timestamp_length, text, name,
+                           (int)record->message_length, &text[record->timestamp_length]);
+         } else {
+             (void)fprintf(out, "[%s] %.*s\n", name, (int)record->message_length, text);
+         }
+     }
+     records = (entries != (LoggerRingEntry *)0) ? (long)count : -1;
+     free(entries);
+     (void)munmap(map, (size_t)st.st_size);
+
+     return records;
+ }
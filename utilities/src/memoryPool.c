@@ -0,0 +1,101 @@
+/**
+ *  \file memoryPool.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 15 APR 2025
+ *
+ *  @brief Lock-free pool of fixed size blocks.
+ *
+ *  Free blocks form a Treiber stack. The links live in an array next to
+ *  the blocks rather than in the blocks themselves, so a thread reading a
+ *  link never races with the owner of a block it lost the CAS for, and the
+ *  head carries a tag bumped on every change to defeat ABA.
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdlib.h>
+ #include "memoryPool.h"
+
+ size_t memoryPool_storageSize(uint32_t count, size_t blockSize)
+ {
+     return MEMORYPOOL_STORAGE_SIZE(count, blockSize);
+ }
+
+ int memoryPool_init(memoryPool_t *pool, void *storage, uint32_t count, size_t blockSize)
+ {
+     if ((pool == (memoryPool_t *)0) || (count == 0u) || (blockSize == 0u)) {
+         return -1;
+     }
+
+     pool->owned = 0u;
+     if (storage == (void *)0) {
+         if (posix_memalign(&storage, MEMORYPOOL_ALIGN, memoryPool_storageSize(count, blockSize)) != 0) {
+             return -1;
+         }
+         pool->owned = 1u;
+     }
+
+     pool->blockSize = MEMORYPOOL_BLOCK_SIZE(blockSize);
+     pool->count = count;
+     pool->blocks = (uint8_t *)storage;
+     pool->nextFree = (uint32_t *)(void *)&pool->blocks[(size_t)count * pool->blockSize];
+     for (uint32_t i = 0; i < count; i++) {
+         pool->nextFree[i] = ((i + 1u) < count) ? (i + 2u) : 0u;
+     }
+     __atomic_store_n(&pool->freeHead, 1u, __ATOMIC_RELEASE);
+
+     return 0;
+ }
+
+ void memoryPool_destroy(memoryPool_t *pool)
+ {
+     if ((pool != (memoryPool_t *)0) && (pool->owned != 0u)) {
+         free(pool->blocks);
+         pool->blocks = (uint8_t *)0;
+         pool->owned = 0u;
+     }
+ }
+
+ void *memoryPool_acquire(memoryPool_t *pool)
+ {
+     uint64_t head = __atomic_load_n(&pool->freeHead, __ATOMIC_ACQUIRE);
+
+     for (;;) {
+         uint32_t index = (uint32_t)head;
+         if (index == 0u) {
+             return (void *)0;
+         }
+         uint32_t next = __atomic_load_n(&pool->nextFree[index - 1u], __ATOMIC_RELAXED);
+         uint64_t newHead = (((head >> 32) + 1u) << 32) | next;
+         if (__atomic_compare_exchange_n(&pool->freeHead, &head, newHead, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+             return &pool->blocks[(size_t)(index - 1u) * pool->blockSize];
+         }
+     }
+ }
+
+ void memoryPool_release(memoryPool_t *pool, void *block)
+ {
+     if (block == (void *)0) {
+         return;
+     }
+
+     uint32_t index = (uint32_t)(((uint8_t *)block - pool->blocks) / pool->blockSize) + 1u;
+     uint64_t head = __atomic_load_n(&pool->freeHead, __ATOMIC_RELAXED);
+     do {
+         __atomic_store_n(&pool->nextFree[index - 1u], (uint32_t)head, __ATOMIC_RELAXED);
+     } while (!__atomic_compare_exchange_n(&pool->freeHead, &head, (((head >> 32) + 1u) << 32) | index, 1,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+ }
+
+ uint8_t memoryPool_owns(const memoryPool_t *pool, const void *block)
+ {
+     const uint8_t *ptr = (const uint8_t *)block;
+
+     return ((pool->blocks != (uint8_t *)0) && (ptr >= pool->blocks) &&
+             (ptr < &pool->blocks[(size_t)pool->count * pool->blockSize])) ? 1u : 0u;
+ }
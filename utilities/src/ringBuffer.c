@@ -0,0 +1,420 @@
+/**
+ *  \file ringBuffer.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 14 APR 2025
+ *
+ *  @brief Bounded lock-free ring buffers (SPSC and MPMC) of fixed size items.
+ *
+ *  The SPSC ring keeps each side's index on its own cache line and caches
+ *  the other side's index, so the shared line is only read when the cached
+ *  value says full or empty. The MPMC ring is the classic per-slot sequence
+ *  design: a slot is free for position p when its sequence equals p and
+ *  holds an item for position p when it equals p + 1.
+ *
+ *  Indexes are free running 32 bit counters, differences are taken modulo
+ *  2^32, which is why the capacity is limited to 2^31.
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdlib.h>
+ #include <string.h>
+ #include "ringBuffer.h"
+
+ #define RINGBUFFER_MAX_CAPACITY (1UL << 31)
+
+ static int ringBuffer_validCapacity(uint32_t capacity, uint32_t minCapacity)
+ {
+     return ((capacity >= minCapacity) && (capacity <= RINGBUFFER_MAX_CAPACITY) &&
+             ((capacity & (capacity - 1u)) == 0u)) ? 1 : 0;
+ }
+
+ /* Copy count items into the ring starting at index, wrapping around the end. */
+ static void ringBuffer_copyIn(uint8_t *data, uint32_t mask, uint32_t itemSize,
+                               uint32_t index, const uint8_t *items, uint32_t count)
+ {
+     uint32_t first = index & mask;
+     uint32_t chunk = mask + 1u - first;
+
+     if (chunk > count) {
+         chunk = count;
+     }
+     (void)memcpy(&data[(size_t)first * itemSize], items, (size_t)chunk * itemSize);
+     if (chunk < count) {
+         (void)memcpy(data, &items[(size_t)chunk * itemSize], (size_t)(count - chunk) * itemSize);
+     }
+ }
+
+ /* Copy count items out of the ring starting at index, wrapping around the end. */
+ static void ringBuffer_copyOut(const uint8_t *data, uint32_t mask, uint32_t itemSize,
+                                uint32_t index, uint8_t *items, uint32_t count)
+ {
+     uint32_t first = index & mask;
+     uint32_t chunk = mask + 1u - first;
+
+     if (chunk > count) {
+         chunk = count;
+     }
+     (void)memcpy(items, &data[(size_t)first * itemSize], (size_t)chunk * itemSize);
+     if (chunk < count) {
+         (void)memcpy(&items[(size_t)chunk * itemSize], data, (size_t)(count - chunk) * itemSize);
+     }
+ }
+
+ /* ------------------------------------------------------------------------ */
+ /* SPSC                                                                     */
+ /* ------------------------------------------------------------------------ */
+
+ size_t ringBufferSpsc_storageSize(uint32_t capacity, uint32_t itemSize)
+ {
+     return (size_t)capacity * itemSize;
+ }
+
+ int ringBufferSpsc_init(ringBufferSpsc_t *ring, void *storage, uint32_t capacity, uint32_t itemSize)
+ {
+     if ((ring == (ringBufferSpsc_t *)0) || (itemSize == 0u) || (ringBuffer_validCapacity(capacity, 1u) == 0)) {
+         return -1;
+     }
+
+     (void)memset(ring, 0, sizeof(*ring));
+
+     if (storage == (void *)0) {
+         storage = malloc(ringBufferSpsc_storageSize(capacity, itemSize));
+         if (storage == (void *)0) {
+             return -1;
+         }
+         ring->config.owned = 1u;
+     }
+
+     ring->config.data = (uint8_t *)storage;
+     ring->config.mask = capacity - 1u;
+     ring->config.itemSize = itemSize;
+     return 0;
+ }
+
+ void ringBufferSpsc_destroy(ringBufferSpsc_t *ring)
+ {
+     if (ring == (ringBufferSpsc_t *)0) {
+         return;
+     }
+
+     if (ring->config.owned != 0u) {
+         free(ring->config.data);
+     }
+     (void)memset(ring, 0, sizeof(*ring));
+ }
+
+ void ringBufferSpsc_setNotify(ringBufferSpsc_t *ring, ringBufferNotify_t notify, void *arg)
+ {
+     ring->config.notify = notify;
+     ring->config.notifyArg = arg;
+ }
+
+ /* Free slots seen by the producer, refreshing the cached consumer index only when needed. */
+ static uint32_t ringBufferSpsc_space(ringBufferSpsc_t *ring, uint32_t tail, uint32_t wanted)
+ {
+     uint32_t capacity = ring->config.mask + 1u;
+     uint32_t space = capacity - (tail - ring->producer.headCache);
+
+     if (space < wanted) {
+         ring->producer.headCache = __atomic_load_n(&ring->consumer.head, __ATOMIC_ACQUIRE);
+         space = capacity - (tail - ring->producer.headCache);
+     }
+     return space;
+ }
+
+ /* Items seen by the consumer, refreshing the cached producer index only when needed. */
+ static uint32_t ringBufferSpsc_available(ringBufferSpsc_t *ring, uint32_t head, uint32_t wanted)
+ {
+     uint32_t available = ring->consumer.tailCache - head;
+
+     if (available < wanted) {
+         ring->consumer.tailCache = __atomic_load_n(&ring->producer.tail, __ATOMIC_ACQUIRE);
+         available = ring->consumer.tailCache - head;
+
+         if ((available == 0u) && (ring->config.notify != (ringBufferNotify_t)0)) {
+             /* Pairs with the fence in ringBufferSpsc_published(): either the
+              * producer sees this consumer caught up and notifies, or this
+              * reload sees its item. */
+             __atomic_thread_fence(__ATOMIC_SEQ_CST);
+             ring->consumer.tailCache = __atomic_load_n(&ring->producer.tail, __ATOMIC_ACQUIRE);
+             available = ring->consumer.tailCache - head;
+         }
+     }
+     return available;
+ }
+
+ /* Call the notify hook if the consumer had drained everything before tail. */
+ static void ringBufferSpsc_published(ringBufferSpsc_t *ring, uint32_t tail)
+ {
+     if (ring->config.notify == (ringBufferNotify_t)0) {
+         return;
+     }
+
+     __atomic_thread_fence(__ATOMIC_SEQ_CST);
+     if (__atomic_load_n(&ring->consumer.head, __ATOMIC_RELAXED) == tail) {
+         ring->config.notify(ring->config.notifyArg);
+     }
+ }
+
+ int ringBufferSpsc_push(ringBufferSpsc_t *ring, const void *item)
+ {
+     uint32_t tail = ring->producer.tail;
+
+     if (ringBufferSpsc_space(ring, tail, 1u) == 0u) {
+         return -1;
+     }
+
+     ringBuffer_copyIn(ring->config.data, ring->config.mask, ring->config.itemSize, tail, (const uint8_t *)item, 1u);
+     __atomic_store_n(&ring->producer.tail, tail + 1u, __ATOMIC_RELEASE);
+     ringBufferSpsc_published(ring, tail);
+     return 0;
+ }
+
+ int ringBufferSpsc_pop(ringBufferSpsc_t *ring, void *item)
+ {
+     uint32_t head = ring->consumer.head;
+
+     if (ringBufferSpsc_available(ring, head, 1u) == 0u) {
+         return -1;
+     }
+
+     ringBuffer_copyOut(ring->config.data, ring->config.mask, ring->config.itemSize, head, (uint8_t *)item, 1u);
+     __atomic_store_n(&ring->consumer.head, head + 1u, __ATOMIC_RELEASE);
+     return 0;
+ }
+
+ uint32_t ringBufferSpsc_pushBatch(ringBufferSpsc_t *ring, const void *items, uint32_t count)
+ {
+     uint32_t tail = ring->producer.tail;
+     uint32_t space = ringBufferSpsc_space(ring, tail, count);
+
+     if (count > space) {
+         count = space;
+     }
+     if (count == 0u) {
+         return 0;
+     }
+
+     ringBuffer_copyIn(ring->config.data, ring->config.mask, ring->config.itemSize, tail, (const uint8_t *)items, count);
+     __atomic_store_n(&ring->producer.tail, tail + count, __ATOMIC_RELEASE);
+     ringBufferSpsc_published(ring, tail);
+     return count;
+ }
+
+ uint32_t ringBufferSpsc_popBatch(ringBufferSpsc_t *ring, void *items, uint32_t count)
+ {
+     uint32_t head = ring->consumer.head;
+     uint32_t available = ringBufferSpsc_available(ring, head, count);
+
+     if (count > available) {
+         count = available;
+     }
+     if (count == 0u) {
+         return 0;
+     }
+
+     ringBuffer_copyOut(ring->config.data, ring->config.mask, ring->config.itemSize, head, (uint8_t *)items, count);
+     __atomic_store_n(&ring->consumer.head, head + count, __ATOMIC_RELEASE);
+     return count;
+ }
+
+ uint32_t ringBufferSpsc_count(const ringBufferSpsc_t *ring)
+ {
+     uint32_t head = __atomic_load_n(&ring->consumer.head, __ATOMIC_ACQUIRE);
+     uint32_t tail = __atomic_load_n(&ring->producer.tail, __ATOMIC_ACQUIRE);
+     return tail - head;
+ }
+
+ /* ------------------------------------------------------------------------ */
+ /* MPMC                                                                     */
+ /* ------------------------------------------------------------------------ */
+
+ /* Offset of the item area, after the sequence array. */
+ static size_t ringBufferMpmc_dataOffset(uint32_t capacity)
+ {
+     size_t offset = (size_t)capacity * sizeof(uint32_t);
+     return (offset + (sizeof(uint64_t) - 1u)) & ~(sizeof(uint64_t) - 1u);
+ }
+
+ size_t ringBufferMpmc_storageSize(uint32_t capacity, uint32_t itemSize)
+ {
+     return ringBufferMpmc_dataOffset(capacity) + ((size_t)capacity * itemSize);
+ }
+
+ int ringBufferMpmc_init(ringBufferMpmc_t *ring, void *storage, uint32_t capacity, uint32_t itemSize)
+ {
+     if ((ring == (ringBufferMpmc_t *)0) || (itemSize == 0u) || (ringBuffer_validCapacity(capacity, 2u) == 0)) {
+         return -1;
+     }
+
+     (void)memset(ring, 0, sizeof(*ring));
+
+     if (storage == (void *)0) {
+         storage = malloc(ringBufferMpmc_storageSize(capacity, itemSize));
+         if (storage == (void *)0) {
+             return -1;
+         }
+         ring->config.owned = 1u;
+     }
+
+     ring->config.sequence = (uint32_t *)storage;
+     ring->config.data = &((uint8_t *)storage)[ringBufferMpmc_dataOffset(capacity)];
+     ring->config.mask = capacity - 1u;
+     ring->config.itemSize = itemSize;
+
+     for (uint32_t i = 0u; i < capacity; i++) {
+         ring->config.sequence[i] = i;
+     }
+     return 0;
+ }
+
+ void ringBufferMpmc_destroy(ringBufferMpmc_t *ring)
+ {
+     if (ring == (ringBufferMpmc_t *)0) {
+         return;
+     }
+
+     if (ring->config.owned != 0u) {
+         free(ring->config.sequence);
+     }
+     (void)memset(ring, 0, sizeof(*ring));
+ }
+
+ void ringBufferMpmc_setNotify(ringBufferMpmc_t *ring, ringBufferNotify_t notify, void *arg)
+ {
+     ring->config.notify = notify;
+     ring->config.notifyArg = arg;
+ }
+
+ /* Number of consecutive slots from pos whose sequence is pos + i + ready, at most count. */
+ static uint32_t ringBufferMpmc_scan(const ringBufferMpmc_t *ring, uint32_t pos, uint32_t ready, uint32_t count)
+ {
+     uint32_t n = 0u;
+
+     while (n < count) {
+         uint32_t seq = __atomic_load_n(&ring->config.sequence[(pos + n) & ring->config.mask], __ATOMIC_ACQUIRE);
+         if (seq != (pos + n + ready)) {
+             break;
+         }
+         n++;
+     }
+     return n;
+ }
+
+ /* Claim up to count slots on the given index; returns the number claimed and their first position. */
+ static uint32_t ringBufferMpmc_claim(ringBufferMpmc_t *ring, uint32_t *index, uint32_t ready,
+                                      uint32_t count, uint32_t *pos)
+ {
+     uint32_t current = __atomic_load_n(index, __ATOMIC_RELAXED);
+
+     for (;;) {
+         uint32_t n = ringBufferMpmc_scan(ring, current, ready, count);
+
+         if (n == 0u) {
+             /* Either the ring is full/empty or another thread moved the index. */
+             uint32_t seq = __atomic_load_n(&ring->config.sequence[current & ring->config.mask], __ATOMIC_ACQUIRE);
+             int32_t diff = (int32_t)(seq - (current + ready));
+             if (diff < 0) {
+                 return 0;
+             }
+             current = __atomic_load_n(index, __ATOMIC_RELAXED);
+             continue;
+         }
+
+         if (__atomic_compare_exchange_n(index, &current, current + n, 1,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+             *pos = current;
+             return n;
+         }
+     }
+ }
+
+ static uint32_t ringBufferMpmc_pushItems(ringBufferMpmc_t *ring, const uint8_t *items, uint32_t count)
+ {
+     uint32_t pos = 0u;
+     uint32_t n;
+
+     if (count == 0u) {
+         return 0;
+     }
+
+     n = ringBufferMpmc_claim(ring, &ring->enqueuePos, 0u, count, &pos);
+     if (n == 0u) {
+         return 0;
+     }
+
+     ringBuffer_copyIn(ring->config.data, ring->config.mask, ring->config.itemSize, pos, items, n);
+     for (uint32_t i = 0u; i < n; i++) {
+         __atomic_store_n(&ring->config.sequence[(pos + i) & ring->config.mask], pos + i + 1u, __ATOMIC_RELEASE);
+     }
+
+     if (ring->config.notify != (ringBufferNotify_t)0) {
+         /* A consumer waiting exactly on our first slot found the ring empty. */
+         __atomic_thread_fence(__ATOMIC_SEQ_CST);
+         if (__atomic_load_n(&ring->dequeuePos, __ATOMIC_RELAXED) == pos) {
+             ring->config.notify(ring->config.notifyArg);
+         }
+     }
+     return n;
+ }
+
+ static uint32_t ringBufferMpmc_popItems(ringBufferMpmc_t *ring, uint8_t *items, uint32_t count)
+ {
+     uint32_t pos = 0u;
+     uint32_t n;
+
+     if (count == 0u) {
+         return 0;
+     }
+
+     n = ringBufferMpmc_claim(ring, &ring->dequeuePos, 1u, count, &pos);
+     if ((n == 0u) && (ring->config.notify != (ringBufferNotify_t)0)) {
+         /* Pairs with the fence in ringBufferMpmc_pushItems(), see ringBufferSpsc_available(). */
+         __atomic_thread_fence(__ATOMIC_SEQ_CST);
+         n = ringBufferMpmc_claim(ring, &ring->dequeuePos, 1u, count, &pos);
+     }
+     if (n == 0u) {
+         return 0;
+     }
+
+     ringBuffer_copyOut(ring->config.data, ring->config.mask, ring->config.itemSize, pos, items, n);
+     for (uint32_t i = 0u; i < n; i++) {
+         __atomic_store_n(&ring->config.sequence[(pos + i) & ring->config.mask],
+                          pos + i + ring->config.mask + 1u, __ATOMIC_RELEASE);
+     }
+     return n;
+ }
+
+ int ringBufferMpmc_push(ringBufferMpmc_t *ring, const void *item)
+ {
+     return (ringBufferMpmc_pushItems(ring, (const uint8_t *)item, 1u) == 1u) ? 0 : -1;
+ }
+
+ int ringBufferMpmc_pop(ringBufferMpmc_t *ring, void *item)
+ {
+     return (ringBufferMpmc_popItems(ring, (uint8_t *)item, 1u) == 1u) ? 0 : -1;
+ }
+
+ uint32_t ringBufferMpmc_pushBatch(ringBufferMpmc_t *ring, const void *items, uint32_t count)
+ {
+     return ringBufferMpmc_pushItems(ring, (const uint8_t *)items, count);
+ }
+
+ uint32_t ringBufferMpmc_popBatch(ringBufferMpmc_t *ring, void *items, uint32_t count)
+ {
+     return ringBufferMpmc_popItems(ring, (uint8_t *)items, count);
+ }
+
+ uint32_t ringBufferMpmc_count(const ringBufferMpmc_t *ring)
+ {
+     uint32_t dequeue = __atomic_load_n(&ring->dequeuePos, __ATOMIC_ACQUIRE);
+     uint32_t enqueue = __atomic_load_n(&ring->enqueuePos, __ATOMIC_ACQUIRE);
+     int32_t diff = (int32_t)(enqueue - dequeue);
+     return (diff > 0) ? (uint32_t)diff : 0u;
+ }
@@ -0,0 +1,232 @@
+/**
+ *  \file loggerAsyncTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Asynchronous logger test: the DROP, COUNT and BLOCK overflow
+ *         policies, logger_drain() without a flusher thread and
+ *         logger_shutdown() draining, checking what reaches the callback
+ *         and in which order.
+ *
+ *  Usage: loggerAsyncTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <pthread.h>
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "logger.h"
+
+ #define TEST_CAPACITY 8u
+ #define TEST_RECORDS 4096u
+ #define TEST_PRODUCERS 4u
+ #define TEST_PER_PRODUCER 1000u
+
+ typedef struct {
+     LoggerLevel level;
+     char text[48];
+ } TestRecord;
+
+ static int test_failures = 0;
+ static TestRecord test_records[TEST_RECORDS];
+ static uint32_t test_count = 0u;
+ static uint32_t test_notified = 0u;
+
+ static void test_check(int condition, const char *what)
+ {
+     if (condition == 0) {
+         (void)printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ /* Only ever called by one consumer at a time. */
+ static void test_output(LoggerLevel level, const char *timestamp, const char *message)
+ {
+     (void)timestamp;
+     if (test_count < TEST_RECORDS) {
+         test_records[test_count].level = level;
+         (void)snprintf(test_records[test_count].text, sizeof(test_records[test_count].text), "%s", message);
+     }
+     test_count++;
+ }
+
+ static void test_notify(void *arg)
+ {
+     (void)arg;
+     test_notified++;
+ }
+
+ static void test_reset(void)
+ {
+     test_count = 0u;
+     test_notified = 0u;
+ }
+
+ static void test_log(uint32_t first, uint32_t count)
+ {
+     char text[32];
+
+     for (uint32_t i = first; i < first + count; i++) {
+         (void)snprintf(text, sizeof(text), "message %u", i);
+         logger_log_message(LOGGER_LEVEL_INFO, text, (const char *)0);
+     }
+ }
+
+ /* Records [from, from + count) of the callback are messages first.. in order. */
+ static int test_in_order(uint32_t from, uint32_t first, uint32_t count)
+ {
+     char text[32];
+
+     for (uint32_t i = 0u; i < count; i++) {
+         (void)snprintf(text, sizeof(text), "message %u", first + i);
+         if ((test_records[from + i].level != LOGGER_LEVEL_INFO) || (strcmp(test_records[from + i].text, text) != 0)) {
+             return 0;
+         }
+     }
+     return 1;
+ }
+
+ static void test_start(LoggerOverflowPolicy overflow, int use_thread, uint32_t capacity)
+ {
+     LoggerAsyncConfig config;
+
+     logger_get_default_async_config(&config);
+     config.capacity = capacity;
+     config.overflow = overflow;
+     config.use_thread = use_thread;
+     config.notify = test_notify;
+     test_reset();
+     test_check(logger_start_async(&config) == 0, "start async");
+ }
+
+ /* Without a thread nothing is delivered before logger_drain(), the queue keeps the first records. */
+ static void test_drop(void)
+ {
+     test_start(LOGGER_OVERFLOW_DROP, 0, TEST_CAPACITY);
+     test_check(logger_start_async((const LoggerAsyncConfig *)0) != 0, "second start accepted");
+
+     test_log(0u, TEST_CAPACITY + 4u);
+     test_check(test_count == 0u, "DROP: delivered before drain");
+     test_check(test_notified == 1u, "DROP: notify not called once");
+     test_check(logger_get_dropped_count() == 4u, "DROP: dropped count");
+
+     test_check(logger_drain(3u) == 3u, "DROP: partial drain");
+     test_check(logger_drain(0u) == (TEST_CAPACITY - 3u), "DROP: full drain");
+     test_check(logger_drain(0u) == 0u, "DROP: drain of an empty queue");
+     test_check(test_count == TEST_CAPACITY, "DROP: delivered count");
+     test_check(test_in_order(0u, 0u, TEST_CAPACITY), "DROP: delivery order");
+
+     /* The queue empty again, the next push notifies again. */
+     test_log(100u, 1u);
+     test_check(test_notified == 2u, "DROP: notify after the queue emptied");
+     test_check(logger_drain(0u) == 1u, "DROP: drain after refill");
+     test_check((test_count == (TEST_CAPACITY + 1u)) && test_in_order(TEST_CAPACITY, 100u, 1u), "DROP: refill record");
+     logger_shutdown();
+     test_check(logger_drain(0u) == 0u, "drain in synchronous mode");
+ }
+
+ /* The loss is reported once, in a WARN record after the surviving ones. */
+ static void test_count_policy(void)
+ {
+     test_start(LOGGER_OVERFLOW_COUNT, 0, TEST_CAPACITY);
+     test_log(0u, TEST_CAPACITY + 5u);
+     test_check(logger_get_dropped_count() == 5u, "COUNT: dropped count");
+     test_check(logger_drain(0u) == TEST_CAPACITY, "COUNT: drain");
+     test_check(test_count == (TEST_CAPACITY + 1u), "COUNT: delivered count");
+     test_check(test_in_order(0u, 0u, TEST_CAPACITY), "COUNT: delivery order");
+     test_check((test_records[TEST_CAPACITY].level == LOGGER_LEVEL_WARN) &&
+                (strcmp(test_records[TEST_CAPACITY].text, "logger: 5 messages dropped") == 0), "COUNT: report");
+
+     /* Reported losses are not reported again, new ones are. */
+     (void)logger_drain(0u);
+     test_check(test_count == (TEST_CAPACITY + 1u), "COUNT: report repeated");
+     test_log(0u, TEST_CAPACITY + 2u);
+     (void)logger_drain(0u);
+     test_check((test_count == ((2u * TEST_CAPACITY) + 2u)) &&
+                (strcmp(test_records[(2u * TEST_CAPACITY) + 1u].text, "logger: 2 messages dropped") == 0),
+                "COUNT: second report");
+     logger_shutdown();
+ }
+
+ static void *test_producer(void *arg)
+ {
+     uint32_t id = (uint32_t)(uintptr_t)arg;
+
+     for (uint32_t i = 0u; i < TEST_PER_PRODUCER; i++) {
+         logger_logf(LOGGER_LEVEL_INFO, "producer %u record %u", id, i);
+     }
+     return NULL;
+ }
+
+ /* Several producers on a tiny queue: nothing lost, each producer's records in order. */
+ static void test_block(void)
+ {
+     pthread_t threads[TEST_PRODUCERS];
+     uint32_t next[TEST_PRODUCERS] = { 0u };
+     uint32_t misplaced = 0u;
+
+     test_start(LOGGER_OVERFLOW_BLOCK, 1, TEST_CAPACITY);
+     for (uint32_t i = 0u; i < TEST_PRODUCERS; i++) {
+         (void)pthread_create(&threads[i], NULL, test_producer, (void *)(uintptr_t)i);
+     }
+     for (uint32_t i = 0u; i < TEST_PRODUCERS; i++) {
+         (void)pthread_join(threads[i], NULL);
+     }
+     logger_flush();
+
+     test_check(logger_get_dropped_count() == 0u, "BLOCK: records dropped");
+     test_check(test_count == (TEST_PRODUCERS * TEST_PER_PRODUCER), "BLOCK: delivered count");
+     for (uint32_t i = 0u; (i < test_count) && (i < TEST_RECORDS); i++) {
+         unsigned int id;
+         unsigned int seq;
+         if ((sscanf(test_records[i].text, "producer %u record %u", &id, &seq) != 2) || (id >= TEST_PRODUCERS) ||
+             (seq != next[id])) {
+             misplaced++;
+             continue;
+         }
+         next[id]++;
+     }
+     test_check(misplaced == 0u, "BLOCK: records out of order");
+     test_check(test_notified == 0u, "BLOCK: notify called with a flusher thread");
+     logger_shutdown();
+ }
+
+ /* Whatever is queued at shutdown is delivered, then logging is synchronous again. */
+ static void test_shutdown(void)
+ {
+     test_start(LOGGER_OVERFLOW_DROP, 0, 64u);
+     test_log(0u, 40u);
+     test_check(test_count == 0u, "shutdown: delivered before shutdown");
+     logger_shutdown();
+     test_check((test_count == 40u) && test_in_order(0u, 0u, 40u), "shutdown without a thread");
+
+     test_start(LOGGER_OVERFLOW_COUNT, 1, 64u);
+     test_log(0u, 40u);
+     logger_shutdown();
+     test_check((test_count == 40u) && test_in_order(0u, 0u, 40u), "shutdown with a thread");
+
+     test_log(40u, 1u);
+     test_check((test_count == 41u) && test_in_order(40u, 40u, 1u), "synchronous after shutdown");
+     logger_shutdown();
+     test_check(test_count == 41u, "second shutdown");
+ }
+
+ int main(void)
+ {
+     logger_initialize(test_output);
+
+     test_drop();
+     test_count_policy();
+     test_block();
+     test_shutdown();
+
+     return (test_failures == 0) ? 0 : 1;
+ }
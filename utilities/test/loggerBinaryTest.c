@@ -0,0 +1,106 @@
+/**
+ *  \file loggerBinaryTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Binary log test: writes deferred and text records, cuts the
+ *         last one short and checks the text given by
+ *         logger_decode_binary_file() against snprintf().
+ *
+ *  Usage: loggerBinaryTest [DIR]   (leaves DIR/logger_test.logb for the
+ *  logger_decode check)
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <unistd.h>
+ #include "logger.h"
+
+ #define TEST_TEXT_SIZE 4096u
+
+ static int test_failures = 0;
+
+ static void test_check(int condition, const char *what)
+ {
+     if (condition == 0) {
+         (void)printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ int main(int argc, char **argv)
+ {
+     const char *dir = (argc > 1) ? argv[1] : ".";
+     static char expected[TEST_TEXT_SIZE];
+     static char decoded[TEST_TEXT_SIZE];
+     size_t used = 0u;
+     char path[512];
+     long size;
+     FILE *file;
+
+     (void)snprintf(path, sizeof(path), "%s/logger_test.logb", dir);
+     file = fopen(path, "wb");
+     test_check(file != (FILE *)0, "binary file open");
+     if (file == (FILE *)0) {
+         return 1;
+     }
+
+     logger_set_binary_file(file);
+     for (int i = 0; i < 3; i++) {
+         logger_logf(LOGGER_LEVEL_INFO, "loop %d: err=%.3f state=%s ptr=%p", i, (double)i / 7.0, "run", (void *)&size);
+         used += (size_t)snprintf(&expected[used], sizeof(expected) - used, "[INFO] loop %d: err=%.3f state=%s ptr=%p\n",
+                                  i, (double)i / 7.0, "run", (void *)&size);
+     }
+     logger_logf(LOGGER_LEVEL_ERROR, "%-6s|%5u|%#x|%c|%lld|%%", "left", 42u, 255u, 'z', -9000000000LL);
+     used += (size_t)snprintf(&expected[used], sizeof(expected) - used, "[ERROR] %-6s|%5u|%#x|%c|%lld|%%\n",
+                              "left", 42u, 255u, 'z', -9000000000LL);
+     int written = 0;
+     logger_logf(LOGGER_LEVEL_INFO, "before%n after", &written);
+     used += (size_t)snprintf(&expected[used], sizeof(expected) - used, "[INFO] before after\n");
+     logger_log_message(LOGGER_LEVEL_WARN, "text record", "12:00:00");
+     used += (size_t)snprintf(&expected[used], sizeof(expected) - used, "[12:00:00] [WARN] text record\n");
+     logger_log_message(LOGGER_LEVEL_DEBUG, "cut short by a crash", (const char *)0);
+     logger_set_binary_file((void *)0);
+     size = ftell(file);
+     (void)fclose(file);
+
+     /* A writer killed in the middle of its last record. */
+     test_check(truncate(path, (off_t)(size - 3)) == 0, "truncate");
+
+     file = fopen(path, "rb");
+     FILE *out = tmpfile();
+     test_check((file != (FILE *)0) && (out != (FILE *)0), "decode files");
+     if ((file != (FILE *)0) && (out != (FILE *)0)) {
+         test_check(logger_decode_binary_file(file, out) == 6, "decoded record count");
+         rewind(out);
+         size_t length = fread(decoded, 1u, sizeof(decoded) - 1u, out);
+         decoded[length] = '\0';
+         test_check(strcmp(decoded, expected) == 0, "decoded text differs from snprintf()");
+         if (strcmp(decoded, expected) != 0) {
+             (void)printf("expected:\n%sdecoded:\n%s", expected, decoded);
+         }
+     }
+     if (out != (FILE *)0) {
+         (void)fclose(out);
+     }
+     if (file != (FILE *)0) {
+         (void)fclose(file);
+     }
+
+     /* Anything but a binary log is refused. */
+     file = fopen(argv[0], "rb");
+     test_check((file != (FILE *)0) && (logger_decode_binary_file(file, stdout) < 0), "a non-log file was accepted");
+     if (file != (FILE *)0) {
+         (void)fclose(file);
+     }
+
+     return (test_failures == 0) ? 0 : 1;
+ }
@@ -0,0 +1,101 @@
+/**
+ *  \file loggerFileSinkTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Buffered file sink test: buffered, flush-level and oversized
+ *         lines reach the file complete and in order, in fewer writes
+ *         than lines.
+ *
+ *  Usage: loggerFileSinkTest [DIR]
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "logger.h"
+
+ #define TEST_LINES 500
+ #define TEST_TEXT_SIZE (64u * 1024u)
+
+ static int test_failures = 0;
+
+ static void test_check(int condition, const char *what)
+ {
+     if (condition == 0) {
+         (void)printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ int main(int argc, char **argv)
+ {
+     const char *dir = (argc > 1) ? argv[1] : ".";
+     static char expected[TEST_TEXT_SIZE];
+     static char written[TEST_TEXT_SIZE];
+     char long_line[600];
+     char text[64];
+     size_t used = 0u;
+     LoggerFileSinkConfig config;
+     LoggerFileSinkStats stats;
+     char path[512];
+     FILE *file;
+
+     (void)snprintf(path, sizeof(path), "%s/logger_test.log", dir);
+     (void)remove(path);
+
+     /* Small buffers, so the test crosses buffer and writev() boundaries. */
+     logger_get_default_file_sink_config(&config);
+     config.buffer_size = 256u;
+     config.buffer_count = 4u;
+     config.flush_interval_ms = 0u;
+     test_check(logger_file_sink_open(path, &config) == 0, "file sink open");
+     test_check(logger_file_sink_open(path, &config) != 0, "second open accepted");
+
+     (void)memset(long_line, 'x', sizeof(long_line) - 1u);
+     long_line[sizeof(long_line) - 1u] = '\0';
+     for (int i = 0; i < TEST_LINES; i++) {
+         LoggerLevel level = ((i % 100) == 99) ? LOGGER_LEVEL_ERROR : LOGGER_LEVEL_INFO;
+         (void)snprintf(text, sizeof(text), "line %d", i);
+         logger_file_sink_output(level, (i == 0) ? "ts" : (const char *)0, text);
+         if (i == 0) {
+             used += (size_t)snprintf(&expected[used], sizeof(expected) - used, "[ts] [INFO] line 0\n");
+         } else {
+             used += (size_t)snprintf(&expected[used], sizeof(expected) - used, "[%s] %s\n",
+                                      (level == LOGGER_LEVEL_ERROR) ? "ERROR" : "INFO", text);
+         }
+         if (i == 250) {
+             /* Longer than a buffer: written in place, after what is buffered. */
+             logger_file_sink_output(LOGGER_LEVEL_DEBUG, (const char *)0, long_line);
+             used += (size_t)snprintf(&expected[used], sizeof(expected) - used, "[DEBUG] %s\n", long_line);
+         }
+     }
+
+     /* Nothing buffered is lost by close. */
+     logger_file_sink_get_stats(&stats);
+     logger_file_sink_close();
+     test_check(stats.records == (uint64_t)(TEST_LINES + 1), "record count");
+     test_check((stats.writes != 0u) && (stats.writes < (uint64_t)(TEST_LINES / 4)), "lines were not batched");
+     test_check(stats.errors == 0u, "write errors");
+
+     file = fopen(path, "rb");
+     test_check(file != (FILE *)0, "log file missing");
+     if (file != (FILE *)0) {
+         size_t length = fread(written, 1u, sizeof(written) - 1u, file);
+         written[length] = '\0';
+         (void)fclose(file);
+         test_check(strcmp(written, expected) == 0, "file content differs");
+     }
+
+     /* Lines logged while closed are ignored. */
+     logger_file_sink_output(LOGGER_LEVEL_ERROR, (const char *)0, "closed");
+
+     return (test_failures == 0) ? 0 : 1;
+ }
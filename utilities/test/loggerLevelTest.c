@@ -0,0 +1,187 @@
+/**
+ *  \file loggerLevelTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Logger level test: module registration, module levels against
+ *         the global level, logger_is_enabled(), and records filtered out
+ *         before they reach the asynchronous queue.
+ *
+ *  Usage: loggerLevelTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "logger.h"
+
+ #define TEST_RECORDS 64u
+
+ static int test_failures = 0;
+ static char test_records[TEST_RECORDS][48];
+ static uint32_t test_count = 0u;
+
+ static void test_check(int condition, const char *what)
+ {
+     if (condition == 0) {
+         (void)printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static void test_output(LoggerLevel level, const char *timestamp, const char *message)
+ {
+     (void)level;
+     (void)timestamp;
+     if (test_count < TEST_RECORDS) {
+         (void)snprintf(test_records[test_count], sizeof(test_records[test_count]), "%s", message);
+     }
+     test_count++;
+ }
+
+ /* Exactly the given messages were delivered since the last call, in order. */
+ static int test_delivered(const char *const *expected, uint32_t count)
+ {
+     int same = (test_count == count) ? 1 : 0;
+
+     for (uint32_t i = 0u; (same != 0) && (i < count); i++) {
+         same = (strcmp(test_records[i], expected[i]) == 0) ? 1 : 0;
+     }
+     test_count = 0u;
+     return same;
+ }
+
+ static void test_registration(int *net, int *disk)
+ {
+     *net = logger_register_module("net");
+     *disk = logger_register_module("disk");
+     test_check((*net > LOGGER_MODULE_DEFAULT) && (*disk > LOGGER_MODULE_DEFAULT) && (*net != *disk), "module ids");
+     test_check(logger_register_module("net") == *net, "module registered twice");
+     test_check(logger_register_module((const char *)0) == -1, "NULL name accepted");
+
+     /* Names compare over LOGGER_MODULE_NAME_SIZE - 1 characters. */
+     test_check(logger_register_module("a_rather_long_module") == logger_register_module("a_rather_long_modulX"),
+                "long names not truncated");
+ }
+
+ static void test_levels(int net, int disk)
+ {
+     static const char *const global_warn[] = { "default warn", "net warn", "disk error" };
+     static const char *const net_debug[] = { "net debug 7", "default error" };
+     static const char *const net_reset[] = { "net error" };
+     static const char *const silenced[] = { "net error" };
+
+     test_check(logger_get_level() == LOGGER_LEVEL_DEBUG, "default global level");
+     test_check(logger_is_enabled(net, LOGGER_LEVEL_DEBUG) == 1, "module below the default level");
+
+     /* Without a level of their own, modules follow the global one. */
+     logger_set_level(LOGGER_LEVEL_WARN);
+     test_check(logger_get_level() == LOGGER_LEVEL_WARN, "global level");
+     logger_log_message(LOGGER_LEVEL_INFO, "default info", (const char *)0);
+     logger_log_message(LOGGER_LEVEL_WARN, "default warn", (const char *)0);
+     logger_log_module_message(net, LOGGER_LEVEL_INFO, "net info", (const char *)0);
+     logger_log_module_message(net, LOGGER_LEVEL_WARN, "net warn", (const char *)0);
+     LOGGER_MODULE_LOGF(disk, LOGGER_LEVEL_DEBUG, "disk debug %d", 1);
+     LOGGER_MODULE_LOGF(disk, LOGGER_LEVEL_ERROR, "disk %s", "error");
+     test_check(test_delivered(global_warn, 3u), "global level filter");
+
+     /* A module level survives global changes until reset. */
+     test_check(logger_set_module_level(net, LOGGER_LEVEL_DEBUG) == 0, "set module level");
+     logger_set_level(LOGGER_LEVEL_ERROR);
+     logger_logf_module(net, LOGGER_LEVEL_DEBUG, "net debug %u", 7u);
+     logger_logf_module(disk, LOGGER_LEVEL_WARN, "disk warn");
+     logger_logf(LOGGER_LEVEL_WARN, "default warn");
+     LOGGER_ERROR("default %s", "error");
+     test_check(test_delivered(net_debug, 2u), "module level over the global level");
+     test_check(logger_is_enabled(net, LOGGER_LEVEL_DEBUG) == 1, "is_enabled with a module level");
+     test_check(logger_is_enabled(disk, LOGGER_LEVEL_WARN) == 0, "is_enabled following the global level");
+
+     logger_reset_module_level(net);
+     logger_log_module_message(net, LOGGER_LEVEL_WARN, "net warn", (const char *)0);
+     logger_log_module_message(net, LOGGER_LEVEL_ERROR, "net error", (const char *)0);
+     test_check(test_delivered(net_reset, 1u), "reset module level");
+
+     /* LOGGER_LEVEL_MAX silences a module, ERROR included. */
+     test_check(logger_set_module_level(disk, LOGGER_LEVEL_MAX) == 0, "silence module");
+     logger_log_module_message(disk, LOGGER_LEVEL_ERROR, "disk error", (const char *)0);
+     logger_log_module_message(net, LOGGER_LEVEL_ERROR, "net error", (const char *)0);
+     test_check(test_delivered(silenced, 1u), "silenced module");
+     test_check(logger_is_enabled(disk, LOGGER_LEVEL_ERROR) == 0, "is_enabled on a silenced module");
+     test_check(logger_is_enabled(net, LOGGER_LEVEL_MAX) == 0, "is_enabled with LOGGER_LEVEL_MAX");
+
+     /* Unknown ids follow the default module. */
+     test_check(logger_is_enabled(-1, LOGGER_LEVEL_ERROR) == 1, "negative id not the default module");
+     test_check(logger_is_enabled((int)LOGGER_MAX_MODULES, LOGGER_LEVEL_WARN) == 0, "unknown id not the default module");
+
+     test_check(logger_set_module_level(-1, LOGGER_LEVEL_INFO) == -1, "negative module accepted");
+     test_check(logger_set_module_level((int)LOGGER_MAX_MODULES, LOGGER_LEVEL_INFO) == -1, "unknown module accepted");
+     test_check(logger_set_module_level(net, (LoggerLevel)(LOGGER_LEVEL_MAX + 1)) == -1, "invalid level accepted");
+     logger_set_level((LoggerLevel)(LOGGER_LEVEL_MAX + 1));
+     test_check(logger_get_level() == LOGGER_LEVEL_ERROR, "invalid global level accepted");
+
+     logger_reset_module_level(disk);
+     logger_set_level(LOGGER_LEVEL_DEBUG);
+ }
+
+ /* Filtered records never take a queue slot. */
+ static void test_async_filter(int net)
+ {
+     static const char *const passed[] = { "net warn", "default info" };
+     LoggerAsyncConfig config;
+
+     logger_get_default_async_config(&config);
+     config.capacity = 4u;
+     config.use_thread = 0;
+     test_check(logger_start_async(&config) == 0, "start async");
+     test_check(logger_set_module_level(net, LOGGER_LEVEL_WARN) == 0, "set module level in async mode");
+     for (uint32_t i = 0u; i < 16u; i++) {
+         logger_logf_module(net, LOGGER_LEVEL_INFO, "net info %u", i);
+     }
+     logger_logf_module(net, LOGGER_LEVEL_WARN, "net warn");
+     logger_logf(LOGGER_LEVEL_INFO, "default info");
+     test_check(logger_drain(0u) == 2u, "filtered records queued");
+     test_check(logger_get_dropped_count() == 0u, "filtered records dropped");
+     test_check(test_delivered(passed, 2u), "async level filter");
+     logger_shutdown();
+     logger_reset_module_level(net);
+ }
+
+ static void test_table_full(void)
+ {
+     char name[LOGGER_MODULE_NAME_SIZE];
+     int last = 0;
+
+     for (uint32_t i = 0u; i < LOGGER_MAX_MODULES; i++) {
+         (void)snprintf(name, sizeof(name), "module%u", i);
+         int module = logger_register_module(name);
+         if (module < 0) {
+             break;
+         }
+         last = module;
+     }
+     test_check(last == (int)(LOGGER_MAX_MODULES - 1u), "module table not filled");
+     test_check(logger_register_module("one_too_many") == -1, "module registered past LOGGER_MAX_MODULES");
+     test_check(logger_register_module("net") >= 0, "existing module lost when full");
+ }
+
+ int main(void)
+ {
+     int net;
+     int disk;
+
+     logger_initialize(test_output);
+
+     test_registration(&net, &disk);
+     test_levels(net, disk);
+     test_async_filter(net);
+     test_table_full();
+
+     return (test_failures == 0) ? 0 : 1;
+ }
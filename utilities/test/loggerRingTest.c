@@ -0,0 +1,153 @@
+/**
+ *  \file loggerRingTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Ring sink test: wraps the ring, tears one record, reopens the
+ *         ring and checks that logger_ring_sink_read() prints the intact
+ *         records in order.
+ *
+ *  Usage: loggerRingTest [DIR]   (leaves DIR/logger_test.ring for the
+ *  logger_ring_read check)
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "logger.h"
+
+ #define TEST_RING_SIZE (16u * 1024u)
+ #define TEST_RECORDS 1000
+ #define TEST_TORN 990
+ #define TEST_AFTER 5
+ #define TEST_RECORD_HEADER 24u        /* sizeof(LoggerRingRecord), the marker comes first. */
+
+ static int test_failures = 0;
+
+ static void test_check(int condition, const char *what)
+ {
+     if (condition == 0) {
+         (void)printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static char *test_read_file(const char *path, long *size)
+ {
+     FILE *file = fopen(path, "rb");
+     char *data = (char *)0;
+
+     *size = 0;
+     if (file != (FILE *)0) {
+         (void)fseek(file, 0, SEEK_END);
+         *size = ftell(file);
+         (void)fseek(file, 0, SEEK_SET);
+         data = (char *)malloc((size_t)*size + 1u);
+         if ((data != (char *)0) && (fread(data, 1u, (size_t)*size, file) != (size_t)*size)) {
+             free(data);
+             data = (char *)0;
+         }
+         if (data != (char *)0) {
+             data[*size] = '\0';
+         }
+         (void)fclose(file);
+     }
+     return data;
+ }
+
+ /* Clears the marker of the record holding text, as if the writer died before storing it. */
+ static int test_tear(const char *path, const char *text)
+ {
+     long size = 0;
+     char *data = test_read_file(path, &size);
+     size_t length = strlen(text);
+     int torn = 0;
+
+     for (long i = (long)TEST_RECORD_HEADER; (data != (char *)0) && (i + (long)length <= size); i++) {
+         if (memcmp(&data[i], text, length) == 0) {
+             FILE *file = fopen(path, "r+b");
+             static const char zero[4] = { 0, 0, 0, 0 };
+             if (file != (FILE *)0) {
+                 (void)fseek(file, i - (long)TEST_RECORD_HEADER, SEEK_SET);
+                 torn = (fwrite(zero, 1u, sizeof(zero), file) == sizeof(zero)) ? 1 : 0;
+                 (void)fclose(file);
+             }
+             break;
+         }
+     }
+     free(data);
+     return torn;
+ }
+
+ int main(int argc, char **argv)
+ {
+     const char *dir = (argc > 1) ? argv[1] : ".";
+     char path[512];
+     char text[64];
+     FILE *out;
+
+     (void)snprintf(path, sizeof(path), "%s/logger_test.ring", dir);
+     (void)remove(path);
+
+     /* Enough records to wrap the ring several times. */
+     test_check(logger_ring_sink_open(path, TEST_RING_SIZE) == 0, "ring open");
+     for (int i = 0; i < TEST_RECORDS; i++) {
+         (void)snprintf(text, sizeof(text), "ring %d;", i);
+         logger_ring_sink_output(LOGGER_LEVEL_INFO, "ts", text);
+     }
+     logger_ring_sink_close();
+
+     (void)snprintf(text, sizeof(text), "tsring %d;", TEST_TORN);
+     test_check(test_tear(path, text) == 1, "record to tear not found");
+
+     /* The reopened ring continues after its newest record. */
+     test_check(logger_ring_sink_open(path, TEST_RING_SIZE) == 0, "ring reopen");
+     for (int i = 0; i < TEST_AFTER; i++) {
+         (void)snprintf(text, sizeof(text), "after %d;", i);
+         logger_ring_sink_output(LOGGER_LEVEL_WARN, (const char *)0, text);
+     }
+     logger_ring_sink_close();
+
+     out = tmpfile();
+     test_check((out != (FILE *)0) && (logger_ring_sink_read(path, out) > 0), "ring read");
+     if (out != (FILE *)0) {
+         char line[128];
+         int expected = -1;
+         int after = 0;
+
+         rewind(out);
+         while (fgets(line, (int)sizeof(line), out) != (char *)0) {
+             int value = 0;
+             if (sscanf(line, "[ts] [INFO] ring %d;", &value) == 1) {
+                 if (expected < 0) {
+                     expected = value;
+                 }
+                 if (expected == TEST_TORN) {
+                     expected++;
+                 }
+                 test_check((value == expected) && (after == 0), "ring records out of order");
+                 test_check(value != TEST_TORN, "torn record printed");
+                 expected = value + 1;
+             } else if (sscanf(line, "[WARN] after %d;", &value) == 1) {
+                 test_check(value == after, "records after reopen out of order");
+                 after++;
+             } else {
+                 test_check(0, "unexpected ring line");
+             }
+         }
+         test_check(expected == TEST_RECORDS, "newest records before the reopen missing");
+         test_check(after == TEST_AFTER, "records after the reopen missing");
+         (void)fclose(out);
+     }
+
+     test_check(logger_ring_sink_read(argv[0], stdout) < 0, "a non-ring file was accepted");
+
+     return (test_failures == 0) ? 0 : 1;
+ }
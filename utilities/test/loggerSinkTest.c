@@ -0,0 +1,319 @@
+/**
+ *  \file loggerSinkTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Logger sink test: per-sink levels, a stalled asynchronous sink
+ *         delaying nobody but itself and counting its losses, then sinks
+ *         added and removed while other threads log.
+ *
+ *  Usage: loggerSinkTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <pthread.h>
+ #include <sched.h>
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "logger.h"
+
+ #define TEST_RECORDS 64u
+ #define TEST_CAPACITY 8u
+ #define TEST_PRODUCERS 3u
+ #define TEST_PER_PRODUCER 3000u
+
+ /* What one output received. */
+ typedef struct {
+     char text[TEST_RECORDS][48];
+     LoggerLevel level[TEST_RECORDS];
+     uint32_t count;
+     uint32_t next[TEST_PRODUCERS];      /* Next sequence number allowed from each producer. */
+     uint32_t misplaced;                 /* Records out of order or not parsed. */
+     uint8_t removed;                    /* Set once logger_remove_sink() returned. */
+     uint32_t late;                      /* Records received while removed. */
+ } TestOutput;
+
+ static int test_failures = 0;
+ static TestOutput test_main;
+ static TestOutput test_inline;
+ static TestOutput test_async;
+ static uint32_t test_producers_done = 0u;
+
+ /* Gate holding the asynchronous sink output. */
+ static pthread_mutex_t test_gate_mutex = PTHREAD_MUTEX_INITIALIZER;
+ static pthread_cond_t test_gate_cond = PTHREAD_COND_INITIALIZER;
+ static uint8_t test_gate_closed = 0u;
+ static uint8_t test_gate_waiting = 0u;
+
+ static void test_check(int condition, const char *what)
+ {
+     if (condition == 0) {
+         (void)printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static void test_record(TestOutput *output, LoggerLevel level, const char *message)
+ {
+     unsigned int id;
+     unsigned int seq;
+     uint32_t count = __atomic_load_n(&output->count, __ATOMIC_RELAXED);
+
+     if (__atomic_load_n(&output->removed, __ATOMIC_ACQUIRE) != 0u) {
+         output->late++;
+     }
+     if (count < TEST_RECORDS) {
+         output->level[count] = level;
+         (void)snprintf(output->text[count], sizeof(output->text[count]), "%s", message);
+     }
+     if (sscanf(message, "producer %u record %u", &id, &seq) == 2) {
+         if ((id >= TEST_PRODUCERS) || (seq < output->next[id])) {
+             output->misplaced++;
+         } else {
+             output->next[id] = seq + 1u;
+         }
+     }
+     __atomic_store_n(&output->count, count + 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_main_output(LoggerLevel level, const char *timestamp, const char *message)
+ {
+     (void)timestamp;
+     test_record(&test_main, level, message);
+ }
+
+ static void test_inline_output(LoggerLevel level, const char *timestamp, const char *message)
+ {
+     (void)timestamp;
+     test_record(&test_inline, level, message);
+ }
+
+ static void test_async_output(LoggerLevel level, const char *timestamp, const char *message)
+ {
+     (void)timestamp;
+     (void)pthread_mutex_lock(&test_gate_mutex);
+     while (test_gate_closed != 0u) {
+         test_gate_waiting = 1u;
+         (void)pthread_cond_broadcast(&test_gate_cond);
+         (void)pthread_cond_wait(&test_gate_cond, &test_gate_mutex);
+     }
+     test_gate_waiting = 0u;
+     (void)pthread_mutex_unlock(&test_gate_mutex);
+     test_record(&test_async, level, message);
+ }
+
+ static void test_gate(uint8_t closed)
+ {
+     (void)pthread_mutex_lock(&test_gate_mutex);
+     test_gate_closed = closed;
+     (void)pthread_cond_broadcast(&test_gate_cond);
+     (void)pthread_mutex_unlock(&test_gate_mutex);
+ }
+
+ /* Waits until the asynchronous sink thread is stuck at the gate. */
+ static void test_gate_wait(void)
+ {
+     (void)pthread_mutex_lock(&test_gate_mutex);
+     while (test_gate_waiting == 0u) {
+         (void)pthread_cond_wait(&test_gate_cond, &test_gate_mutex);
+     }
+     (void)pthread_mutex_unlock(&test_gate_mutex);
+ }
+
+ static void test_clear(TestOutput *output)
+ {
+     (void)memset(output, 0, sizeof(*output));
+ }
+
+ static void test_sink_config(LoggerSinkConfig *config, LoggerCallback output, LoggerLevel level, LoggerSinkMode mode)
+ {
+     logger_get_default_sink_config(config);
+     config->output = output;
+     config->level = level;
+     config->mode = mode;
+     config->capacity = TEST_CAPACITY;
+ }
+
+ /* Each sink gets the records at or above its own level, in order. */
+ static void test_levels(void)
+ {
+     static const char *const texts[] = { "debug", "info", "warn", "error" };
+     LoggerSinkConfig config;
+     int all;
+     int warn;
+
+     test_sink_config(&config, (LoggerCallback)0, LOGGER_LEVEL_DEBUG, LOGGER_SINK_INLINE);
+     test_check(logger_add_sink(&config) == -1, "sink without output accepted");
+     test_sink_config(&config, test_async_output, LOGGER_LEVEL_DEBUG, LOGGER_SINK_ASYNC);
+     config.overflow = LOGGER_OVERFLOW_BLOCK;
+     test_check(logger_add_sink(&config) == -1, "blocking asynchronous sink accepted");
+     test_check(logger_add_sink((const LoggerSinkConfig *)0) == -1, "NULL configuration accepted");
+
+     test_sink_config(&config, test_inline_output, LOGGER_LEVEL_DEBUG, LOGGER_SINK_INLINE);
+     all = logger_add_sink(&config);
+     test_sink_config(&config, test_async_output, LOGGER_LEVEL_WARN, LOGGER_SINK_ASYNC);
+     warn = logger_add_sink(&config);
+     test_check((all >= 0) && (warn >= 0) && (all != warn), "add sinks");
+
+     for (uint32_t i = 0u; i < 4u; i++) {
+         logger_log_message((LoggerLevel)i, texts[i], (const char *)0);
+     }
+     logger_flush();
+     test_check((test_main.count == 4u) && (test_inline.count == 4u), "inline sink count");
+     for (uint32_t i = 0u; (i < 4u) && (test_inline.count == 4u); i++) {
+         test_check((test_inline.level[i] == (LoggerLevel)i) && (strcmp(test_inline.text[i], texts[i]) == 0),
+                    "inline sink order");
+     }
+     test_check((test_async.count == 2u) && (strcmp(test_async.text[0], "warn") == 0) &&
+                (strcmp(test_async.text[1], "error") == 0), "asynchronous sink level");
+
+     /* LOGGER_LEVEL_MAX pauses a sink, the others keep receiving. */
+     test_check(logger_set_sink_level(all, LOGGER_LEVEL_MAX) == 0, "pause sink");
+     test_check(logger_set_sink_level(all, (LoggerLevel)(LOGGER_LEVEL_MAX + 1)) == -1, "invalid sink level accepted");
+     logger_log_message(LOGGER_LEVEL_ERROR, "paused", (const char *)0);
+     logger_flush();
+     test_check((test_inline.count == 4u) && (test_async.count == 3u) && (test_main.count == 5u), "paused sink");
+
+     logger_remove_sink(all);
+     logger_remove_sink(warn);
+     logger_remove_sink(warn);
+     test_check(logger_set_sink_level(warn, LOGGER_LEVEL_INFO) == -1, "level of a removed sink set");
+     logger_log_message(LOGGER_LEVEL_ERROR, "no sink", (const char *)0);
+     test_check((test_inline.count == 4u) && (test_async.count == 3u) && (test_main.count == 6u), "removed sinks");
+ }
+
+ /* A stalled asynchronous sink delays neither the caller nor the other outputs, and loses records. */
+ static void test_isolation(void)
+ {
+     LoggerSinkConfig config;
+     char text[32];
+     int fast;
+     int slow;
+
+     test_clear(&test_main);
+     test_clear(&test_inline);
+     test_clear(&test_async);
+     test_sink_config(&config, test_inline_output, LOGGER_LEVEL_DEBUG, LOGGER_SINK_INLINE);
+     fast = logger_add_sink(&config);
+     test_sink_config(&config, test_async_output, LOGGER_LEVEL_DEBUG, LOGGER_SINK_ASYNC);
+     config.overflow = LOGGER_OVERFLOW_COUNT;
+     slow = logger_add_sink(&config);
+     test_check((fast >= 0) && (slow >= 0), "add sinks");
+
+     /* The first record holds the sink thread, the queue then fills with TEST_CAPACITY more. */
+     test_gate(1u);
+     logger_log_message(LOGGER_LEVEL_INFO, "message 0", (const char *)0);
+     test_gate_wait();
+     for (uint32_t i = 1u; i < (TEST_CAPACITY + 4u); i++) {
+         (void)snprintf(text, sizeof(text), "message %u", i);
+         logger_log_message(LOGGER_LEVEL_INFO, text, (const char *)0);
+     }
+     test_check((test_main.count == (TEST_CAPACITY + 4u)) && (test_inline.count == (TEST_CAPACITY + 4u)),
+                "others delayed by a stalled sink");
+     test_check(test_async.count == 0u, "stalled sink delivered");
+     test_check(logger_get_sink_dropped_count(slow) == 3u, "stalled sink dropped count");
+     test_check(logger_get_sink_dropped_count(fast) == 0u, "inline sink dropped count");
+
+     test_gate(0u);
+     logger_flush();
+     test_check(test_async.count == (TEST_CAPACITY + 2u), "stalled sink delivered count");
+
+     /* The loss is reported after the batch held at the gate, then the queue follows in order. */
+     test_check((test_async.level[1] == LOGGER_LEVEL_WARN) &&
+                (strcmp(test_async.text[1], "logger: 3 messages dropped") == 0), "stalled sink loss report");
+     for (uint32_t i = 0u; (i <= TEST_CAPACITY) && (test_async.count == (TEST_CAPACITY + 2u)); i++) {
+         (void)snprintf(text, sizeof(text), "message %u", i);
+         test_check(strcmp(test_async.text[(i == 0u) ? 0u : (i + 1u)], text) == 0, "stalled sink order");
+     }
+
+     logger_remove_sink(fast);
+     logger_remove_sink(slow);
+ }
+
+ static void *test_producer(void *arg)
+ {
+     uint32_t id = (uint32_t)(uintptr_t)arg;
+
+     for (uint32_t i = 0u; i < TEST_PER_PRODUCER; i++) {
+         logger_logf(LOGGER_LEVEL_INFO, "producer %u record %u", id, i);
+         if ((i % 64u) == 0u) {
+             (void)sched_yield();
+         }
+     }
+     (void)__atomic_add_fetch(&test_producers_done, 1u, __ATOMIC_RELEASE);
+     return NULL;
+ }
+
+ /* Sinks come and go under the flusher thread: no call after removal, nothing reordered or lost upstream. */
+ static void test_remove_while_logging(void)
+ {
+     pthread_t threads[TEST_PRODUCERS];
+     LoggerAsyncConfig async;
+     LoggerSinkConfig config;
+     uint32_t rounds = 0u;
+
+     test_clear(&test_main);
+     test_clear(&test_inline);
+     test_clear(&test_async);
+     logger_get_default_async_config(&async);
+     async.capacity = 64u;
+     async.overflow = LOGGER_OVERFLOW_BLOCK;
+     test_check(logger_start_async(&async) == 0, "start async");
+
+     for (uint32_t i = 0u; i < TEST_PRODUCERS; i++) {
+         (void)pthread_create(&threads[i], NULL, test_producer, (void *)(uintptr_t)i);
+     }
+     while (__atomic_load_n(&test_producers_done, __ATOMIC_ACQUIRE) < TEST_PRODUCERS) {
+         uint32_t before = __atomic_load_n(&test_inline.count, __ATOMIC_ACQUIRE);
+         int sinks[2];
+
+         __atomic_store_n(&test_inline.removed, 0u, __ATOMIC_RELEASE);
+         __atomic_store_n(&test_async.removed, 0u, __ATOMIC_RELEASE);
+         test_sink_config(&config, test_inline_output, LOGGER_LEVEL_DEBUG, LOGGER_SINK_INLINE);
+         sinks[0] = logger_add_sink(&config);
+         test_sink_config(&config, test_async_output, LOGGER_LEVEL_DEBUG, LOGGER_SINK_ASYNC);
+         config.overflow = LOGGER_OVERFLOW_DROP;
+         sinks[1] = logger_add_sink(&config);
+         test_check((sinks[0] >= 0) && (sinks[1] >= 0), "add sinks while logging");
+         /* Each registration sees records before it goes away. */
+         while ((__atomic_load_n(&test_inline.count, __ATOMIC_ACQUIRE) == before) &&
+                (__atomic_load_n(&test_producers_done, __ATOMIC_ACQUIRE) < TEST_PRODUCERS)) {
+             (void)sched_yield();
+         }
+         logger_remove_sink(sinks[0]);
+         __atomic_store_n(&test_inline.removed, 1u, __ATOMIC_RELEASE);
+         logger_remove_sink(sinks[1]);
+         __atomic_store_n(&test_async.removed, 1u, __ATOMIC_RELEASE);
+         rounds++;
+     }
+     for (uint32_t i = 0u; i < TEST_PRODUCERS; i++) {
+         (void)pthread_join(threads[i], NULL);
+     }
+     logger_shutdown();
+
+     test_check(rounds != 0u, "sinks not cycled");
+     test_check(test_main.count == (TEST_PRODUCERS * TEST_PER_PRODUCER), "main output count");
+     test_check(test_main.misplaced == 0u, "main output order");
+     test_check((test_inline.misplaced == 0u) && (test_async.misplaced == 0u), "sink order");
+     test_check((test_inline.late == 0u) && (test_async.late == 0u), "sink called after removal");
+     test_check((test_inline.count != 0u) && (test_inline.count <= test_main.count), "inline sink count");
+     test_check(test_async.count <= test_main.count, "asynchronous sink count");
+ }
+
+ int main(void)
+ {
+     logger_initialize(test_main_output);
+
+     test_levels();
+     test_isolation();
+     test_remove_while_logging();
+
+     return (test_failures == 0) ? 0 : 1;
+ }
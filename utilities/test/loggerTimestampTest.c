@@ -0,0 +1,208 @@
+/**
+ *  \file loggerTimestampTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Logger timestamp test: the text of logger_time_format() in both
+ *         modes, its per-thread second cache, and the stamps the logger
+ *         puts on records, synchronous and queued, next to the ones the
+ *         caller supplies.
+ *
+ *  Usage: loggerTimestampTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <pthread.h>
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include "logger.h"
+ #include "loggerFormat.h"
+
+ #define TEST_NS 1000000000ull
+ #define TEST_EPOCH 1744797600ll         /* 2025-04-16T10:00:00Z */
+ #define TEST_LOOPS 20000u
+
+ static int test_failures = 0;
+ static char test_stamp[LOGGER_TIME_TEXT_SIZE + 8u];
+ static uint32_t test_count = 0u;
+
+ static void test_check(int condition, const char *what)
+ {
+     if (condition == 0) {
+         (void)printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static void test_output(LoggerLevel level, const char *timestamp, const char *message)
+ {
+     (void)level;
+     (void)message;
+     (void)snprintf(test_stamp, sizeof(test_stamp), "%s", (timestamp != (const char *)0) ? timestamp : "(null)");
+     test_count++;
+ }
+
+ /* count digits from text, 0 if any is not a digit. */
+ static int test_digits(const char *text, size_t count)
+ {
+     for (size_t i = 0u; i < count; i++) {
+         if ((text[i] < '0') || (text[i] > '9')) {
+             return 0;
+         }
+     }
+     return 1;
+ }
+
+ /* "<seconds>.<9 digits>", seconds within a second of CLOCK_MONOTONIC. */
+ static int test_is_monotonic(const char *text)
+ {
+     struct timespec now;
+     const char *dot = strchr(text, '.');
+     size_t seconds = (dot != (const char *)0) ? (size_t)(dot - text) : 0u;
+
+     if ((seconds == 0u) || !test_digits(text, seconds) || (strlen(dot) != 10u) || !test_digits(&dot[1], 9u)) {
+         return 0;
+     }
+     (void)clock_gettime(CLOCK_MONOTONIC, &now);
+     return llabs(atoll(text) - (long long)now.tv_sec) <= 1;
+ }
+
+ /* "YYYY-MM-DDTHH:MM:SS.<9 digits>Z", within a few seconds of CLOCK_REALTIME. */
+ static int test_is_realtime(const char *text)
+ {
+     struct tm tm;
+     int year;
+     int month;
+
+     memset(&tm, 0, sizeof(tm));
+     if ((strlen(text) != 30u) || (text[19] != '.') || !test_digits(&text[20], 9u) || (text[29] != 'Z') ||
+         (sscanf(text, "%4d-%2d-%2dT%2d:%2d:%2d", &year, &month, &tm.tm_mday, &tm.tm_hour, &tm.tm_min,
+                 &tm.tm_sec) != 6)) {
+         return 0;
+     }
+     tm.tm_year = year - 1900;
+     tm.tm_mon = month - 1;
+     return llabs((long long)timegm(&tm) - (long long)time((time_t *)0)) <= 2;
+ }
+
+ /* Fixed times through the formatter, the cache switching seconds and modes. */
+ static void test_format(void)
+ {
+     char text[LOGGER_TIME_TEXT_SIZE];
+     int64_t offset = (TEST_EPOCH * (int64_t)TEST_NS) - (int64_t)(5u * TEST_NS);
+
+     logger_time_format(text, (5u * TEST_NS) + 123456789u, offset, LOGGER_TIMESTAMP_REALTIME);
+     test_check(strcmp(text, "2025-04-16T10:00:00.123456789Z") == 0, "realtime text");
+     logger_time_format(text, (5u * TEST_NS) + 7u, offset, LOGGER_TIMESTAMP_REALTIME);
+     test_check(strcmp(text, "2025-04-16T10:00:00.000000007Z") == 0, "realtime fraction with a cached second");
+     logger_time_format(text, (5u * TEST_NS) + 7u, offset, LOGGER_TIMESTAMP_MONOTONIC);
+     test_check(strcmp(text, "5.000000007") == 0, "monotonic text after realtime in the same second");
+     logger_time_format(text, (6u * TEST_NS) - 1u, offset, LOGGER_TIMESTAMP_REALTIME);
+     test_check(strcmp(text, "2025-04-16T10:00:00.999999999Z") == 0, "realtime after a mode switch");
+     logger_time_format(text, 6u * TEST_NS, offset, LOGGER_TIMESTAMP_REALTIME);
+     test_check(strcmp(text, "2025-04-16T10:00:01.000000000Z") == 0, "realtime next second");
+     logger_time_format(text, (4u * TEST_NS) + 1u, offset, LOGGER_TIMESTAMP_REALTIME);
+     test_check(strcmp(text, "2025-04-16T09:59:59.000000001Z") == 0, "realtime previous second");
+
+     /* Largest seconds prefix still fits. */
+     logger_time_format(text, UINT64_MAX / 2u, 0, LOGGER_TIMESTAMP_MONOTONIC);
+     test_check(strcmp(text, "9223372036.854775807") == 0, "monotonic 63-bit time");
+     logger_time_format(text, 1u, -(int64_t)TEST_NS, LOGGER_TIMESTAMP_REALTIME);
+     test_check(strcmp(text, "1970-01-01T00:00:00.000000000Z") == 0, "realtime before the epoch not clamped");
+ }
+
+ /* Each thread formats its own second against its own cache. */
+ static void *test_format_thread(void *arg)
+ {
+     uint64_t second = (uint64_t)(uintptr_t)arg;
+     char text[LOGGER_TIME_TEXT_SIZE];
+     char expected[LOGGER_TIME_TEXT_SIZE];
+     uintptr_t wrong = 0u;
+
+     for (uint32_t i = 0u; i < TEST_LOOPS; i++) {
+         uint32_t fraction = (i * 7919u) % (uint32_t)TEST_NS;
+         logger_time_format(text, (second * TEST_NS) + fraction, 0, LOGGER_TIMESTAMP_MONOTONIC);
+         (void)snprintf(expected, sizeof(expected), "%llu.%09u", (unsigned long long)second, fraction);
+         wrong += (strcmp(text, expected) != 0) ? 1u : 0u;
+         if ((i % 64u) == 0u) {
+             sched_yield();
+         }
+     }
+     return (void *)wrong;
+ }
+
+ static void test_format_threads(void)
+ {
+     pthread_t threads[2];
+     void *wrong[2] = { (void *)1, (void *)1 };
+
+     for (uintptr_t i = 0u; i < 2u; i++) {
+         (void)pthread_create(&threads[i], NULL, test_format_thread, (void *)(100u + i));
+     }
+     for (uint32_t i = 0u; i < 2u; i++) {
+         (void)pthread_join(threads[i], &wrong[i]);
+     }
+     test_check((wrong[0] == NULL) && (wrong[1] == NULL), "second cache shared between threads");
+ }
+
+ /* Records logged without a timestamp get the logger's, a caller timestamp wins. */
+ static void test_records(void)
+ {
+     char first[sizeof(test_stamp)];
+
+     test_check(logger_get_timestamp_mode() == LOGGER_TIMESTAMP_NONE, "default mode");
+     logger_log_message(LOGGER_LEVEL_INFO, "plain", (const char *)0);
+     test_check(strcmp(test_stamp, "(null)") == 0, "stamped with LOGGER_TIMESTAMP_NONE");
+
+     logger_set_timestamp_mode(LOGGER_TIMESTAMP_MONOTONIC);
+     test_check(logger_get_timestamp_mode() == LOGGER_TIMESTAMP_MONOTONIC, "monotonic mode");
+     logger_log_message(LOGGER_LEVEL_INFO, "monotonic", (const char *)0);
+     test_check(test_is_monotonic(test_stamp), "monotonic stamp");
+     (void)snprintf(first, sizeof(first), "%s", test_stamp);
+     logger_logf(LOGGER_LEVEL_INFO, "monotonic %d", 2);
+     test_check(test_is_monotonic(test_stamp) && (strtod(test_stamp, NULL) >= strtod(first, NULL)),
+                "monotonic stamps going backwards");
+     logger_log_message(LOGGER_LEVEL_INFO, "caller", "12:00:00");
+     test_check(strcmp(test_stamp, "12:00:00") == 0, "caller timestamp replaced in monotonic mode");
+
+     logger_set_timestamp_mode(LOGGER_TIMESTAMP_REALTIME);
+     logger_log_message(LOGGER_LEVEL_INFO, "realtime", (const char *)0);
+     test_check(test_is_realtime(test_stamp), "realtime stamp");
+     logger_log_message(LOGGER_LEVEL_INFO, "caller", "12:00:00");
+     test_check(strcmp(test_stamp, "12:00:00") == 0, "caller timestamp replaced in realtime mode");
+
+     /* Queued records keep the raw time, formatted at delivery. */
+     LoggerAsyncConfig config;
+     logger_get_default_async_config(&config);
+     config.use_thread = 0;
+     test_check(logger_start_async(&config) == 0, "start async");
+     test_count = 0u;
+     logger_log_message(LOGGER_LEVEL_INFO, "queued", (const char *)0);
+     test_check((logger_drain(0u) == 1u) && test_is_realtime(test_stamp), "queued realtime stamp");
+     logger_log_message(LOGGER_LEVEL_INFO, "queued caller", "12:00:01");
+     test_check((logger_drain(0u) == 1u) && (strcmp(test_stamp, "12:00:01") == 0), "queued caller timestamp replaced");
+     logger_shutdown();
+
+     logger_set_timestamp_mode(LOGGER_TIMESTAMP_NONE);
+     logger_log_message(LOGGER_LEVEL_INFO, "plain again", (const char *)0);
+     test_check(strcmp(test_stamp, "(null)") == 0, "stamped after going back to LOGGER_TIMESTAMP_NONE");
+ }
+
+ int main(void)
+ {
+     logger_initialize(test_output);
+
+     test_format();
+     test_format_threads();
+     test_records();
+
+     return (test_failures == 0) ? 0 : 1;
+ }
@@ -0,0 +1,167 @@
+/**
+ *  \file memoryPoolTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Memory pool test: exhaustion, release and reacquire,
+ *         memoryPool_owns(), then several threads acquiring and releasing
+ *         concurrently, checking that no block is handed out twice.
+ *
+ *  Usage: memoryPoolTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <pthread.h>
+ #include <sched.h>
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "memoryPool.h"
+
+ #define TEST_COUNT 16u
+ #define TEST_BLOCK_SIZE 40u
+ #define TEST_THREADS 4u
+ #define TEST_HELD 3u                    /* Blocks a thread holds at once. */
+ #define TEST_ROUNDS 20000u
+
+ static int test_failures = 0;
+ static memoryPool_t test_pool;
+ static uint32_t test_owner[TEST_COUNT];       /* Thread holding each block + 1, 0 = free. */
+ static uint32_t test_duplicates = 0u;
+
+ static void test_check(int condition, const char *what)
+ {
+     if (condition == 0) {
+         (void)printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static uint32_t test_index(const void *block)
+ {
+     return (uint32_t)(((const uint8_t *)block - test_pool.blocks) / test_pool.blockSize);
+ }
+
+ static void test_single_thread(void)
+ {
+     static uint8_t storage[MEMORYPOOL_STORAGE_SIZE(TEST_COUNT, TEST_BLOCK_SIZE)] __attribute__((aligned(MEMORYPOOL_ALIGN)));
+     void *blocks[TEST_COUNT];
+     uint8_t outside = 0u;
+
+     test_check(memoryPool_init(&test_pool, storage, 0u, TEST_BLOCK_SIZE) != 0, "init with no block accepted");
+     test_check(memoryPool_storageSize(TEST_COUNT, TEST_BLOCK_SIZE) == sizeof(storage), "storage size");
+     test_check(memoryPool_init(&test_pool, storage, TEST_COUNT, TEST_BLOCK_SIZE) == 0, "init");
+
+     /* Every block once, distinct and aligned, then NULL. */
+     for (uint32_t i = 0u; i < TEST_COUNT; i++) {
+         blocks[i] = memoryPool_acquire(&test_pool);
+         test_check(blocks[i] != (void *)0, "acquire");
+         test_check(((uintptr_t)blocks[i] % MEMORYPOOL_ALIGN) == 0u, "block alignment");
+         test_check(memoryPool_owns(&test_pool, blocks[i]) == 1u, "own block not recognised");
+         for (uint32_t j = 0u; j < i; j++) {
+             test_check(blocks[i] != blocks[j], "block handed out twice");
+         }
+         (void)memset(blocks[i], (int)i, TEST_BLOCK_SIZE);
+     }
+     test_check(memoryPool_acquire(&test_pool) == (void *)0, "acquire past exhaustion");
+     for (uint32_t i = 0u; i < TEST_COUNT; i++) {
+         const uint8_t *bytes = (const uint8_t *)blocks[i];
+         test_check((bytes[0] == (uint8_t)i) && (bytes[TEST_BLOCK_SIZE - 1u] == (uint8_t)i), "blocks overlap");
+     }
+
+     /* A released block is the next one handed out. */
+     memoryPool_release(&test_pool, blocks[5]);
+     memoryPool_release(&test_pool, (void *)0);
+     test_check(memoryPool_acquire(&test_pool) == blocks[5], "released block not reacquired");
+     test_check(memoryPool_acquire(&test_pool) == (void *)0, "acquire past exhaustion after reacquire");
+     for (uint32_t i = 0u; i < TEST_COUNT; i++) {
+         memoryPool_release(&test_pool, blocks[i]);
+     }
+     for (uint32_t i = 0u; i < TEST_COUNT; i++) {
+         test_check(memoryPool_acquire(&test_pool) != (void *)0, "acquire after release of every block");
+     }
+     test_check(memoryPool_acquire(&test_pool) == (void *)0, "acquire past exhaustion after release of every block");
+
+     test_check(memoryPool_owns(&test_pool, &storage[MEMORYPOOL_BLOCK_SIZE(TEST_BLOCK_SIZE) * TEST_COUNT]) == 0u,
+                "free list area owned");
+     test_check(memoryPool_owns(&test_pool, &outside) == 0u, "foreign pointer owned");
+     test_check(memoryPool_owns(&test_pool, (void *)0) == 0u, "NULL owned");
+     memoryPool_destroy(&test_pool);
+ }
+
+ static void *test_worker(void *arg)
+ {
+     uint32_t self = (uint32_t)(uintptr_t)arg + 1u;
+     void *held[TEST_HELD];
+
+     for (uint32_t round = 0u; round < TEST_ROUNDS; round++) {
+         uint32_t count = 0u;
+         while (count < TEST_HELD) {
+             void *block = memoryPool_acquire(&test_pool);
+             if (block == (void *)0) {
+                 break;
+             }
+             uint32_t expected = 0u;
+             if (!__atomic_compare_exchange_n(&test_owner[test_index(block)], &expected, self, 0,
+                                              __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                 (void)__atomic_add_fetch(&test_duplicates, 1u, __ATOMIC_RELAXED);
+                 continue;
+             }
+             (void)memset(block, (int)self, TEST_BLOCK_SIZE);
+             held[count++] = block;
+         }
+
+         /* Single CPU machines must switch threads while blocks are held. */
+         if ((round % 16u) == 0u) {
+             (void)sched_yield();
+         }
+
+         for (uint32_t i = 0u; i < count; i++) {
+             const uint8_t *bytes = (const uint8_t *)held[i];
+             if ((bytes[0] != (uint8_t)self) || (bytes[TEST_BLOCK_SIZE - 1u] != (uint8_t)self)) {
+                 (void)__atomic_add_fetch(&test_duplicates, 1u, __ATOMIC_RELAXED);
+             }
+             __atomic_store_n(&test_owner[test_index(held[i])], 0u, __ATOMIC_RELEASE);
+             memoryPool_release(&test_pool, held[i]);
+         }
+     }
+     return NULL;
+ }
+
+ static void test_concurrent(void)
+ {
+     pthread_t threads[TEST_THREADS];
+     uint32_t free_blocks = 0u;
+
+     /* Fewer blocks than TEST_THREADS * TEST_HELD: threads also hit exhaustion. */
+     test_check(memoryPool_init(&test_pool, NULL, TEST_THREADS * TEST_HELD - 2u, TEST_BLOCK_SIZE) == 0, "init on the heap");
+     (void)memset(test_owner, 0, sizeof(test_owner));
+     for (uint32_t i = 0u; i < TEST_THREADS; i++) {
+         (void)pthread_create(&threads[i], NULL, test_worker, (void *)(uintptr_t)i);
+     }
+     for (uint32_t i = 0u; i < TEST_THREADS; i++) {
+         (void)pthread_join(threads[i], NULL);
+     }
+     test_check(test_duplicates == 0u, "block held by two threads");
+
+     /* Every block came back. */
+     while (memoryPool_acquire(&test_pool) != (void *)0) {
+         free_blocks++;
+     }
+     test_check(free_blocks == test_pool.count, "blocks lost");
+     memoryPool_destroy(&test_pool);
+ }
+
+ int main(void)
+ {
+     test_single_thread();
+     test_concurrent();
+
+     return (test_failures == 0) ? 0 : 1;
+ }
@@ -0,0 +1,283 @@
+/**
+ *  \file ringBufferTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Ring buffer test: full/empty edges, batches and the notify hook of
+ *         both rings, then concurrent producers and consumers checking that
+ *         every item arrives once and in order per producer.
+ *
+ *  Usage: ringBufferTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <pthread.h>
+ #include <sched.h>
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "ringBuffer.h"
+
+ #define TEST_CAPACITY 8u
+ #define TEST_THREADS 4u
+ #define TEST_ITEMS 20000u
+ #define TEST_BATCH 5u
+
+ typedef struct {
+     uint32_t producer;
+     uint32_t sequence;
+ } TestItem;
+
+ typedef struct {
+     ringBufferSpsc_t *spsc;
+     ringBufferMpmc_t *mpmc;
+     uint32_t index;
+     uint32_t received;
+     uint32_t last[TEST_THREADS];        /* Next sequence expected from each producer. */
+     int ordered;
+ } TestThread;
+
+ static int test_failures = 0;
+ static uint32_t test_notified = 0u;
+ static uint8_t test_seen[TEST_THREADS][TEST_ITEMS];
+ static uint32_t test_consumed = 0u;
+ static uint32_t test_total = 0u;
+
+ static void test_check(int condition, const char *what)
+ {
+     if (condition == 0) {
+         (void)printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static void test_notify(void *arg)
+ {
+     (void)__atomic_add_fetch((uint32_t *)arg, 1u, __ATOMIC_RELAXED);
+ }
+
+ static void test_spsc_edges(void)
+ {
+     ringBufferSpsc_t ring;
+     uint32_t items[TEST_CAPACITY + 2u];
+     uint32_t value = 0u;
+
+     test_check(ringBufferSpsc_init(&ring, NULL, 6u, sizeof(uint32_t)) != 0, "spsc: capacity 6 accepted");
+     test_check(ringBufferSpsc_init(&ring, NULL, TEST_CAPACITY, sizeof(uint32_t)) == 0, "spsc: init");
+     ringBufferSpsc_setNotify(&ring, test_notify, &test_notified);
+
+     test_check(ringBufferSpsc_pop(&ring, &value) != 0, "spsc: pop from empty");
+     test_check(ringBufferSpsc_popBatch(&ring, items, 4u) == 0u, "spsc: batch pop from empty");
+     for (uint32_t i = 0u; i < TEST_CAPACITY; i++) {
+         test_check(ringBufferSpsc_push(&ring, &i) == 0, "spsc: push");
+     }
+     test_check(test_notified == 1u, "spsc: notify only on the push into empty");
+     test_check(ringBufferSpsc_push(&ring, &value) != 0, "spsc: push into full");
+     test_check(ringBufferSpsc_count(&ring) == TEST_CAPACITY, "spsc: count when full");
+     for (uint32_t i = 0u; i < TEST_CAPACITY; i++) {
+         test_check((ringBufferSpsc_pop(&ring, &value) == 0) && (value == i), "spsc: pop order");
+     }
+     test_check(ringBufferSpsc_count(&ring) == 0u, "spsc: count when empty");
+
+     /* Batches stop at full and at empty, across the wrap. */
+     for (uint32_t i = 0u; i < (TEST_CAPACITY + 2u); i++) {
+         items[i] = 100u + i;
+     }
+     test_check(ringBufferSpsc_pushBatch(&ring, items, 3u) == 3u, "spsc: batch push");
+     test_check(ringBufferSpsc_pushBatch(&ring, &items[3], TEST_CAPACITY) == (TEST_CAPACITY - 3u), "spsc: batch push into full");
+     test_check(test_notified == 2u, "spsc: notify after the ring was drained");
+     (void)memset(items, 0, sizeof(items));
+     test_check(ringBufferSpsc_popBatch(&ring, items, TEST_CAPACITY + 2u) == TEST_CAPACITY, "spsc: batch pop");
+     for (uint32_t i = 0u; i < TEST_CAPACITY; i++) {
+         test_check(items[i] == (100u + i), "spsc: batch order");
+     }
+     ringBufferSpsc_destroy(&ring);
+ }
+
+ static void test_mpmc_edges(void)
+ {
+     ringBufferMpmc_t ring;
+     uint32_t items[TEST_CAPACITY + 2u];
+     uint32_t value = 0u;
+
+     test_notified = 0u;
+     test_check(ringBufferMpmc_init(&ring, NULL, 1u, sizeof(uint32_t)) != 0, "mpmc: capacity 1 accepted");
+     test_check(ringBufferMpmc_init(&ring, NULL, 12u, sizeof(uint32_t)) != 0, "mpmc: capacity 12 accepted");
+     test_check(ringBufferMpmc_init(&ring, NULL, TEST_CAPACITY, sizeof(uint32_t)) == 0, "mpmc: init");
+     ringBufferMpmc_setNotify(&ring, test_notify, &test_notified);
+
+     test_check(ringBufferMpmc_pop(&ring, &value) != 0, "mpmc: pop from empty");
+     test_check(ringBufferMpmc_popBatch(&ring, items, 4u) == 0u, "mpmc: batch pop from empty");
+     for (uint32_t i = 0u; i < TEST_CAPACITY; i++) {
+         test_check(ringBufferMpmc_push(&ring, &i) == 0, "mpmc: push");
+     }
+     test_check(test_notified == 1u, "mpmc: notify only on the push into empty");
+     test_check(ringBufferMpmc_push(&ring, &value) != 0, "mpmc: push into full");
+     test_check(ringBufferMpmc_pushBatch(&ring, items, 2u) == 0u, "mpmc: batch push into full");
+     test_check(ringBufferMpmc_count(&ring) == TEST_CAPACITY, "mpmc: count when full");
+     for (uint32_t i = 0u; i < TEST_CAPACITY; i++) {
+         test_check((ringBufferMpmc_pop(&ring, &value) == 0) && (value == i), "mpmc: pop order");
+     }
+     test_check(ringBufferMpmc_count(&ring) == 0u, "mpmc: count when empty");
+
+     for (uint32_t i = 0u; i < (TEST_CAPACITY + 2u); i++) {
+         items[i] = 200u + i;
+     }
+     test_check(ringBufferMpmc_pushBatch(&ring, items, 3u) == 3u, "mpmc: batch push");
+     test_check(ringBufferMpmc_pushBatch(&ring, &items[3], TEST_CAPACITY) == (TEST_CAPACITY - 3u), "mpmc: batch push into full");
+     test_check(test_notified == 2u, "mpmc: notify after the ring was drained");
+     (void)memset(items, 0, sizeof(items));
+     test_check(ringBufferMpmc_popBatch(&ring, items, TEST_CAPACITY + 2u) == TEST_CAPACITY, "mpmc: batch pop");
+     for (uint32_t i = 0u; i < TEST_CAPACITY; i++) {
+         test_check(items[i] == (200u + i), "mpmc: batch order");
+     }
+     ringBufferMpmc_destroy(&ring);
+ }
+
+ /* Accounts for one item received by a consumer. */
+ static void test_receive(TestThread *self, const TestItem *item)
+ {
+     if ((item->producer >= TEST_THREADS) || (item->sequence >= TEST_ITEMS)) {
+         self->ordered = 0;
+         return;
+     }
+     if (item->sequence < self->last[item->producer]) {
+         self->ordered = 0;
+     }
+     self->last[item->producer] = item->sequence + 1u;
+     (void)__atomic_add_fetch(&test_seen[item->producer][item->sequence], 1u, __ATOMIC_RELAXED);
+     self->received++;
+ }
+
+ /* Pushes TEST_ITEMS items, alternating single pushes and batches. */
+ static void *test_producer(void *arg)
+ {
+     TestThread *self = (TestThread *)arg;
+     TestItem batch[TEST_BATCH];
+     uint32_t sequence = 0u;
+
+     while (sequence < TEST_ITEMS) {
+         uint32_t count = ((sequence % 3u) == 0u) ? 1u : TEST_BATCH;
+         uint32_t pushed;
+         if (count > (TEST_ITEMS - sequence)) {
+             count = TEST_ITEMS - sequence;
+         }
+         for (uint32_t i = 0u; i < count; i++) {
+             batch[i].producer = self->index;
+             batch[i].sequence = sequence + i;
+         }
+         if (self->spsc != (ringBufferSpsc_t *)0) {
+             pushed = (count == 1u) ? ((ringBufferSpsc_push(self->spsc, batch) == 0) ? 1u : 0u)
+                                    : ringBufferSpsc_pushBatch(self->spsc, batch, count);
+         } else {
+             pushed = (count == 1u) ? ((ringBufferMpmc_push(self->mpmc, batch) == 0) ? 1u : 0u)
+                                    : ringBufferMpmc_pushBatch(self->mpmc, batch, count);
+         }
+         sequence += pushed;
+         if (pushed == 0u) {
+             /* Full: let the consumers run, the machine may have a single CPU. */
+             (void)sched_yield();
+         }
+     }
+     return NULL;
+ }
+
+ /* Pops until every producer's items have been taken by some consumer. */
+ static void *test_consumer(void *arg)
+ {
+     TestThread *self = (TestThread *)arg;
+     TestItem batch[TEST_BATCH];
+
+     while (__atomic_load_n(&test_consumed, __ATOMIC_RELAXED) < test_total) {
+         uint32_t popped;
+         if (self->spsc != (ringBufferSpsc_t *)0) {
+             popped = ((self->received % 2u) == 0u) ? ringBufferSpsc_popBatch(self->spsc, batch, TEST_BATCH)
+                                                    : ((ringBufferSpsc_pop(self->spsc, batch) == 0) ? 1u : 0u);
+         } else {
+             popped = ((self->received % 2u) == 0u) ? ringBufferMpmc_popBatch(self->mpmc, batch, TEST_BATCH)
+                                                    : ((ringBufferMpmc_pop(self->mpmc, batch) == 0) ? 1u : 0u);
+         }
+         for (uint32_t i = 0u; i < popped; i++) {
+             test_receive(self, &batch[i]);
+         }
+         (void)__atomic_add_fetch(&test_consumed, popped, __ATOMIC_RELAXED);
+         if (popped == 0u) {
+             (void)sched_yield();
+         }
+     }
+     return NULL;
+ }
+
+ static void test_concurrent(ringBufferSpsc_t *spsc, ringBufferMpmc_t *mpmc, uint32_t threads, const char *what)
+ {
+     static TestThread producers[TEST_THREADS];
+     static TestThread consumers[TEST_THREADS];
+     pthread_t producer_threads[TEST_THREADS];
+     pthread_t consumer_threads[TEST_THREADS];
+     uint32_t received = 0u;
+     int ordered = 1;
+     int once = 1;
+
+     (void)memset(test_seen, 0, sizeof(test_seen));
+     (void)memset(producers, 0, sizeof(producers));
+     (void)memset(consumers, 0, sizeof(consumers));
+     test_consumed = 0u;
+     test_total = threads * TEST_ITEMS;
+
+     for (uint32_t i = 0u; i < threads; i++) {
+         producers[i].spsc = spsc;
+         producers[i].mpmc = mpmc;
+         producers[i].index = i;
+         consumers[i].spsc = spsc;
+         consumers[i].mpmc = mpmc;
+         consumers[i].ordered = 1;
+         (void)pthread_create(&consumer_threads[i], NULL, test_consumer, &consumers[i]);
+         (void)pthread_create(&producer_threads[i], NULL, test_producer, &producers[i]);
+     }
+     for (uint32_t i = 0u; i < threads; i++) {
+         (void)pthread_join(producer_threads[i], NULL);
+         (void)pthread_join(consumer_threads[i], NULL);
+         received += consumers[i].received;
+         ordered &= consumers[i].ordered;
+     }
+     for (uint32_t p = 0u; p < threads; p++) {
+         for (uint32_t i = 0u; i < TEST_ITEMS; i++) {
+             once &= (test_seen[p][i] == 1u) ? 1 : 0;
+         }
+     }
+
+     if ((received != test_total) || (ordered == 0) || (once == 0)) {
+         (void)printf("%s: received %u of %u, ordered %d, each once %d\n", what, received, test_total, ordered, once);
+     }
+     test_check(received == test_total, "concurrent: item count");
+     test_check(ordered != 0, "concurrent: items of a producer out of order");
+     test_check(once != 0, "concurrent: item lost or duplicated");
+ }
+
+ int main(void)
+ {
+     ringBufferSpsc_t spsc;
+     ringBufferMpmc_t mpmc;
+     static uint32_t storage[(64u * sizeof(uint32_t) + 64u * sizeof(TestItem)) / sizeof(uint32_t)];
+
+     test_spsc_edges();
+     test_mpmc_edges();
+
+     /* Small rings, so producers and consumers keep running into full and empty. */
+     test_check(ringBufferSpsc_init(&spsc, NULL, 16u, sizeof(TestItem)) == 0, "spsc: init");
+     test_concurrent(&spsc, (ringBufferMpmc_t *)0, 1u, "spsc");
+     ringBufferSpsc_destroy(&spsc);
+
+     test_check(ringBufferMpmc_storageSize(64u, sizeof(TestItem)) <= sizeof(storage), "mpmc: storage size");
+     test_check(ringBufferMpmc_init(&mpmc, storage, 64u, sizeof(TestItem)) == 0, "mpmc: init on caller storage");
+     test_concurrent((ringBufferSpsc_t *)0, &mpmc, TEST_THREADS, "mpmc");
+     ringBufferMpmc_destroy(&mpmc);
+
+     return (test_failures == 0) ? 0 : 1;
+ }
@@ -0,0 +1,45 @@
+/**
+ *  \file loggerDecode.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 16 APR 2025
+ *
+ *  @brief Converts a binary log written through logger_set_binary_file()
+ *         to text.
+ *
+ *  Usage: logger_decode [FILE]   (standard input when no file is given)
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdio.h>
+ #include "logger.h"
+
+ int main(int argc, char **argv)
+ {
+     FILE *in = stdin;
+     long records;
+
+     if (argc > 2) {
+         (void)printf("usage: %s [FILE]\n", argv[0]);
+         return 2;
+     }
+     if ((argc == 2) && ((in = fopen(argv[1], "rb")) == (FILE *)0)) {
+         (void)printf("Error: unable to open %s\n", argv[1]);
+         return 1;
+     }
+
+     records = logger_decode_binary_file(in, stdout);
+     if (in != stdin) {
+         (void)fclose(in);
+     }
+     if (records < 0) {
+         (void)fprintf(stderr, "Error: not a binary log\n");
+         return 1;
+     }
+     return 0;
+ }
@@ -0,0 +1,34 @@
+/**
+ *  \file loggerRingRead.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 16 APR 2025
+ *
+ *  @brief Prints the records of a ring file written through
+ *         logger_ring_sink_output(), oldest first.
+ *
+ *  Usage: logger_ring_read FILE
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdio.h>
+ #include "logger.h"
+
+ int main(int argc, char **argv)
+ {
+     if (argc != 2) {
+         (void)printf("usage: %s FILE\n", argv[0]);
+         return 2;
+     }
+
+     if (logger_ring_sink_read(argv[1], stdout) < 0) {
+         (void)fprintf(stderr, "Error: %s is not a log ring\n", argv[1]);
+         return 1;
+     }
+     return 0;
+ }
@@ -0,0 +1,399 @@
+/**
+ * @file workerManagerBench.c
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 16 APR 2025
+ * @brief Micro-benchmarks of the worker manager.
+ *
+ * Measures dispatch cost against list length, add/remove latency under
+ * load, wake-up jitter, init/end time and throughput with 1 to N busy
+ * priority threads. Every result is printed as one JSON object per line
+ * (JSON Lines) on stdout or in the file given with --out, so runs can be
+ * compared between releases with any JSON tool.
+ *
+ * Usage: workersManager_bench [--quick] [--levels N] [--out FILE]
+ *
+ * The exit status is non-zero if a benchmark could not run as expected
+ * (no dispatch, lost worker), which makes it usable as a ctest smoke test.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "workerManager.h"
+
+#define BENCH_MAX_WORKERS      ((WORKERMANAGER_STATIC_POOLS && (WORKERMANAGER_MAX_WORKERS < 512u)) ? \
+                                WORKERMANAGER_MAX_WORKERS : 512u)
+#define BENCH_MAX_SAMPLES      2000u
+#define BENCH_WORKERS_PER_LEVEL 8u
+
+/**
+ * @brief Per-worker counters, one cache line each so that threads never share.
+ */
+typedef struct {
+    uint64_t runs;                 /**< Runs of the worker. */
+    uint64_t lastRun;              /**< Time of the last run in ns. */
+    uint8_t pad[48];
+} benchCounter_t;
+
+/*************** STATIC SECTION ***************/
+
+static FILE *_out = NULL;
+static uint8_t _quick = 0;
+static uint8_t _levels = 4;
+static int _failures = 0;
+
+static worker_t *_workers[BENCH_MAX_WORKERS];
+static benchCounter_t _counters[BENCH_MAX_WORKERS] __attribute__((aligned(64)));
+static uint64_t _samples[BENCH_MAX_SAMPLES];
+
+static uint64_t _nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+static void _sleepMs(uint32_t ms) {
+    usleep(ms * 1000u);
+}
+
+static void _count(void *args) {
+    benchCounter_t *counter = (benchCounter_t *)args;
+    __atomic_store_n(&counter->runs, counter->runs + 1u, __ATOMIC_RELAXED);
+    __atomic_store_n(&counter->lastRun, _nowNs(), __ATOMIC_RELAXED);
+}
+
+static uint64_t _totalRuns(uint32_t count) {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        total += __atomic_load_n(&_counters[i].runs, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+static int _compare(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Sort the samples and return the value at the given per-mille rank.
+ */
+static uint64_t _percentile(uint64_t *samples, uint32_t count, uint32_t perMille) {
+    if (count == 0u) {
+        return 0u;
+    }
+    qsort(samples, count, sizeof(uint64_t), _compare);
+    uint32_t index = (uint32_t)(((uint64_t)count * perMille) / 1000u);
+    return samples[(index < count) ? index : (count - 1u)];
+}
+
+/**
+ * @brief Start the manager with nLevels levels looping with no sleep.
+ */
+static int _start(uint8_t nLevels, uint32_t sleepTime) {
+    workerManagerConfig_t config;
+    workerManager_getDefaultConfig(&config);
+    config.priorityNum = nLevels;
+    for (uint8_t i = 0; i < nLevels; i++) {
+        config.priority[i].sleepTime = sleepTime;
+    }
+    return workerManager_initEx(&config);
+}
+
+/**
+ * @brief Register count counting workers round robin over nLevels levels.
+ */
+static void _addWorkers(uint32_t count, uint8_t nLevels) {
+    memset(_counters, 0x00, sizeof(_counters));
+    for (uint32_t i = 0; i < count; i++) {
+        _workers[i]->run.handler = _count;
+        _workers[i]->run.args = &_counters[i];
+        _workers[i]->schedule.period = 0;
+        workerManager_addWorker(_workers[i], (uint8_t)(i % nLevels));
+    }
+}
+
+static void _check(int ok, const char *bench) {
+    if (!ok) {
+        fprintf(stderr, "Error: benchmark %s failed\n", bench);
+        _failures++;
+    }
+}
+
+/**
+ * @brief Cost of one worker activation as a function of the list length.
+ *
+ * One level loops without sleeping over n workers; the time per run is
+ * the wall time divided by the number of runs.
+ */
+static void _benchDispatch(void) {
+    static const uint32_t lengths[] = { 1u, 8u, 64u, 512u };
+    uint32_t duration = _quick ? 100u : 1000u;
+
+    for (uint32_t l = 0; l < (sizeof(lengths) / sizeof(lengths[0])); l++) {
+        uint32_t n = lengths[l];
+        if (n > BENCH_MAX_WORKERS) {
+            continue;
+        }
+
+        if (_start(1u, 0u) != 0) {
+            _check(0, "dispatch");
+            return;
+        }
+        _addWorkers(n, 1u);
+        _sleepMs(20u);
+
+        uint64_t runs0 = _totalRuns(n);
+        uint64_t t0 = _nowNs();
+        _sleepMs(duration);
+        uint64_t runs = _totalRuns(n) - runs0;
+        uint64_t elapsed = _nowNs() - t0;
+        workerManager_end();
+
+        _check(runs >= n, "dispatch");
+        fprintf(_out, "{\"bench\":\"dispatch\",\"workers\":%u,\"runs\":%llu,\"ns_per_run\":%.1f,\"runs_per_s\":%.0f}\n",
+                n, (unsigned long long)runs, (runs != 0u) ? ((double)elapsed / (double)runs) : 0.0,
+                (double)runs * 1e9 / (double)elapsed);
+    }
+}
+
+/**
+ * @brief Latency of workerManager_addWorker() / removeWorker() while the
+ *        level is busy, and of the first run after an add.
+ */
+static void _benchAddRemove(void) {
+    uint32_t load = (BENCH_MAX_WORKERS > 65u) ? 64u : (BENCH_MAX_WORKERS - 1u);
+    uint32_t iterations = _quick ? 200u : BENCH_MAX_SAMPLES;
+    static uint64_t addNs[BENCH_MAX_SAMPLES];
+    static uint64_t removeNs[BENCH_MAX_SAMPLES];
+    static uint64_t firstRunNs[BENCH_MAX_SAMPLES];
+    uint32_t firstRuns = 0;
+
+    if (_start(1u, 0u) != 0) {
+        _check(0, "add_remove");
+        return;
+    }
+    _addWorkers(load, 1u);
+    _sleepMs(20u);
+
+    worker_t *probe = _workers[load];
+    benchCounter_t *counter = &_counters[load];
+    probe->run.handler = _count;
+    probe->run.args = counter;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint64_t runs = __atomic_load_n(&counter->runs, __ATOMIC_RELAXED);
+        uint64_t t0 = _nowNs();
+        workerManager_addWorker(probe, 0);
+        uint64_t t1 = _nowNs();
+        addNs[i] = t1 - t0;
+
+        /* First run, bounded so that a slow machine cannot hang the bench. */
+        while ((__atomic_load_n(&counter->runs, __ATOMIC_RELAXED) == runs) && ((_nowNs() - t1) < 100000000ull)) {
+            usleep(10);
+        }
+        if (__atomic_load_n(&counter->runs, __ATOMIC_RELAXED) != runs) {
+            firstRunNs[firstRuns++] = __atomic_load_n(&counter->lastRun, __ATOMIC_RELAXED) - t1;
+        }
+
+        t0 = _nowNs();
+        workerManager_removeWorker(probe);
+        removeNs[i] = _nowNs() - t0;
+        _check(workerManager_waitWorker(probe, 1000000u) == 0, "add_remove");
+    }
+    workerManager_end();
+
+    _check(firstRuns == iterations, "add_remove");
+    fprintf(_out, "{\"bench\":\"add_remove\",\"load_workers\":%u,\"iterations\":%u,"
+            "\"add_p50_ns\":%llu,\"add_p99_ns\":%llu,\"remove_p50_ns\":%llu,\"remove_p99_ns\":%llu,"
+            "\"first_run_p50_ns\":%llu,\"first_run_p99_ns\":%llu}\n",
+            load, iterations,
+            (unsigned long long)_percentile(addNs, iterations, 500u),
+            (unsigned long long)_percentile(addNs, iterations, 990u),
+            (unsigned long long)_percentile(removeNs, iterations, 500u),
+            (unsigned long long)_percentile(removeNs, iterations, 990u),
+            (unsigned long long)_percentile(firstRunNs, firstRuns, 500u),
+            (unsigned long long)_percentile(firstRunNs, firstRuns, 990u));
+}
+
+/**
+ * @brief Deviation of the interval between two runs from the sleep time.
+ */
+static void _benchJitter(void) {
+    static const uint32_t sleepTimes[] = { 100u, 1000u, 10000u };
+    static const uint8_t policies[] = { WORKERMANAGER_IDLE_BLOCK, WORKERMANAGER_IDLE_SPIN, WORKERMANAGER_IDLE_ADAPTIVE };
+    static const char *const policyNames[] = { "block", "spin", "adaptive" };
+    uint32_t duration = _quick ? 100000u : 1000000u;
+
+    for (uint32_t p = 0; p < (sizeof(policies) / sizeof(policies[0])); p++) {
+        for (uint32_t s = 0; s < (sizeof(sleepTimes) / sizeof(sleepTimes[0])); s++) {
+            uint32_t sleepTime = sleepTimes[s];
+            uint32_t wanted = duration / sleepTime;
+            uint32_t count = 0;
+            uint64_t last = 0;
+
+            if (wanted > BENCH_MAX_SAMPLES) {
+                wanted = BENCH_MAX_SAMPLES;
+            }
+            if (_start(1u, sleepTime) != 0) {
+                _check(0, "jitter");
+                return;
+            }
+            workerManager_setPriorityListIdlePolicy(0, (workerManagerIdlePolicy_t)policies[p]);
+            _addWorkers(1u, 1u);
+
+            uint64_t runs = 0;
+            uint64_t deadline = _nowNs() + ((uint64_t)duration * 3000ull);
+            while ((count < wanted) && (_nowNs() < deadline)) {
+                uint64_t now = __atomic_load_n(&_counters[0].runs, __ATOMIC_RELAXED);
+                if (now != runs) {
+                    uint64_t at = __atomic_load_n(&_counters[0].lastRun, __ATOMIC_RELAXED);
+                    /* Only consecutive runs give an interval. */
+                    if ((last != 0u) && (now == (runs + 1u))) {
+                        uint64_t interval = at - last;
+                        uint64_t target = (uint64_t)sleepTime * 1000ull;
+                        _samples[count++] = (interval > target) ? (interval - target) : (target - interval);
+                    }
+                    runs = now;
+                    last = at;
+                }
+                usleep(sleepTime / 4u);
+            }
+            workerManager_end();
+
+            _check(count != 0u, "jitter");
+            uint64_t sum = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                sum += _samples[i];
+            }
+            fprintf(_out, "{\"bench\":\"jitter\",\"policy\":\"%s\",\"sleep_us\":%u,\"samples\":%u,"
+                    "\"mean_ns\":%llu,\"p50_ns\":%llu,\"p99_ns\":%llu,\"max_ns\":%llu}\n",
+                    policyNames[policies[p]], sleepTime, count,
+                    (unsigned long long)((count != 0u) ? (sum / count) : 0u),
+                    (unsigned long long)_percentile(_samples, count, 500u),
+                    (unsigned long long)_percentile(_samples, count, 990u),
+                    (unsigned long long)_percentile(_samples, count, 1000u));
+        }
+    }
+}
+
+/**
+ * @brief Time taken by workerManager_initEx() and workerManager_end().
+ */
+static void _benchStartStop(void) {
+    uint32_t iterations = _quick ? 20u : 200u;
+    static uint64_t initNs[BENCH_MAX_SAMPLES];
+    static uint64_t endNs[BENCH_MAX_SAMPLES];
+    uint8_t nLevels = (_levels < WORKERMANAGER_PRIORITY_NUM) ? _levels : WORKERMANAGER_PRIORITY_NUM;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint64_t t0 = _nowNs();
+        int rc = _start(nLevels, 1000u);
+        uint64_t t1 = _nowNs();
+        workerManager_end();
+        uint64_t t2 = _nowNs();
+
+        _check(rc == 0, "start_stop");
+        initNs[i] = t1 - t0;
+        endNs[i] = t2 - t1;
+    }
+
+    fprintf(_out, "{\"bench\":\"start_stop\",\"levels\":%u,\"iterations\":%u,"
+            "\"init_p50_ns\":%llu,\"init_max_ns\":%llu,\"end_p50_ns\":%llu,\"end_max_ns\":%llu}\n",
+            nLevels, iterations,
+            (unsigned long long)_percentile(initNs, iterations, 500u),
+            (unsigned long long)_percentile(initNs, iterations, 1000u),
+            (unsigned long long)_percentile(endNs, iterations, 500u),
+            (unsigned long long)_percentile(endNs, iterations, 1000u));
+}
+
+/**
+ * @brief Total runs per second with 1 to N levels, each one busy with
+ *        BENCH_WORKERS_PER_LEVEL workers.
+ */
+static void _benchThroughput(void) {
+    uint32_t duration = _quick ? 100u : 1000u;
+    uint8_t maxLevels = (_levels < WORKERMANAGER_PRIORITY_NUM) ? _levels : WORKERMANAGER_PRIORITY_NUM;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (uint8_t nLevels = 1; nLevels <= maxLevels; nLevels++) {
+        uint32_t n = nLevels * BENCH_WORKERS_PER_LEVEL;
+        if (n > BENCH_MAX_WORKERS) {
+            break;
+        }
+
+        if (_start(nLevels, 0u) != 0) {
+            _check(0, "throughput");
+            return;
+        }
+        _addWorkers(n, nLevels);
+        _sleepMs(20u);
+
+        uint64_t runs0 = _totalRuns(n);
+        uint64_t t0 = _nowNs();
+        _sleepMs(duration);
+        uint64_t runs = _totalRuns(n) - runs0;
+        uint64_t elapsed = _nowNs() - t0;
+        workerManager_end();
+
+        _check(runs >= n, "throughput");
+        fprintf(_out, "{\"bench\":\"throughput\",\"levels\":%u,\"workers\":%u,\"cpus\":%ld,\"runs_per_s\":%.0f}\n",
+                nLevels, n, cpus, (double)runs * 1e9 / (double)elapsed);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            _quick = 1;
+        } else if ((strcmp(argv[i], "--levels") == 0) && ((i + 1) < argc)) {
+            _levels = (uint8_t)atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "--out") == 0) && ((i + 1) < argc)) {
+            path = argv[++i];
+        } else {
+            printf("usage: %s [--quick] [--levels N] [--out FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (_levels == 0u) {
+        _levels = 1;
+    }
+
+    _out = stdout;
+    if ((path != NULL) && ((_out = fopen(path, "w")) == NULL)) {
+        fprintf(stderr, "Error: unable to open %s\n", path);
+        return 2;
+    }
+
+    for (uint32_t i = 0; i < BENCH_MAX_WORKERS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "bench%u", i);
+        worker_makeWorker(name, &_workers[i]);
+        if (_workers[i] == NULL) {
+            fprintf(stderr, "Error: unable to create the bench workers\n");
+            return 1;
+        }
+    }
+
+    _benchDispatch();
+    _benchAddRemove();
+    _benchJitter();
+    _benchStartStop();
+    _benchThroughput();
+
+    if (_out != stdout) {
+        fclose(_out);
+    }
+    return (_failures == 0) ? 0 : 1;
+}
@@ -23,6 +23,8 @@
  #define __WORKER_H__
  
  #include <stdint.h>
+
+ #include "workerStats.h"
  
  #ifdef __cplusplus
  extern "C" {
@@ -36,21 +38,47 @@
  
  /**
   * @def WORKER_STATUS_IDLE
-  * @brief Status constant indicating the worker is idle.
+  * @brief Status constant indicating the worker is idle (stopped, never dispatched).
   */
  #define WORKER_STATUS_IDLE         0u
  
  /**
   * @def WORKER_STATUS_ACTIVE
-  * @brief Status constant indicating the worker is active.
+  * @brief Status constant indicating the worker is active (started).
   */
  #define WORKER_STATUS_ACTIVE       1u
+
+ /**
+  * @def WORKER_MAX_SUCCESSORS
+  * @brief Maximum number of workers depending on one worker.
+  */
+ #ifndef WORKER_MAX_SUCCESSORS
+ #define WORKER_MAX_SUCCESSORS      8u
+ #endif
+
+ /**
+  * @def WORKER_MAX_PREDECESSORS
+  * @brief Maximum number of workers one worker can depend on (bits of the ready mask).
+  */
+ #define WORKER_MAX_PREDECESSORS    32u
+
+ /**
+  * @def WORKER_MAX_FDS
+  * @brief Maximum number of file descriptors watched for one worker.
+  */
+ #ifndef WORKER_MAX_FDS
+ #define WORKER_MAX_FDS             4u
+ #endif
  
  /**
   * @brief Structure representing a worker with metadata and function handlers.
   *
   * A worker is an executable unit that may define three optional phases:
   * `init`, `run`, and `end`, each with its own function pointer and arguments.
+  *
+  * The manager copies run.handler, run.args, schedule.period and
+  * watchdog.budget into its dispatch table when the worker is started;
+  * stop and start the worker to change them.
   */
  typedef struct {
      /**
@@ -58,7 +86,8 @@
       */
      struct {
          char name[WORKER_NAME_MAX_LEN]; /**< Worker name identifier. */
-         uint8_t status;                 /**< Worker execution status. */
+         uint8_t status;                 /**< WORKER_STATUS_IDLE or WORKER_STATUS_ACTIVE (atomic, set by the manager). */
+         uint8_t priority;               /**< Priority list owning the worker (set by the manager). */
      } metadata;
  
      /**
@@ -84,14 +113,100 @@
          void (*handler)(void *args);    /**< Pointer to end function. */
          void *args;                     /**< Argument for end function. */
      } end;
+
+     /**
+      * @brief Periodic activation parameters.
+      *
+      * With a non-zero period the worker is dispatched on absolute
+      * CLOCK_MONOTONIC deadlines epoch + phase + k * period, independently
+      * of the priority list sleep time and of the other workers' run time.
+      * With period 0 the worker runs once per list cycle.
+      */
+     struct {
+         uint32_t period;                /**< Activation period in µs, 0 = every list cycle. */
+         uint32_t phase;                 /**< Offset of the first activation from the manager start, in µs. */
+         uint64_t nextDeadline;          /**< Next activation time in ns (managed internally). */
+         uint8_t notified;               /**< Pending notification flag (managed internally). */
+     } schedule;
+
+     /**
+      * @brief Run time supervision (see workerManagerWatchdogConfig_t).
+      */
+     struct {
+         uint32_t budget;                /**< Expected maximum run duration in µs, 0 = unbounded. */
+         uint32_t skip;                  /**< Activations left to skip after an overrun (managed internally). */
+         uint64_t runStart;              /**< Start of the run in progress in ns, 0 = idle (managed internally). */
+         uint64_t reportedStart;         /**< Run already reported as stuck (managed internally). */
+     } watchdog;
+
+     /**
+      * @brief Start/stop bookkeeping (managed internally).
+      *
+      * start/stop only record the requested status; the priority thread
+      * applies it, running init/end and updating the dispatch set.
+      */
+     struct {
+         void *next;                     /**< Link in the level's lifecycle queue. */
+         uint8_t queued;                 /**< Set while in the lifecycle queue. */
+         uint8_t registered;             /**< Set while added to a priority level. */
+         uint8_t initialized;            /**< init ran and end has not run yet. */
+         uint8_t dispatched;             /**< Part of the dispatch set. */
+         uint8_t isolated;               /**< Still run by a thread the watchdog isolated. */
+         uint32_t requestSeq;            /**< Bumped by every start/stop/add/remove. */
+         uint32_t appliedSeq;            /**< Last requestSeq applied by the priority thread. */
+     } lifecycle;
+
+     /**
+      * @brief Dataflow edges (see workerManager_addDependency(), managed internally).
+      *
+      * A worker with predecessors only runs when every one of them has
+      * completed a run since its own last trigger.
+      */
+     struct {
+         void *successor[WORKER_MAX_SUCCESSORS];      /**< Workers triggered by this one (worker_t *). */
+         uint32_t successorBit[WORKER_MAX_SUCCESSORS]; /**< Bit of this worker in each successor's readyMask. */
+         uint8_t successorCount;         /**< Valid entries in successor (atomic). */
+         uint8_t predecessorCount;       /**< Number of workers this one depends on (atomic). */
+         uint32_t readyMask;             /**< Predecessors completed since the last trigger (atomic). */
+     } dependency;
+
+     /**
+      * @brief Coroutine execution (see workerManager_yield()).
+      *
+      * Set enabled before adding the worker to run its handler on a pooled
+      * stack of its own, so that it can yield to its siblings.
+      */
+     struct {
+         uint8_t enabled;                /**< Run the handler as a coroutine. */
+         void *context;                  /**< Suspended run, NULL between runs (managed internally). */
+         uint64_t runStart;              /**< Start of the suspended run in ns (managed internally). */
+         uint64_t runScheduled;          /**< Time the suspended run was due at in ns (managed internally). */
+         uint64_t runTime;               /**< Time spent in its slices so far in ns (managed internally). */
+     } coroutine;
+
+     /**
+      * @brief Watched file descriptors (see workerManager_addWorkerFd(), managed internally).
+      */
+     struct {
+         int fd[WORKER_MAX_FDS];         /**< Descriptors that trigger a run when ready. */
+         uint32_t events[WORKER_MAX_FDS]; /**< epoll event mask of each descriptor. */
+         uint8_t count;                  /**< Valid entries in fd. */
+         uint8_t armed;                  /**< Descriptors are in the level's epoll set. */
+     } io;
+
+     workerStats_t *stats;               /**< Runtime statistics, NULL without WORKERMANAGER_STATS (managed internally). */
  
  } worker_t;
  
  /**
   * @brief Creates a new worker instance and initializes it with a name.
   *
+  * With WORKERMANAGER_STATIC_POOLS the worker comes from a fixed pool of
+  * WORKERMANAGER_MAX_WORKERS instead of the heap. With WORKERMANAGER_STATS
+  * its statistics are allocated in the same block.
+  *
   * @param name Null-terminated string to name the worker.
-  * @param worker Pointer to a pointer that will receive the allocated worker.
+  * @param worker Pointer to a pointer that will receive the allocated worker, NULL on failure.
   */
  void worker_makeWorker(char *name, worker_t **worker);
  
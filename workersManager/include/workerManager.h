@@ -15,21 +15,224 @@
  #ifndef WORKER_MANAGER_H
  #define WORKER_MANAGER_H
  
+ #include <stddef.h>
  #include <stdint.h>
 
   #include "worker.h"
+ #include "workerStats.h"
  
  #ifdef __cplusplus
  extern "C" {
  #endif
+
+ /**
+  * @def WORKERMANAGER_SLEEP_FOREVER
+  * @brief Sleep time value making a priority thread wait for notifications only.
+  */
+ #define WORKERMANAGER_SLEEP_FOREVER    UINT32_MAX
+
+ /**
+  * @def WORKERMANAGER_PRIORITY_NUM
+  * @brief Maximum number of priority levels (compile-time capacity).
+  */
+ #ifndef WORKERMANAGER_PRIORITY_NUM
+ #define WORKERMANAGER_PRIORITY_NUM     10u
+ #endif
+
+ /**
+  * @def WORKERMANAGER_EXECUTOR_AUTO
+  * @brief executorThreads value sizing the executor pool to the online CPU count.
+  */
+ #define WORKERMANAGER_EXECUTOR_AUTO    UINT16_MAX
+
+ /**
+  * @def WORKERMANAGER_TASK_POOL_SIZE
+  * @brief Number of one-shot tasks that can be in flight at the same time.
+  */
+ #ifndef WORKERMANAGER_TASK_POOL_SIZE
+ #define WORKERMANAGER_TASK_POOL_SIZE   1024u
+ #endif
+
+ /**
+  * @def WORKERMANAGER_STATIC_POOLS
+  * @brief Set to 1 to take every manager object from fixed, statically sized pools.
+  *
+  * Workers, list nodes, thread bookkeeping, list snapshots, epoll state,
+  * executor threads and coroutine stacks then come from static storage
+  * sized by the limits below, and the manager never calls the heap.
+  * Running out of a pool is reported like an allocation failure. The
+  * library and the application must agree on the limits.
+  */
+ #ifndef WORKERMANAGER_STATIC_POOLS
+ #define WORKERMANAGER_STATIC_POOLS     0
+ #endif
+
+ /**
+  * @def WORKERMANAGER_MAX_WORKERS
+  * @brief Workers that can exist at the same time with WORKERMANAGER_STATIC_POOLS.
+  */
+ #ifndef WORKERMANAGER_MAX_WORKERS
+ #define WORKERMANAGER_MAX_WORKERS      64u
+ #endif
+
+ /**
+  * @def WORKERMANAGER_SNAPSHOT_POOL_SIZE
+  * @brief List snapshots (published plus retired) with WORKERMANAGER_STATIC_POOLS.
+  *
+  * Each one holds up to WORKERMANAGER_MAX_WORKERS entries. A level needs
+  * one, plus one per change made while its thread is in the middle of a pass.
+  */
+ #ifndef WORKERMANAGER_SNAPSHOT_POOL_SIZE
+ #define WORKERMANAGER_SNAPSHOT_POOL_SIZE  (3u * WORKERMANAGER_PRIORITY_NUM)
+ #endif
+
+ /**
+  * @def WORKERMANAGER_MAX_EXECUTOR_THREADS
+  * @brief Largest executor pool with WORKERMANAGER_STATIC_POOLS.
+  */
+ #ifndef WORKERMANAGER_MAX_EXECUTOR_THREADS
+ #define WORKERMANAGER_MAX_EXECUTOR_THREADS  8u
+ #endif
+
+ /**
+  * @brief One-shot task function.
+  */
+ typedef void (*workerTaskFn_t)(void *arg);
+
+ /**
+  * @brief Completion handle of a task submitted with workerManager_submit().
+  *
+  * A handle is a plain value: it can be copied freely and stays valid after
+  * the task completed and its pooled object was reused.
+  */
+ typedef struct {
+     void *task;                        /**< Pooled task object, NULL if the submission failed. */
+     uint32_t seq;                      /**< Sequence the task had when submitted. */
+ } workerTaskHandle_t;
+
+ /**
+  * @brief When the thread of a priority level is created.
+  */
+ typedef enum {
+     WORKERMANAGER_THREAD_EAGER = 0,    /**< Created by workerManager_initEx(). */
+     WORKERMANAGER_THREAD_LAZY,         /**< Created on the first workerManager_addWorker(). */
+     WORKERMANAGER_THREAD_DISABLED      /**< Never created, adding workers fails. */
+ } workerManagerThreadMode_t;
+
+ /**
+  * @brief How the thread of a priority level waits when it has nothing to run.
+  */
+ typedef enum {
+     WORKERMANAGER_IDLE_BLOCK = 0,      /**< Sleep in the kernel until notified or due. */
+     WORKERMANAGER_IDLE_SPIN,           /**< Busy-poll with CPU pause hints, never sleep. */
+     WORKERMANAGER_IDLE_ADAPTIVE        /**< Spin, then yield, then block; the spin adapts to recent activity. */
+ } workerManagerIdlePolicy_t;
+
+ /**
+  * @brief Events reported to the watchdog callback.
+  */
+ typedef enum {
+     WORKERMANAGER_EVENT_OVERRUN = 0,   /**< A run completed after exceeding the worker budget. */
+     WORKERMANAGER_EVENT_STUCK,         /**< A run is still in progress after the stuck timeout. */
+     WORKERMANAGER_EVENT_ISOLATED,      /**< A stuck worker was taken out of its level, moved to a new thread; the stuck run still uses it. */
+     WORKERMANAGER_EVENT_RECOVERED,     /**< The stuck run of an isolated worker returned; its end handler follows on the level thread. */
+     WORKERMANAGER_EVENT_JOIN_TIMEOUT   /**< A thread did not stop within the join timeout. */
+ } workerManagerEvent_t;
+
+ /**
+  * @brief What the watchdog does with a stuck worker.
+  *
+  * An isolated worker is still in use: the stuck thread keeps running it,
+  * then the level thread runs its end handler. It must stay allocated until
+  * workerManager_waitWorker() returns 0 for it; only then may it be freed
+  * or added again.
+  */
+ typedef enum {
+     WORKERMANAGER_WATCHDOG_REPORT = 0, /**< Report only. */
+     WORKERMANAGER_WATCHDOG_ISOLATE     /**< Remove the worker and restart its level on a new thread. */
+ } workerManagerWatchdogAction_t;
+
+ /**
+  * @brief Watchdog event callback.
+  *
+  * @param event One of workerManagerEvent_t.
+  * @param worker Worker concerned, NULL if unknown (executor or idle thread).
+  * @param elapsed Duration of the run in ns, 0 if unknown.
+  * @param arg User argument from the configuration.
+  */
+ typedef void (*workerManagerWatchdogFn_t)(uint8_t event, worker_t *worker, uint64_t elapsed, void *arg);
+
+ /**
+  * @brief Run time supervision settings.
+  */
+ typedef struct {
+     uint32_t checkPeriod;              /**< Watchdog scan period in µs, 0 = no watchdog thread. */
+     uint32_t stuckTimeout;             /**< Run duration in µs after which a worker is stuck, 0 = never. */
+     uint8_t action;                    /**< One of workerManagerWatchdogAction_t, applied to stuck workers. */
+     uint32_t overrunSkip;              /**< Activations skipped after a budget overrun, 0 = none. */
+     uint32_t joinTimeout;              /**< Maximum wait per thread in workerManager_end() in µs, 0 = unbounded. */
+     workerManagerWatchdogFn_t callback; /**< Event callback, NULL = print to stdout. */
+     void *callbackArg;                 /**< Argument passed to callback. */
+ } workerManagerWatchdogConfig_t;
+
+ /**
+  * @brief Thread configuration of a single priority level.
+  */
+ typedef struct {
+     uint8_t threadMode;                /**< One of workerManagerThreadMode_t. */
+     uint64_t cpuAffinity;              /**< Bit n pins the thread on CPU n, 0 = inherit. */
+     int schedPolicy;                   /**< SCHED_OTHER, SCHED_FIFO or SCHED_RR. */
+     int schedPriority;                 /**< Static priority for SCHED_FIFO/SCHED_RR. */
+     uint32_t sleepTime;                /**< Initial list sleep time in µs. */
+     uint8_t useExecutor;               /**< 1 = run the due workers on the executor pool. */
+     uint8_t idlePolicy;                /**< One of workerManagerIdlePolicy_t. */
+ } workerManagerPriorityConfig_t;
+
+ /**
+  * @brief Worker manager configuration for workerManager_initEx().
+  */
+ typedef struct {
+     uint8_t priorityNum;               /**< Priority levels in use [1 - WORKERMANAGER_PRIORITY_NUM]. */
+     size_t stackSize;                  /**< Stack size of every thread in bytes, 0 = default. */
+     uint16_t executorThreads;          /**< Executor pool size, 0 = no pool, WORKERMANAGER_EXECUTOR_AUTO = one per CPU. */
+     workerManagerPriorityConfig_t priority[WORKERMANAGER_PRIORITY_NUM]; /**< Per level settings. */
+     workerManagerWatchdogConfig_t watchdog; /**< Overrun and stuck worker supervision. */
+ } workerManagerConfig_t;
+
+ /**
+  * @brief Fill a configuration with the defaults used by workerManager_init().
+  *
+  * Defaults: every level enabled with an eager thread, SCHED_OTHER, no
+  * affinity, default stack size, a 100ms sleep time and no executor pool.
+  * 
+  * @param config Configuration to fill.
+  */
+ void workerManager_getDefaultConfig(workerManagerConfig_t *config);
  
  /**
   * @brief Initialize the worker manager and start priority threads.
   */
  void workerManager_init(void);
+
+ /**
+  * @brief Initialize the worker manager with an explicit configuration.
+  *
+  * If a real-time policy or CPU affinity is refused by the system (e.g.
+  * missing CAP_SYS_NICE) a warning is printed and the thread is started
+  * with default attributes.
+  * 
+  * @param config Configuration, usually prepared with workerManager_getDefaultConfig().
+  * @return 0 on success, -1 if the configuration is invalid.
+  */
+ int workerManager_initEx(const workerManagerConfig_t *config);
  
  /**
-  * @brief Add a worker to a given priority level.
+  * @brief Add a worker to a given priority level and start it.
+  *
+  * The priority thread dispatches from an immutable snapshot of the list,
+  * so this call never waits for running handlers and may be issued from
+  * inside a handler. The init handler runs on the priority thread before
+  * the first run (see workerManager_startWorker()).
   * 
   * @param worker Pointer to the worker definition.
   * @param prio Priority index [0 - N). Lower index = higher priority.
@@ -38,6 +241,13 @@
  
  /**
   * @brief Remove a worker from any priority level.
+  *
+  * Waits until the priority thread has taken the worker out: no run of it
+  * is in progress and its end handler (if it was started) has run, so the
+  * worker may be freed on return. Called from a handler or task of the
+  * same level, or from a pool thread running one of its workers, it only
+  * queues the removal and returns; wait for it with
+  * workerManager_waitWorker() from another thread before freeing.
   * 
   * @param worker Pointer to the worker to remove.
   */
@@ -45,30 +255,284 @@
  
  /**
   * @brief Stop all worker threads and cleanup resources.
+  *
+  * With a non-zero watchdog.joinTimeout a thread still stuck in a handler
+  * after that delay is reported with WORKERMANAGER_EVENT_JOIN_TIMEOUT and
+  * detached. Its level's resources are then leaked on purpose, and the
+  * workers it still references must stay valid. Tasks submitted while the
+  * manager stops and never run are cancelled, so no taskWait() hangs.
   */
  void workerManager_end(void);
  
  /**
-  * @brief [Optional] Start a single worker manually (future expansion).
+  * @brief Resume a stopped worker.
+  *
+  * The status becomes WORKER_STATUS_ACTIVE immediately; the priority thread
+  * then runs the init handler and puts the worker back in its dispatch
+  * set. init and end always alternate: a worker stopped and restarted
+  * before the priority thread noticed runs neither.
   * 
-  * @param worker Worker to start.
+  * @param worker Worker previously added with workerManager_addWorker().
   */
  void workerManager_startWorker(worker_t *worker);
  
  /**
-  * @brief [Optional] Stop a single worker manually (future expansion).
+  * @brief Pause a worker without removing it from its level.
+  *
+  * The worker leaves the dispatch set immediately, so a paused worker costs
+  * nothing per cycle. A run in progress completes, then the priority thread
+  * runs the end handler. The status becomes WORKER_STATUS_IDLE immediately.
   * 
-  * @param worker Worker to stop.
+  * @param worker Worker previously added with workerManager_addWorker().
   */
  void workerManager_stopWorker(worker_t *worker);
 
+ /**
+  * @brief Wait until the priority thread applied the last add, remove,
+  *        start or stop of a worker (init/end handlers included).
+  *
+  * Must not be called from the thread of the worker's priority level. For a
+  * worker isolated by the watchdog, returns once its stuck run returned and
+  * its end handler ran: the manager no longer uses it.
+  * 
+  * @param worker Worker to wait for.
+  * @param timeout Maximum wait in µs, WORKERMANAGER_SLEEP_FOREVER = no limit.
+  * @return 0 once applied, -1 on timeout.
+  */
+ int workerManager_waitWorker(worker_t *worker, uint32_t timeout);
+
+ /**
+  * @brief Make a worker run after another one completes.
+  *
+  * A worker with dependencies no longer follows its period or the list
+  * cycle: it runs as soon as each of its predecessors has completed a run
+  * since its previous trigger (fan-in), on its own priority thread.
+  * A worker may feed several successors (fan-out); branches on different
+  * levels, or on an executor level, run in parallel. Workers without
+  * predecessors start the pipeline on their own schedule or through
+  * workerManager_notify().
+  *
+  * Edges are permanent; remove a successor only once its predecessors
+  * are removed.
+  *
+  * @param worker Worker to trigger.
+  * @param dependsOn Worker whose completion it waits for.
+  * @return 0 on success, -1 on a cycle, a duplicate edge or a full edge table.
+  */
+ int workerManager_addDependency(worker_t *worker, worker_t *dependsOn);
+
+ /**
+  * @brief Run a worker whenever a file descriptor becomes ready (Linux only).
+  *
+  * The first descriptor registered on a level switches its thread from a
+  * condition variable to epoll: it then blocks until a descriptor is
+  * ready, a notification arrives or the next periodic deadline, tracked by
+  * a timerfd, expires, and only dispatches the workers whose descriptors
+  * are ready. Readiness is level-triggered: the run handler should drain
+  * the descriptor, which is best opened non-blocking.
+  *
+  * Descriptors are watched while the worker is started and may be
+  * registered before the worker is added. Remove a descriptor before
+  * closing it.
+  *
+  * @param worker Worker to run.
+  * @param fd Descriptor to watch.
+  * @param events epoll event mask, e.g. EPOLLIN.
+  * @return 0 on success, -1 if the table is full, fd is already watched or epoll fails.
+  */
+ int workerManager_addWorkerFd(worker_t *worker, int fd, uint32_t events);
+
+ /**
+  * @brief Suspend the calling coroutine worker until its next activation.
+  *
+  * Only has an effect inside the run handler of a worker with
+  * coroutine.enabled set; returns immediately anywhere else. The handler
+  * resumes right after the call the next time the worker is due: next
+  * cycle, next period, notification or ready descriptor. Meanwhile its
+  * siblings run. The run only counts as complete (dependencies, end of
+  * a stop) when the handler returns; stopping or removing the worker
+  * drops a suspended run without unwinding it.
+  *
+  * In executor mode the handler may resume on another pool thread.
+  */
+ void workerManager_yield(void);
+
+ /**
+  * @brief Stop watching a descriptor registered with workerManager_addWorkerFd().
+  *
+  * @param worker Worker owning the descriptor.
+  * @param fd Descriptor to forget.
+  * @return 0 on success, -1 if fd is not watched for this worker.
+  */
+ int workerManager_removeWorkerFd(worker_t *worker, int fd);
+
  /**
   * @brief Set the sleep time for the specific priority list.
   * 
+  * The sleep time only paces workers without a period (see
+  * worker_t::schedule); periodic workers are dispatched on their own
+  * deadlines. The thread waits at most sleepTime µs after each cycle; a call to
+  * workerManager_notify() or workerManager_notifyPriority() ends the wait
+  * early. Use WORKERMANAGER_SLEEP_FOREVER to run only when notified. A new
+  * sleep time applies to the current wait, counted from the end of the last
+  * cycle; it does not start a cycle by itself.
+  * 
   * @param prio Priority index [0 - N).
   * @param sleepTime time in usec that the task sleeping every cycle.
   */
   void workerManager_setPriorityListSleepTime(uint8_t prio, uint32_t sleepTime);
+
+ /**
+  * @brief Set how the thread of a priority list waits between cycles.
+  *
+  * WORKERMANAGER_IDLE_SPIN keeps the thread on its CPU polling for
+  * notifications and deadlines, for the lowest wake-up latency at the cost
+  * of a busy core. WORKERMANAGER_IDLE_ADAPTIVE spins for a while, yields,
+  * then blocks; the spin grows when work keeps arriving during it and
+  * shrinks when the thread ends up blocking. WORKERMANAGER_IDLE_BLOCK (the
+  * default) always sleeps in the kernel. The sleep time and the deadlines
+  * of periodic workers apply with every policy.
+  *
+  * @param prio Priority index [0 - N).
+  * @param policy One of workerManagerIdlePolicy_t.
+  */
+ void workerManager_setPriorityListIdlePolicy(uint8_t prio, workerManagerIdlePolicy_t policy);
+
+ /**
+  * @brief Wake the priority thread owning the worker so it runs the worker now.
+  *
+  * Only the notified worker is dispatched, periodic workers keep their
+  * deadlines. Safe to call from any thread, including from a worker
+  * handler. A notification arriving while the worker is running triggers
+  * another run as soon as the current cycle completes. Notifications sent
+  * while the worker is stopped or out of its level are dropped when it is
+  * started or added again.
+  * 
+  * @param worker Worker previously added with workerManager_addWorker().
+  */
+ void workerManager_notify(worker_t *worker);
+
+ /**
+  * @brief workerManager_notify() with a generic signature.
+  *
+  * Matches ringBufferNotify_t, so a ring can wake its consumer worker
+  * when data arrives:
+  * ringBufferSpsc_setNotify(&ring, workerManager_notifyHook, consumer).
+  *
+  * @param worker Worker previously added with workerManager_addWorker().
+  */
+ void workerManager_notifyHook(void *worker);
+
+ /**
+  * @brief Wake the thread of a priority list so it runs a cycle now.
+  *
+  * Every worker without a period runs; periodic workers keep their deadlines.
+  * 
+  * @param prio Priority index [0 - N).
+  */
+ void workerManager_notifyPriority(uint8_t prio);
+
+ /**
+  * @brief Submit a one-shot task to the thread of a priority level.
+  *
+  * The task object comes from a fixed pool of WORKERMANAGER_TASK_POOL_SIZE
+  * entries, no memory is allocated. Queued tasks run in submission order at
+  * the start of the next cycle of the level, before its workers. A task
+  * still queued when workerManager_end() has stopped the level is cancelled:
+  * it never runs and its handle reports a failure.
+  * 
+  * @param handler Function to run.
+  * @param arg Argument passed to handler.
+  * @param prio Priority index [0 - N).
+  * @return Completion handle; handle.task is NULL if the pool is exhausted,
+  *         the level is invalid or the manager is not running.
+  */
+ workerTaskHandle_t workerManager_submit(workerTaskFn_t handler, void *arg, uint8_t prio);
+
+ /**
+  * @brief Check whether a submitted task has completed.
+  * 
+  * @param handle Handle returned by workerManager_submit().
+  * @return 1 if completed, 0 if still pending, -1 for an empty handle
+  *         (the submission failed) or a task cancelled by workerManager_end().
+  */
+ int workerManager_taskPoll(workerTaskHandle_t handle);
+
+ /**
+  * @brief Wait for a submitted task to complete.
+  *
+  * Must not be called from the thread the task was submitted to.
+  * 
+  * @param handle Handle returned by workerManager_submit().
+  * @param timeout Maximum wait in µs, WORKERMANAGER_SLEEP_FOREVER = no limit.
+  * @return 0 once completed, -1 on timeout, for an empty handle or a
+  *         cancelled task.
+  */
+ int workerManager_taskWait(workerTaskHandle_t handle, uint32_t timeout);
+
+ /**
+  * @brief Attach a continuation to a submitted task.
+  *
+  * The continuation runs on the priority thread right after the task. If
+  * the task has already completed it runs immediately on the caller. An
+  * empty handle (failed submission) or a cancelled task never runs the
+  * continuation.
+  * 
+  * @param handle Handle returned by workerManager_submit().
+  * @param handler Continuation function.
+  * @param arg Argument passed to handler.
+  * @return 0 on success, -1 if a continuation is already attached, the
+  *         handle is empty or the task was cancelled.
+  */
+ int workerManager_taskThen(workerTaskHandle_t handle, workerTaskFn_t handler, void *arg);
+
+ /**
+  * @brief Copy the runtime statistics of a worker.
+  *
+  * Requires the library built with WORKERMANAGER_STATS=1 and a worker made
+  * with worker_makeWorker(). A coroutine run is counted once it completes,
+  * with the time of all its slices.
+  * 
+  * @param worker Worker to query.
+  * @param stats Receives the statistics.
+  * @return 0 on success, -1 if statistics are compiled out, the worker has
+  *         none or an argument is NULL.
+  */
+ int workerManager_getStats(const worker_t *worker, workerStats_t *stats);
+
+ /**
+  * @brief Clear the runtime statistics of a worker.
+  * 
+  * @param worker Worker to reset.
+  */
+ void workerManager_resetStats(worker_t *worker);
+
+ /**
+  * @brief Print the statistics of every registered worker on stdout.
+  */
+ void workerManager_dumpStats(void);
+
+ /**
+  * @brief Pause (0) or resume (1) execution tracing.
+  *
+  * Requires a library built with WORKERMANAGER_TRACE=1; recording is on
+  * from the start. Each thread keeps its most recent events: cycles,
+  * init/run/end of every worker, contended list locks and sleeps.
+  *
+  * @param enable 1 to record, 0 to pause.
+  */
+ void workerManager_traceEnable(uint8_t enable);
+
+ /**
+  * @brief Write the recorded events as Chrome trace-event JSON.
+  *
+  * The file opens in chrome://tracing or ui.perfetto.dev. Safe to call
+  * while the manager runs: recording threads are never stopped.
+  *
+  * @param path Output file.
+  * @return 0 on success, -1 if tracing is compiled out or the file cannot be written.
+  */
+ int workerManager_traceDump(const char *path);
  
  #ifdef __cplusplus
  }
@@ -0,0 +1,115 @@
+/**
+ *  \file workerStats.h
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 12 APR 2025
+ *
+ *  \brief Per-worker runtime statistics and latency histograms.
+ *
+ *  \details
+ *  Statistics are collected by the worker manager only when the library
+ *  is built with WORKERMANAGER_STATS defined to 1; otherwise dispatch is
+ *  not timed and no counters are allocated. worker_t only holds a pointer
+ *  to the counters, allocated with the worker, so its layout does not
+ *  depend on the option and the application may be built without it.
+ *
+ *  Histograms are log-linear (HDR style): every power of two is split in
+ *  WORKERSTATS_SUB_BUCKETS linear sub-buckets, giving a constant relative
+ *  precision over the whole range for a fixed, small footprint.
+ *
+ *  \copyright
+ *  Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #ifndef __WORKER_STATS_H__
+ #define __WORKER_STATS_H__
+
+ #include <stdint.h>
+
+ #ifdef __cplusplus
+ extern "C" {
+ #endif
+
+ /**
+  * @def WORKERMANAGER_STATS
+  * @brief Set to 1 to compile statistics collection in.
+  */
+ #ifndef WORKERMANAGER_STATS
+ #define WORKERMANAGER_STATS            0
+ #endif
+
+ /**
+  * @def WORKERSTATS_SUB_BITS
+  * @brief log2 of the number of linear sub-buckets per power of two.
+  */
+ #define WORKERSTATS_SUB_BITS           2u
+
+ /**
+  * @def WORKERSTATS_SUB_BUCKETS
+  * @brief Linear sub-buckets per power of two (25% relative precision).
+  */
+ #define WORKERSTATS_SUB_BUCKETS        (1u << WORKERSTATS_SUB_BITS)
+
+ /**
+  * @def WORKERSTATS_MAX_EXPONENT
+  * @brief Largest tracked power of two, in ns (2^40 ns ~ 18 minutes).
+  */
+ #define WORKERSTATS_MAX_EXPONENT       40u
+
+ /**
+  * @def WORKERSTATS_BUCKETS
+  * @brief Number of buckets of a histogram.
+  */
+ #define WORKERSTATS_BUCKETS            ((WORKERSTATS_MAX_EXPONENT - WORKERSTATS_SUB_BITS + 2u) * WORKERSTATS_SUB_BUCKETS)
+
+ /**
+  * @brief Runtime statistics of a worker. All times are in ns.
+  */
+ typedef struct {
+     uint64_t invocations;                      /**< Completed run handler calls. */
+     uint64_t runMin;                           /**< Shortest run duration. */
+     uint64_t runMax;                           /**< Longest run duration. */
+     uint64_t runTotal;                         /**< Sum of run durations (avg = runTotal / invocations). */
+     uint64_t latencySamples;                   /**< Runs with a known scheduled start time. */
+     uint64_t latencyMin;                       /**< Smallest start delay past the scheduled time. */
+     uint64_t latencyMax;                       /**< Largest start delay past the scheduled time. */
+     uint64_t latencyTotal;                     /**< Sum of start delays. */
+     uint64_t overruns;                         /**< Missed periods or exceeded budgets. */
+     uint32_t runHistogram[WORKERSTATS_BUCKETS];     /**< Run duration distribution. */
+     uint32_t latencyHistogram[WORKERSTATS_BUCKETS]; /**< Start delay distribution. */
+ } workerStats_t;
+
+ /**
+  * @brief Histogram bucket of a value.
+  *
+  * @param value Value in ns.
+  * @return Bucket index in [0 - WORKERSTATS_BUCKETS).
+  */
+ uint32_t workerStats_bucket(uint64_t value);
+
+ /**
+  * @brief Lowest value falling in a histogram bucket.
+  *
+  * @param bucket Bucket index.
+  * @return Value in ns.
+  */
+ uint64_t workerStats_bucketValue(uint32_t bucket);
+
+ /**
+  * @brief Estimate a percentile from a histogram.
+  *
+  * @param histogram Histogram of WORKERSTATS_BUCKETS counters.
+  * @param percentile Percentile in [0 - 100].
+  * @return Lower bound of the bucket holding the percentile, in ns.
+  */
+ uint64_t workerStats_percentile(const uint32_t *histogram, double percentile);
+
+ #ifdef __cplusplus
+ }
+ #endif
+
+ #endif // __WORKER_STATS_H__
@@ -21,8 +21,37 @@
  #include <stdlib.h>
  
  #include "worker.h"
+ #include "workerManager.h"
+ #include "workerTrace.h"
+
+ #if WORKERMANAGER_STATIC_POOLS
+ #include <pthread.h>
+ #include "memoryPool.h"
+ #endif
  
  #define WORKER_NAME_MAX_LEN 64  /**< Maximum allowed worker name length */
+
+ /**
+  * @brief Allocation unit of a worker: the worker first, then its statistics.
+  */
+ typedef struct {
+     worker_t worker;
+ #if WORKERMANAGER_STATS
+     workerStats_t stats;
+ #endif
+ } workerBlock_t;
+
+ #if WORKERMANAGER_STATIC_POOLS
+ static uint8_t _workerStorage[MEMORYPOOL_STORAGE_SIZE(WORKERMANAGER_MAX_WORKERS, sizeof(workerBlock_t))]
+     __attribute__((aligned(MEMORYPOOL_ALIGN)));
+ static memoryPool_t _workerPool;
+ static pthread_once_t _workerPoolOnce = PTHREAD_ONCE_INIT;
+
+ static void _workerPoolInit(void)
+ {
+     (void)memoryPool_init(&_workerPool, _workerStorage, WORKERMANAGER_MAX_WORKERS, sizeof(workerBlock_t));
+ }
+ #endif
   
  /**
   * @brief Creates and initializes a new worker object.
@@ -35,10 +64,27 @@
      if (!name || !worker) 
         return;
  
-     (*worker) = malloc(sizeof(worker_t));
-     if (!(*worker)) return;
+ #if WORKERMANAGER_STATIC_POOLS
+     pthread_once(&_workerPoolOnce, _workerPoolInit);
+     workerBlock_t *block = memoryPool_acquire(&_workerPool);
+     if (!block) {
+         printf("Error: worker pool exhausted (%u workers)\n", WORKERMANAGER_MAX_WORKERS);
+         (*worker) = NULL;
+         return;
+     }
+ #else
+     workerBlock_t *block = malloc(sizeof(workerBlock_t));
+     if (!block) {
+         (*worker) = NULL;
+         return;
+     }
+ #endif
  
-     memset(*worker, 0x00, sizeof(worker_t));
+     memset(block, 0x00, sizeof(workerBlock_t));
+     (*worker) = &block->worker;
+ #if WORKERMANAGER_STATS
+     (*worker)->stats = &block->stats;
+ #endif
      strncpy((*worker)->metadata.name, name, WORKER_NAME_MAX_LEN - 1);
      (*worker)->metadata.name[WORKER_NAME_MAX_LEN - 1] = '\0';
  }
@@ -54,7 +100,11 @@
         return;
  
      printf("destroy %s\n", worker->metadata.name);
+ #if WORKERMANAGER_STATIC_POOLS
+     memoryPool_release(&_workerPool, worker);
+ #else
      free(worker);
+ #endif
  }
  
  /**
@@ -64,8 +114,11 @@
   */
  void worker_handleInit(worker_t *worker)
  {
-     if (worker && worker->init.handler)
+     if (worker && worker->init.handler) {
+         WORKERTRACE_RECORD(WORKERTRACE_INIT, WORKERTRACE_BEGIN, worker->metadata.priority, worker->metadata.name);
          worker->init.handler(worker->init.args);
+         WORKERTRACE_RECORD(WORKERTRACE_INIT, WORKERTRACE_FINISH, worker->metadata.priority, worker->metadata.name);
+     }
  }
  
  /**
@@ -75,8 +128,11 @@
   */
  void worker_handleRun(worker_t *worker)
  {
-     if (worker && worker->run.handler)
+     if (worker && worker->run.handler) {
+         WORKERTRACE_RECORD(WORKERTRACE_RUN, WORKERTRACE_BEGIN, worker->metadata.priority, worker->metadata.name);
          worker->run.handler(worker->run.args);
+         WORKERTRACE_RECORD(WORKERTRACE_RUN, WORKERTRACE_FINISH, worker->metadata.priority, worker->metadata.name);
+     }
  }
  
  /**
@@ -86,7 +142,10 @@
   */
  void worker_handleEnd(worker_t *worker)
  {
-     if (worker && worker->end.handler)
+     if (worker && worker->end.handler) {
+         WORKERTRACE_RECORD(WORKERTRACE_END, WORKERTRACE_BEGIN, worker->metadata.priority, worker->metadata.name);
          worker->end.handler(worker->end.args);
+         WORKERTRACE_RECORD(WORKERTRACE_END, WORKERTRACE_FINISH, worker->metadata.priority, worker->metadata.name);
+     }
  }
  
\ No newline at end of file
@@ -0,0 +1,228 @@
+/**
+ * @file workerCoroutine.c
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 12 APR 2025
+ * @brief Stackful coroutines on pooled stacks for workers that yield.
+ *
+ * Built on ucontext. Each stack mapping starts with a guard page and ends
+ * with the coroutine state, so a coroutine costs one mapping, taken from
+ * and returned to a small free list. With WORKERMANAGER_STATIC_POOLS the
+ * stacks are instead carved out of a static array, without guard pages,
+ * and at most WORKERMANAGER_COROUTINE_POOL_SIZE runs can be suspended.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#define _GNU_SOURCE                /* MAP_ANONYMOUS, MAP_STACK */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "workerManager.h"
+#include "workerCoroutine.h"
+#include "workerTrace.h"
+
+/**
+ * @brief State of a coroutine, stored at the top of its stack mapping.
+ */
+typedef struct workerCoroutine {
+    struct workerCoroutine *nextFree;  /**< Link in the stack pool. */
+    ucontext_t context;                /**< Saved context of the coroutine. */
+    ucontext_t *caller;                /**< Context of the dispatcher that resumed it. */
+    void (*handler)(void *args);       /**< Run handler it executes, copied when the run started. */
+    void *args;                        /**< Argument of handler. */
+    uint8_t finished;                  /**< The run handler returned. */
+    void *mapping;                     /**< Base of the mapping, guard page included. */
+    void *stack;                       /**< Lowest usable stack address. */
+    size_t mappingSize;                /**< Size of the mapping. */
+} workerCoroutine_t;
+
+#define WORKERCOROUTINE_BLOCK_SIZE     (WORKERMANAGER_COROUTINE_STACK_SIZE + sizeof(workerCoroutine_t) + 64u)
+
+/*************** STATIC SECTION ***************/
+
+static workerCoroutine_t *_coroutineFree = NULL;
+static uint32_t _coroutineFreeCount = 0;
+static pthread_mutex_t _coroutineMutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread workerCoroutine_t *_currentCoroutine = NULL;
+#if WORKERMANAGER_STATIC_POOLS
+static uint8_t _coroutineStorage[WORKERMANAGER_COROUTINE_POOL_SIZE][WORKERCOROUTINE_BLOCK_SIZE]
+    __attribute__((aligned(64)));
+static uint32_t _coroutineCarved = 0;   /**< Blocks of _coroutineStorage handed out so far. */
+#endif
+
+/**
+ * @brief Take a stack from the pool or map a new one.
+ */
+static workerCoroutine_t *_coroutineAcquire(void) {
+    pthread_mutex_lock(&_coroutineMutex);
+    workerCoroutine_t *co = _coroutineFree;
+    if (co != NULL) {
+        _coroutineFree = co->nextFree;
+        _coroutineFreeCount--;
+    }
+    pthread_mutex_unlock(&_coroutineMutex);
+
+    if (co != NULL) {
+        return co;
+    }
+
+#if WORKERMANAGER_STATIC_POOLS
+    /* Blocks are carved once and then only recycled through the free list. */
+    uint32_t block = __atomic_fetch_add(&_coroutineCarved, 1u, __ATOMIC_RELAXED);
+    if (block >= WORKERMANAGER_COROUTINE_POOL_SIZE) {
+        __atomic_fetch_sub(&_coroutineCarved, 1u, __ATOMIC_RELAXED);
+        printf("Error: coroutine stack pool exhausted\n");
+        return NULL;
+    }
+    uint8_t *mapping = _coroutineStorage[block];
+    co = (workerCoroutine_t *)(((uintptr_t)mapping + WORKERCOROUTINE_BLOCK_SIZE - sizeof(workerCoroutine_t)) &
+                               ~(uintptr_t)63u);
+    co->mapping = mapping;
+    co->stack = mapping;
+    co->mappingSize = 0;
+    return co;
+#else
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = page + WORKERMANAGER_COROUTINE_STACK_SIZE + sizeof(workerCoroutine_t);
+    size = (size + page - 1u) & ~(page - 1u);
+
+    void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (mapping == MAP_FAILED) {
+        printf("Error: unable to map a coroutine stack\n");
+        return NULL;
+    }
+    (void)mprotect(mapping, page, PROT_NONE);
+
+    co = (workerCoroutine_t *)(((uintptr_t)mapping + size - sizeof(workerCoroutine_t)) & ~(uintptr_t)63u);
+    co->mapping = mapping;
+    co->stack = (uint8_t *)mapping + page;
+    co->mappingSize = size;
+    return co;
+#endif
+}
+
+/**
+ * @brief Give a stack back to the pool.
+ */
+static void _coroutineRelease(workerCoroutine_t *co) {
+    pthread_mutex_lock(&_coroutineMutex);
+    if (_coroutineFreeCount < WORKERMANAGER_COROUTINE_POOL_SIZE) {
+        co->nextFree = _coroutineFree;
+        _coroutineFree = co;
+        _coroutineFreeCount++;
+        co = NULL;
+    }
+    pthread_mutex_unlock(&_coroutineMutex);
+
+    if (co != NULL) {
+        (void)munmap(co->mapping, co->mappingSize);
+    }
+}
+
+/**
+ * @brief First frame of every coroutine.
+ */
+static void _coroutineEntry(void) {
+    workerCoroutine_t *co = _currentCoroutine;
+
+    if (co->handler != NULL) {
+        co->handler(co->args);
+    }
+
+    /* The dispatcher that resumed us last may not be the first one. */
+    co->finished = 1;
+    setcontext(co->caller);
+}
+
+/*************** INTERNAL SECTION ***************/
+
+uint8_t workerCoroutine_resume(worker_t *worker, const workerRun_t *run) {
+    workerCoroutine_t *co = (workerCoroutine_t *)worker->coroutine.context;
+
+    if (co == NULL) {
+        co = _coroutineAcquire();
+        if (co == NULL) {
+            /* No stack: run to completion on the dispatcher's stack. */
+            if (run->handler != NULL) {
+                WORKERTRACE_RECORD(WORKERTRACE_RUN, WORKERTRACE_BEGIN, worker->metadata.priority, worker->metadata.name);
+                run->handler(run->args);
+                WORKERTRACE_RECORD(WORKERTRACE_RUN, WORKERTRACE_FINISH, worker->metadata.priority, worker->metadata.name);
+            }
+            return 1;
+        }
+
+        getcontext(&co->context);
+        co->context.uc_stack.ss_sp = co->stack;
+        co->context.uc_stack.ss_size = (size_t)((uint8_t *)co - (uint8_t *)co->context.uc_stack.ss_sp);
+        co->context.uc_link = NULL;
+        makecontext(&co->context, _coroutineEntry, 0);
+        co->handler = run->handler;
+        co->args = run->args;
+        co->finished = 0;
+        worker->coroutine.context = co;
+    }
+
+    ucontext_t caller;
+    workerCoroutine_t *outer = _currentCoroutine;
+    co->caller = &caller;
+    _currentCoroutine = co;
+
+    WORKERTRACE_RECORD(WORKERTRACE_RUN, WORKERTRACE_BEGIN, worker->metadata.priority, worker->metadata.name);
+    swapcontext(&caller, &co->context);
+    WORKERTRACE_RECORD(WORKERTRACE_RUN, WORKERTRACE_FINISH, worker->metadata.priority, worker->metadata.name);
+
+    _currentCoroutine = outer;
+    if (!co->finished) {
+        return 0;
+    }
+
+    worker->coroutine.context = NULL;
+    _coroutineRelease(co);
+    return 1;
+}
+
+void workerCoroutine_discard(worker_t *worker) {
+    workerCoroutine_t *co = (workerCoroutine_t *)worker->coroutine.context;
+
+    if (co != NULL) {
+        worker->coroutine.context = NULL;
+        _coroutineRelease(co);
+    }
+}
+
+void workerCoroutine_releasePool(void) {
+#if !WORKERMANAGER_STATIC_POOLS
+    pthread_mutex_lock(&_coroutineMutex);
+    workerCoroutine_t *co = _coroutineFree;
+    _coroutineFree = NULL;
+    _coroutineFreeCount = 0;
+    pthread_mutex_unlock(&_coroutineMutex);
+
+    while (co != NULL) {
+        workerCoroutine_t *next = co->nextFree;
+        (void)munmap(co->mapping, co->mappingSize);
+        co = next;
+    }
+#endif
+}
+
+/*************** PUBLIC SECTION ***************/
+
+/**
+ * @brief Suspend the running coroutine worker until its next activation.
+ */
+void workerManager_yield(void) {
+    workerCoroutine_t *co = _currentCoroutine;
+
+    if (co != NULL) {
+        swapcontext(&co->context, co->caller);
+    }
+}
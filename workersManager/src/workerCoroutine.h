@@ -0,0 +1,70 @@
+/**
+ * @file workerCoroutine.h
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 12 APR 2025
+ * @brief Internal stackful coroutines for workers that yield.
+ *
+ * A coroutine worker runs its run handler on a stack taken from a pool.
+ * workerManager_yield() switches back to the dispatcher, and the next
+ * activation of the worker resumes the handler where it left off. The
+ * stack goes back to the pool when the handler returns.
+ *
+ * This header is private to the workersManager sources.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#ifndef WORKER_COROUTINE_H
+#define WORKER_COROUTINE_H
+
+#include <stdint.h>
+
+#include "worker.h"
+#include "workerManagerPrivate.h"
+
+/**
+ * @def WORKERMANAGER_COROUTINE_STACK_SIZE
+ * @brief Usable stack size of a coroutine in bytes (a guard page is added).
+ */
+#ifndef WORKERMANAGER_COROUTINE_STACK_SIZE
+#define WORKERMANAGER_COROUTINE_STACK_SIZE     (64u * 1024u)
+#endif
+
+/**
+ * @def WORKERMANAGER_COROUTINE_POOL_SIZE
+ * @brief Idle stacks kept for reuse; stacks released beyond it are unmapped.
+ *
+ * With WORKERMANAGER_STATIC_POOLS, the total number of stacks.
+ */
+#ifndef WORKERMANAGER_COROUTINE_POOL_SIZE
+#define WORKERMANAGER_COROUTINE_POOL_SIZE      16u
+#endif
+
+/**
+ * @brief Start or resume the run handler of a coroutine worker.
+ *
+ * Called by the thread the worker is dispatched on, one at a time. A new
+ * run calls the handler of run; a suspended one resumes the handler it
+ * was started with.
+ *
+ * @param worker Worker with coroutine.enabled set.
+ * @param run Run parameters of the worker.
+ * @return 1 if the handler returned, 0 if it yielded.
+ */
+uint8_t workerCoroutine_resume(worker_t *worker, const workerRun_t *run);
+
+/**
+ * @brief Drop the suspended run of a worker, if any, and recycle its stack.
+ *
+ * The frames of the handler are discarded without being unwound.
+ */
+void workerCoroutine_discard(worker_t *worker);
+
+/**
+ * @brief Unmap the idle stacks of the pool (static stacks are kept).
+ */
+void workerCoroutine_releasePool(void);
+
+#endif // WORKER_COROUTINE_H
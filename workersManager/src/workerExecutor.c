@@ -0,0 +1,392 @@
+/**
+ * @file workerExecutor.c
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 12 APR 2025
+ * @brief Internal work-stealing executor used by the worker manager.
+ *
+ * Every pool thread owns one deque per priority level. The owner pops from
+ * the bottom, other threads steal from the top. Deques are short and only
+ * touched for a few instructions, so each one is guarded by a spinlock.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "workerManager.h"
+#include "workerExecutor.h"
+#include "workerManagerPrivate.h"
+#include "workerTrace.h"
+
+#define WORKEREXECUTOR_DEQUE_MASK              (WORKEREXECUTOR_DEQUE_SIZE - 1u)
+
+/**
+ * @brief A single queued worker run.
+ */
+typedef struct {
+    worker_t *worker;              /**< Worker to run. */
+    const workerRun_t *run;        /**< Its run parameters, kept by the snapshot of the pass. */
+    uint64_t scheduled;            /**< Time the run was due at in ns, 0 if unknown. */
+    workerExecutorBatch_t *batch;  /**< Batch to notify on completion. */
+} executorJob_t;
+
+/**
+ * @brief Bounded deque of jobs for one thread and one priority level.
+ */
+typedef struct {
+    pthread_spinlock_t lock;       /**< Guards top, bottom and jobs. */
+    uint32_t top;                  /**< Next job to steal. */
+    uint32_t bottom;               /**< Next free slot. */
+    executorJob_t jobs[WORKEREXECUTOR_DEQUE_SIZE]; /**< Ring storage. */
+} executorDeque_t;
+
+/**
+ * @brief Pool thread descriptor.
+ */
+typedef struct {
+    pthread_t thread;              /**< Thread handle. */
+    uint16_t index;                /**< Index in the pool. */
+    executorDeque_t *deques;       /**< One deque per priority level. */
+} executorThread_t;
+
+/*************** STATIC SECTION ***************/
+
+static executorThread_t *_pool = NULL;
+#if WORKERMANAGER_STATIC_POOLS
+static executorThread_t _poolStorage[WORKERMANAGER_MAX_EXECUTOR_THREADS];
+static executorDeque_t _dequeStorage[WORKERMANAGER_MAX_EXECUTOR_THREADS][WORKERMANAGER_PRIORITY_NUM];
+#endif
+static uint16_t _poolSize = 0;
+static uint8_t _priorityNum = 0;
+static volatile uint8_t _running = 0;
+static uint8_t _poolOrphaned = 0;    /**< A pool thread was detached by a join timeout. */
+
+static pthread_mutex_t _poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _poolCond = PTHREAD_COND_INITIALIZER;
+static uint32_t _idleThreads = 0;   /**< Pool threads blocked on _poolCond. */
+static uint32_t _queuedJobs = 0;    /**< Jobs sitting in any deque. */
+static uint32_t _submitCursor = 0;  /**< Round-robin target for submissions. */
+
+/**
+ * @brief Push a job at the bottom of a deque.
+ *
+ * @return 0 on success, -1 if the deque is full.
+ */
+static int _dequePush(executorDeque_t *deque, const executorJob_t *job) {
+    int rc = -1;
+
+    pthread_spin_lock(&deque->lock);
+    if ((deque->bottom - deque->top) < WORKEREXECUTOR_DEQUE_SIZE) {
+        deque->jobs[deque->bottom & WORKEREXECUTOR_DEQUE_MASK] = *job;
+        __atomic_store_n(&deque->bottom, deque->bottom + 1u, __ATOMIC_RELEASE);
+        rc = 0;
+    }
+    pthread_spin_unlock(&deque->lock);
+
+    return rc;
+}
+
+/**
+ * @brief Take a job from a deque, bottom (owner) or top (thief).
+ *
+ * @return 1 if a job was taken, 0 if the deque was empty.
+ */
+static uint8_t _dequeTake(executorDeque_t *deque, uint8_t fromBottom, executorJob_t *job) {
+    uint8_t taken = 0;
+
+    /* Cheap unlocked emptiness check, confirmed under the lock. */
+    if (__atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE) == __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+
+    pthread_spin_lock(&deque->lock);
+    if (deque->bottom != deque->top) {
+        if (fromBottom) {
+            __atomic_store_n(&deque->bottom, deque->bottom - 1u, __ATOMIC_RELAXED);
+            *job = deque->jobs[deque->bottom & WORKEREXECUTOR_DEQUE_MASK];
+        } else {
+            *job = deque->jobs[deque->top & WORKEREXECUTOR_DEQUE_MASK];
+            __atomic_store_n(&deque->top, deque->top + 1u, __ATOMIC_RELAXED);
+        }
+        taken = 1;
+    }
+    pthread_spin_unlock(&deque->lock);
+
+    return taken;
+}
+
+/**
+ * @brief Find a job at priority maxPrio or higher.
+ *
+ * Levels are scanned from the highest priority down; within a level the
+ * own deque comes first, then the other threads are robbed.
+ *
+ * @param self Index of the calling pool thread, or -1 for a priority thread.
+ */
+static uint8_t _takeJob(int32_t self, uint8_t maxPrio, executorJob_t *job) {
+    if (__atomic_load_n(&_queuedJobs, __ATOMIC_ACQUIRE) == 0u) {
+        return 0;
+    }
+
+    for (uint8_t prio = 0; (prio <= maxPrio) && (prio < _priorityNum); prio++) {
+        if ((self >= 0) && _dequeTake(&_pool[self].deques[prio], 1, job)) {
+            __atomic_fetch_sub(&_queuedJobs, 1u, __ATOMIC_SEQ_CST);
+            return 1;
+        }
+
+        uint16_t start = (self >= 0) ? (uint16_t)(self + 1) : 0u;
+        for (uint16_t k = 0; k < _poolSize; k++) {
+            uint16_t victim = (uint16_t)((start + k) % _poolSize);
+            if (((int32_t)victim != self) && _dequeTake(&_pool[victim].deques[prio], 0, job)) {
+                __atomic_fetch_sub(&_queuedJobs, 1u, __ATOMIC_SEQ_CST);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Run a job and account for it in its batch.
+ */
+static void _runJob(const executorJob_t *job) {
+    workerManager_runWorker(job->worker, job->run, job->scheduled);
+
+    if (__atomic_sub_fetch(&job->batch->pending, 1u, __ATOMIC_ACQ_REL) == 0u) {
+        pthread_mutex_lock(&job->batch->mutex);
+        pthread_cond_broadcast(&job->batch->done);
+        pthread_mutex_unlock(&job->batch->mutex);
+    }
+}
+
+/**
+ * @brief Pool thread routine.
+ */
+static void *_executorHandler(void *args) {
+    executorThread_t *self = (executorThread_t *)args;
+    executorJob_t job;
+
+    workerTrace_setThreadName("executor", self->index);
+    for (;;) {
+        if (_takeJob((int32_t)self->index, (uint8_t)(_priorityNum - 1u), &job)) {
+            _runJob(&job);
+            continue;
+        }
+
+        pthread_mutex_lock(&_poolMutex);
+        __atomic_fetch_add(&_idleThreads, 1u, __ATOMIC_SEQ_CST);
+        while (_running && (__atomic_load_n(&_queuedJobs, __ATOMIC_SEQ_CST) == 0u)) {
+            pthread_cond_wait(&_poolCond, &_poolMutex);
+        }
+        __atomic_fetch_sub(&_idleThreads, 1u, __ATOMIC_SEQ_CST);
+        uint8_t stop = (!_running) && (__atomic_load_n(&_queuedJobs, __ATOMIC_SEQ_CST) == 0u);
+        pthread_mutex_unlock(&_poolMutex);
+
+        if (stop) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/*************** PUBLIC SECTION ***************/
+
+int workerExecutor_start(uint16_t threads, uint8_t priorityNum, size_t stackSize) {
+    if (_running || _poolOrphaned || (priorityNum == 0u)) {
+        return -1;
+    }
+
+    if (threads == 0u) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cpus > 0) ? (uint16_t)cpus : 1u;
+    }
+
+#if WORKERMANAGER_STATIC_POOLS
+    if (threads > WORKERMANAGER_MAX_EXECUTOR_THREADS) {
+        printf("Warning: executor pool limited to %u threads\n", WORKERMANAGER_MAX_EXECUTOR_THREADS);
+        threads = WORKERMANAGER_MAX_EXECUTOR_THREADS;
+    }
+    memset(_poolStorage, 0x00, sizeof(_poolStorage));
+    memset(_dequeStorage, 0x00, sizeof(_dequeStorage));
+    _pool = _poolStorage;
+#else
+    _pool = calloc(threads, sizeof(executorThread_t));
+#endif
+    if (_pool == NULL) {
+        printf("Error: unable to allocate executor pool\n");
+        return -1;
+    }
+
+    _poolSize = threads;
+    _priorityNum = priorityNum;
+    _queuedJobs = 0;
+    _idleThreads = 0;
+    _submitCursor = 0;
+    _running = 1;
+
+    for (uint16_t i = 0; i < threads; i++) {
+        _pool[i].index = i;
+#if WORKERMANAGER_STATIC_POOLS
+        _pool[i].deques = _dequeStorage[i];
+#else
+        _pool[i].deques = calloc(priorityNum, sizeof(executorDeque_t));
+#endif
+        if (_pool[i].deques == NULL) {
+            printf("Error: unable to allocate executor deques\n");
+#if !WORKERMANAGER_STATIC_POOLS
+            for (uint16_t j = 0; j < i; j++) {
+                free(_pool[j].deques);
+            }
+            free(_pool);
+#endif
+            _pool = NULL;
+            _poolSize = 0;
+            _running = 0;
+            return -1;
+        }
+        for (uint8_t prio = 0; prio < priorityNum; prio++) {
+            pthread_spin_init(&_pool[i].deques[prio].lock, PTHREAD_PROCESS_PRIVATE);
+        }
+    }
+
+    for (uint16_t i = 0; i < threads; i++) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if ((stackSize != 0u) && (stackSize >= (size_t)PTHREAD_STACK_MIN)) {
+            pthread_attr_setstacksize(&attr, stackSize);
+        }
+        int rc = pthread_create(&_pool[i].thread, &attr, _executorHandler, &_pool[i]);
+        pthread_attr_destroy(&attr);
+
+        if (rc != 0) {
+            printf("Error: unable to start executor thread %d (%d)\n", i, rc);
+            _poolSize = i;
+            for (uint16_t j = i; j < threads; j++) {
+#if !WORKERMANAGER_STATIC_POOLS
+                free(_pool[j].deques);
+#endif
+                _pool[j].deques = NULL;
+            }
+            (void)workerExecutor_stop(0u);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int workerExecutor_stop(uint32_t joinTimeout) {
+    if (_pool == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&_poolMutex);
+    _running = 0;
+    pthread_cond_broadcast(&_poolCond);
+    pthread_mutex_unlock(&_poolMutex);
+
+    uint8_t detached = 0;
+    for (uint16_t i = 0; i < _poolSize; i++) {
+        if (workerManager_joinThread(_pool[i].thread, joinTimeout) != 0) {
+            pthread_detach(_pool[i].thread);
+            detached = 1;
+        }
+    }
+
+    if (detached) {
+        /* A detached thread still walks the pool once its job returns. */
+        _poolOrphaned = 1;
+        return -1;
+    }
+
+    for (uint16_t i = 0; i < _poolSize; i++) {
+        if (_pool[i].deques != NULL) {
+            for (uint8_t prio = 0; prio < _priorityNum; prio++) {
+                pthread_spin_destroy(&_pool[i].deques[prio].lock);
+            }
+#if !WORKERMANAGER_STATIC_POOLS
+            free(_pool[i].deques);
+#endif
+        }
+    }
+
+#if !WORKERMANAGER_STATIC_POOLS
+    free(_pool);
+#endif
+    _pool = NULL;
+    _poolSize = 0;
+    return 0;
+}
+
+uint8_t workerExecutor_isRunning(void) {
+    return _running;
+}
+
+void workerExecutor_initBatch(workerExecutorBatch_t *batch) {
+    batch->pending = 0;
+    pthread_mutex_init(&batch->mutex, NULL);
+    pthread_cond_init(&batch->done, NULL);
+}
+
+void workerExecutor_destroyBatch(workerExecutorBatch_t *batch) {
+    pthread_cond_destroy(&batch->done);
+    pthread_mutex_destroy(&batch->mutex);
+}
+
+void workerExecutor_submit(worker_t *worker, const workerRun_t *run, uint8_t prio, uint64_t scheduled,
+                           workerExecutorBatch_t *batch) {
+    executorJob_t job = { worker, run, scheduled, batch };
+
+    if ((!_running) || (prio >= _priorityNum)) {
+        workerManager_runWorker(worker, run, scheduled);
+        return;
+    }
+
+    __atomic_fetch_add(&batch->pending, 1u, __ATOMIC_ACQ_REL);
+
+    uint32_t first = __atomic_fetch_add(&_submitCursor, 1u, __ATOMIC_RELAXED);
+    for (uint16_t k = 0; k < _poolSize; k++) {
+        executorThread_t *target = &_pool[(first + k) % _poolSize];
+        if (_dequePush(&target->deques[prio], &job) == 0) {
+            __atomic_fetch_add(&_queuedJobs, 1u, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&_idleThreads, __ATOMIC_SEQ_CST) != 0u) {
+                pthread_mutex_lock(&_poolMutex);
+                pthread_cond_signal(&_poolCond);
+                pthread_mutex_unlock(&_poolMutex);
+            }
+            return;
+        }
+    }
+
+    /* Every deque of the level is full: run inline. */
+    __atomic_fetch_sub(&batch->pending, 1u, __ATOMIC_ACQ_REL);
+    workerManager_runWorker(worker, run, scheduled);
+}
+
+void workerExecutor_waitBatch(workerExecutorBatch_t *batch, uint8_t prio) {
+    executorJob_t job;
+
+    while (__atomic_load_n(&batch->pending, __ATOMIC_ACQUIRE) != 0u) {
+        if (_takeJob(-1, prio, &job)) {
+            _runJob(&job);
+            continue;
+        }
+
+        pthread_mutex_lock(&batch->mutex);
+        while (__atomic_load_n(&batch->pending, __ATOMIC_ACQUIRE) != 0u) {
+            pthread_cond_wait(&batch->done, &batch->mutex);
+        }
+        pthread_mutex_unlock(&batch->mutex);
+    }
+}
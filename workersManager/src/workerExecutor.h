@@ -0,0 +1,111 @@
+/**
+ * @file workerExecutor.h
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 12 APR 2025
+ * @brief Internal work-stealing executor used by the worker manager.
+ *
+ * A fixed pool of threads, each owning one bounded deque per priority
+ * level. Priority threads running in executor mode push their due workers
+ * as a batch, the pool threads pop their own deques (LIFO) and steal from
+ * the others (FIFO), always looking at higher priorities first.
+ *
+ * This header is private to the workersManager sources.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#ifndef WORKER_EXECUTOR_H
+#define WORKER_EXECUTOR_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "worker.h"
+#include "workerManagerPrivate.h"
+
+/**
+ * @def WORKEREXECUTOR_DEQUE_SIZE
+ * @brief Capacity of each per-thread, per-priority deque (power of two).
+ */
+#ifndef WORKEREXECUTOR_DEQUE_SIZE
+#define WORKEREXECUTOR_DEQUE_SIZE              64u
+#endif
+
+/**
+ * @brief Set of jobs submitted by one priority thread during one pass.
+ *
+ * Owned by the submitting priority thread, which blocks in
+ * workerExecutor_waitBatch() until every job of the batch has run.
+ */
+typedef struct {
+    uint32_t pending;              /**< Jobs submitted and not yet completed. */
+    pthread_mutex_t mutex;         /**< Guards the completion signal. */
+    pthread_cond_t done;           /**< Signalled when pending drops to zero. */
+} workerExecutorBatch_t;
+
+/**
+ * @brief Start the pool.
+ *
+ * @param threads Number of pool threads, 0 = one per online CPU.
+ * @param priorityNum Number of priority levels to keep deques for.
+ * @param stackSize Stack size of the pool threads, 0 = default.
+ * @return 0 on success, -1 on allocation or thread creation failure.
+ */
+int workerExecutor_start(uint16_t threads, uint8_t priorityNum, size_t stackSize);
+
+/**
+ * @brief Stop and join the pool. Pending jobs are run before returning.
+ *
+ * A pool thread still busy after joinTimeout is detached and the pool
+ * memory is kept alive for it; the pool cannot be started again.
+ *
+ * @param joinTimeout Maximum wait per thread in µs, 0 = unbounded.
+ * @return 0 if every thread was joined, -1 if one had to be detached.
+ */
+int workerExecutor_stop(uint32_t joinTimeout);
+
+/**
+ * @brief Return 1 if the pool is running.
+ */
+uint8_t workerExecutor_isRunning(void);
+
+/**
+ * @brief Initialize a batch owned by a priority thread.
+ */
+void workerExecutor_initBatch(workerExecutorBatch_t *batch);
+
+/**
+ * @brief Release the resources of a batch.
+ */
+void workerExecutor_destroyBatch(workerExecutorBatch_t *batch);
+
+/**
+ * @brief Queue a worker run on the pool as part of a batch.
+ *
+ * If every deque of the level is full the worker runs inline on the
+ * calling thread.
+ *
+ * @param worker Worker to run.
+ * @param run Run parameters of the worker, valid until the batch completes.
+ * @param prio Priority level of the worker.
+ * @param scheduled Time the run was due at in ns, 0 if unknown.
+ * @param batch Batch accounting for the run.
+ */
+void workerExecutor_submit(worker_t *worker, const workerRun_t *run, uint8_t prio, uint64_t scheduled,
+                           workerExecutorBatch_t *batch);
+
+/**
+ * @brief Wait until every job of the batch has run.
+ *
+ * While waiting, the caller helps by running queued jobs of its own or a
+ * higher priority level.
+ *
+ * @param batch Batch to wait for.
+ * @param prio Priority level of the caller.
+ */
+void workerExecutor_waitBatch(workerExecutorBatch_t *batch, uint8_t prio);
+
+#endif // WORKER_EXECUTOR_H
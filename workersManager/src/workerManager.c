@@ -12,26 +12,129 @@
  * MIT License.
  */
 
+#define _GNU_SOURCE                /* pthread_attr_setaffinity_np, CPU_SET */
+
 #include <pthread.h>
+#include <sched.h>
+#include <limits.h>
+#include <errno.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 
 #include "linkedListDynamic.h"
+#if WORKERMANAGER_STATIC_POOLS
+#include "memoryPool.h"
+#endif
 #include "workerManager.h"
+#include "workerExecutor.h"
+#include "workerTask.h"
+#include "workerTrace.h"
+#include "workerCoroutine.h"
+#include "workerManagerPrivate.h"
+
+#define WORKERMANAGER_DEFAULT_SLEEP_TIME       100000u /* 100ms */
+#define WORKERMANAGER_REMOVE_POLL              10000u  /* 10ms, removal wait slice while the manager runs. */
+#define WORKERMANAGER_READER_SLOTS             4u      /* Dispatch threads per level, isolated ones included. */
+#define WORKERMANAGER_EPOLL_EVENTS             32u     /* Events collected per epoll_wait(). */
+#define WORKERMANAGER_SPIN_MIN_NS              2000u   /* Adaptive spin bounds. */
+#define WORKERMANAGER_SPIN_MAX_NS              100000u
+#define WORKERMANAGER_IDLE_YIELDS              4u      /* sched_yield() rounds between spin and block. */
+#define WORKERMANAGER_SPIN_POLL_MASK           31u     /* Spin rounds between two epoll readiness polls. */
+
+/**
+ * @brief Life cycle of a dispatch thread.
+ *
+ * Only RUNNING threads walk snapshots. A thread abandoned by the watchdog
+ * (ISOLATED) or by a join timeout (ORPHANED) bails out as soon as the
+ * handler it is stuck in returns; the transition out of ISOLATED is a
+ * compare-and-swap so that exactly one of the thread and workerManager_end()
+ * decides whether the level's shared state may still be touched.
+ */
+typedef enum {
+    THREAD_STATE_RUNNING = 0,      /**< Serving its level. */
+    THREAD_STATE_ISOLATED,         /**< Replaced by the watchdog, stuck in a handler. */
+    THREAD_STATE_EXITING,          /**< Isolated thread leaving after its handler returned. */
+    THREAD_STATE_ORPHANED          /**< Detached by workerManager_end(), must not touch anything. */
+} threadState_t;
+
+/**
+ * @brief Packed dispatch entry of a worker.
+ *
+ * Holds everything a pass needs, so that walking a list touches one
+ * contiguous array instead of every worker_t. The worker itself (name,
+ * statistics, notification flag) is only dereferenced when it runs through
+ * the instrumented path or when its state must be checked.
+ */
+typedef struct {
+    workerRun_t run;               /**< Handler, argument and period the worker was started with. */
+    uint64_t nextDeadline;         /**< Next activation in ns, owned by the dispatch thread. */
+    worker_t *worker;              /**< Worker the entry was built from. */
+    uint8_t supervised;            /**< Run through workerManager_runWorker() (budget or coroutine). */
+    uint8_t triggered;             /**< Has predecessors: runs only when they completed. */
+    uint8_t successors;            /**< Completion triggers other workers. */
+} workerEntry_t;
+
+/**
+ * @brief Immutable view of a priority list, read by the dispatch thread.
+ *
+ * A snapshot is never modified once published, except for the deadlines
+ * the dispatch thread keeps in its entries: add/remove/start/stop build a
+ * new one and swap the list pointer. The replaced snapshot is retired and
+ * freed once every dispatch thread has been seen outside of a pass (see
+ * _readerSeq).
+ */
+typedef struct workerSnapshot {
+    struct workerSnapshot *nextRetired; /**< Link in the retire list. */
+    uint32_t retireSeq[WORKERMANAGER_READER_SLOTS]; /**< Reader sequences observed when retired. */
+    uint64_t generation;           /**< Publication counter of the level. */
+    uint32_t count;                /**< Number of entries in the snapshot. */
+    workerEntry_t entries[];       /**< Dispatched workers in insertion order. */
+} workerSnapshot_t;
 
-#define WORKERMANAGER_PRIORITY_NUM             10u
+/**
+ * @brief epoll state of a level that watches file descriptors.
+ *
+ * Created with the first descriptor of the level; from then on its thread
+ * waits in epoll_wait() on the workers' descriptors, the wake eventfd and
+ * the deadline timerfd instead of on its condition variable.
+ */
+typedef struct {
+    int epollFd;                   /**< epoll set of the level. */
+    int wakeFd;                    /**< eventfd written by _wakeThread(). */
+    int timerFd;                   /**< Next deadline of the level (absolute CLOCK_MONOTONIC). */
+    uint64_t timerDeadline;        /**< Deadline timerFd is armed for, UINT64_MAX = disarmed. Level thread only. */
+} levelIo_t;
 
 /**
  * @brief Internal thread argument structure passed to each worker thread.
  */
  typedef struct {
-    Node_t **workerList;           /**< Pointer to the list of workers for this thread. */
+    uint8_t prio;                  /**< Priority list served by this thread. */
     uint32_t sleepTime;            /**< Sleep duration between worker cycles (in µs). */
-    pthread_mutex_t *mutex;        /**< Mutex for thread-safe list access. */
+    pthread_mutex_t *mutex;        /**< Writer mutex of the list, only try-locked to reclaim snapshots. */
+    pthread_mutex_t wakeMutex;     /**< Protects wakePending and guards wakeCond. */
+    pthread_cond_t wakeCond;       /**< Signalled by workerManager_notify (CLOCK_MONOTONIC). */
+    uint8_t wakePending;           /**< Set when a notification arrived since the last cycle (atomic, polled when spinning). */
+    uint8_t runAllPending;         /**< Set when the whole list was notified. */
+    uint8_t useExecutor;           /**< Run due workers on the work-stealing pool. */
+    uint8_t idlePolicy;            /**< One of workerManagerIdlePolicy_t (atomic). */
+    uint32_t spinNs;               /**< Current adaptive spin length. Level thread only. */
+    workerExecutorBatch_t batch;   /**< Jobs of the current pass in executor mode. */
+    uint8_t readerSlot;            /**< Index in _readerSeq[prio]. */
+    uint8_t state;                 /**< One of threadState_t. */
+    worker_t *currentWorker;       /**< Worker running inline on this thread, NULL between runs. */
+    worker_t *stuckWorker;         /**< Worker the thread was isolated in. */
+    uint64_t generation;           /**< Snapshot generation the entry deadlines were loaded for. */
+    uint64_t stuckSince;           /**< Start of that run in ns. */
 } threadArgs_t;
 
 /**
@@ -48,178 +151,2257 @@ typedef struct {
 /*************** STATIC SECTION ***************/
 
 static volatile uint8_t workerManagerRunning = 0;
+/* workerManager_submit() calls past their running check, waited for by workerManager_end(). */
+static uint32_t _submitters = 0;
+static uint64_t _epochNs = 0;      /**< Manager start time, origin of every worker phase. */
+static workerManagerConfig_t _config;  /**< Configuration given to workerManager_initEx(). */
+static uint8_t _priorityNum = WORKERMANAGER_PRIORITY_NUM;
 
 static Node_t *_workersList[WORKERMANAGER_PRIORITY_NUM] = { 0 };
 static Node_t *_pthreadList[WORKERMANAGER_PRIORITY_NUM] = { 0 };
 static pthread_mutex_t _mutexList[WORKERMANAGER_PRIORITY_NUM];
 
+/* Published snapshots, swapped atomically by writers holding _mutexList. */
+static workerSnapshot_t *_snapshotList[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+/* Incremented on every publication, tells a dispatch thread to reload its deadlines. */
+static uint64_t _snapshotGeneration[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+/* Set by workerManager_notify() before waking the level thread. */
+static uint8_t _notifyPending[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+/* Snapshots replaced but possibly still read by the dispatch thread. */
+static workerSnapshot_t *_retiredList[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+/* Per dispatch thread: odd while it walks a snapshot, even when quiescent. */
+static uint32_t _readerSeq[WORKERMANAGER_PRIORITY_NUM][WORKERMANAGER_READER_SLOTS] = { { 0 } };
+/* Bit n set while reader slot n of the level belongs to a thread (under _mutexList). */
+static uint8_t _readerSlots[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+/* Threads replaced by the watchdog, joined by workerManager_end(). */
+static Node_t *_isolatedList = NULL;
+static pthread_mutex_t _isolatedMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Workers whose requested status changed, applied by the level thread. */
+static worker_t *_lifecycleQueue[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+static pthread_once_t _lifecycleOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t _lifecycleMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _lifecycleCond;
+static uint32_t _lifecycleWaiters = 0;
+
+static pthread_t _watchdogThread;
+static uint8_t _watchdogRunning = 0;
+static uint8_t _watchdogActive = 0; /**< Runs are timestamped for the watchdog; set before any thread starts. */
+static pthread_mutex_t _watchdogMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _watchdogCond;
+/* Levels whose pass cannot end before the calling thread returns: its own level, the levels it runs a worker of. */
+static __thread uint32_t _callerLevels = 0;
+_Static_assert(WORKERMANAGER_PRIORITY_NUM <= 32u, "_callerLevels holds one bit per priority level");
+
+static pthread_mutex_t _dependencyMutex = PTHREAD_MUTEX_INITIALIZER; /**< Serializes workerManager_addDependency(). */
+
+static levelIo_t *_levelIo[WORKERMANAGER_PRIORITY_NUM] = { 0 }; /**< epoll state, NULL until a descriptor is watched. */
+
+/* Set when a snapshot could not be published; the level thread retries. */
+static uint8_t _republishPending[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+
+#if WORKERMANAGER_STATIC_POOLS
 /**
- * @brief Thread routine for managing workers by priority
+ * @brief Dispatch thread bookkeeping allocated as one block.
  */
-static void *_workManagerHandler(void *args) {
-    threadArgs_t *threadArgs = (threadArgs_t *)args;
+typedef struct {
+    Node_t node;                   /**< Link in _pthreadList / _isolatedList, first member. */
+    threadNode_t thread;           /**< Item of node. */
+    pthread_t handle;              /**< Target of thread.metadata.thread. */
+} threadBlock_t;
 
-    pthread_mutex_t *mutex = threadArgs->mutex;
+/* A thread node stays allocated until workerManager_end(), isolated ones included. */
+#define WORKERMANAGER_THREAD_POOL_SIZE         (WORKERMANAGER_PRIORITY_NUM * WORKERMANAGER_READER_SLOTS)
+#define WORKERMANAGER_SNAPSHOT_BLOCK_SIZE      (sizeof(workerSnapshot_t) + (WORKERMANAGER_MAX_WORKERS * sizeof(workerEntry_t)))
 
-    if (workerManagerRunning) {
-        pthread_mutex_lock(mutex);
-        Node_t **workerList = threadArgs->workerList;
-        while ((*workerList) != NULL) {
-            worker_t *worker = (worker_t *)(*workerList)->item;
-            worker_handleInit(worker);
-            workerList = (Node_t **)&((*workerList)->next);
+static uint8_t _nodeStorage[MEMORYPOOL_STORAGE_SIZE(WORKERMANAGER_MAX_WORKERS, sizeof(Node_t))]
+    __attribute__((aligned(MEMORYPOOL_ALIGN)));
+static uint8_t _threadStorage[MEMORYPOOL_STORAGE_SIZE(WORKERMANAGER_THREAD_POOL_SIZE, sizeof(threadBlock_t))]
+    __attribute__((aligned(MEMORYPOOL_ALIGN)));
+static uint8_t _snapshotStorage[MEMORYPOOL_STORAGE_SIZE(WORKERMANAGER_SNAPSHOT_POOL_SIZE, WORKERMANAGER_SNAPSHOT_BLOCK_SIZE)]
+    __attribute__((aligned(MEMORYPOOL_ALIGN)));
+static memoryPool_t _nodePool;
+static memoryPool_t _threadPool;
+static memoryPool_t _snapshotPool;
+static levelIo_t _levelIoStorage[WORKERMANAGER_PRIORITY_NUM];
+static pthread_once_t _poolOnce = PTHREAD_ONCE_INIT;
+
+static void _poolInit(void) {
+    (void)memoryPool_init(&_nodePool, _nodeStorage, WORKERMANAGER_MAX_WORKERS, sizeof(Node_t));
+    (void)memoryPool_init(&_threadPool, _threadStorage, WORKERMANAGER_THREAD_POOL_SIZE, sizeof(threadBlock_t));
+    (void)memoryPool_init(&_snapshotPool, _snapshotStorage, WORKERMANAGER_SNAPSHOT_POOL_SIZE,
+                          WORKERMANAGER_SNAPSHOT_BLOCK_SIZE);
+}
+#endif
+
+/**
+ * @brief Allocate a worker list node.
+ */
+static Node_t *_nodeAlloc(void *item) {
+#if WORKERMANAGER_STATIC_POOLS
+    pthread_once(&_poolOnce, _poolInit);
+    Node_t *node = memoryPool_acquire(&_nodePool);
+#else
+    Node_t *node = malloc(sizeof(Node_t));
+#endif
+    if (node != NULL) {
+        node->item = item;
+        node->next = NULL;
+    }
+    return node;
+}
+
+static void _nodeFree(Node_t *node) {
+#if WORKERMANAGER_STATIC_POOLS
+    memoryPool_release(&_nodePool, node);
+#else
+    free(node);
+#endif
+}
+
+/**
+ * @brief Allocate the node of a dispatch thread, its threadNode_t and pthread_t.
+ */
+static Node_t *_threadNodeAlloc(void) {
+#if WORKERMANAGER_STATIC_POOLS
+    pthread_once(&_poolOnce, _poolInit);
+    threadBlock_t *block = memoryPool_acquire(&_threadPool);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->node.item = &block->thread;
+    block->node.next = NULL;
+    block->thread.metadata.thread = &block->handle;
+    return &block->node;
+#else
+    threadNode_t *threadNode = malloc(sizeof(threadNode_t));
+    Node_t *pthreadNode = linkedListDynamic_createNode(threadNode);
+    pthread_t *thread = malloc(sizeof(pthread_t));
+    if ((threadNode == NULL) || (pthreadNode == NULL) || (thread == NULL)) {
+        free(threadNode);
+        free(pthreadNode);
+        free(thread);
+        return NULL;
+    }
+    threadNode->metadata.thread = thread;
+    return pthreadNode;
+#endif
+}
+
+static void _threadNodeFree(Node_t *pthreadNode) {
+#if WORKERMANAGER_STATIC_POOLS
+    memoryPool_release(&_threadPool, pthreadNode);
+#else
+    threadNode_t *threadNode = (threadNode_t *)pthreadNode->item;
+    free(threadNode->metadata.thread);
+    free(threadNode);
+    free(pthreadNode);
+#endif
+}
+
+/**
+ * @brief Allocate a snapshot of count entries.
+ */
+static workerSnapshot_t *_snapshotAlloc(uint32_t count) {
+#if WORKERMANAGER_STATIC_POOLS
+    pthread_once(&_poolOnce, _poolInit);
+    return (count <= WORKERMANAGER_MAX_WORKERS) ? memoryPool_acquire(&_snapshotPool) : NULL;
+#else
+    return malloc(sizeof(workerSnapshot_t) + (count * sizeof(workerEntry_t)));
+#endif
+}
+
+static void _snapshotFree(workerSnapshot_t *snapshot) {
+#if WORKERMANAGER_STATIC_POOLS
+    memoryPool_release(&_snapshotPool, snapshot);
+#else
+    free(snapshot);
+#endif
+}
+
+/**
+ * @brief Lock the writer mutex of a list, tracing the wait when contended.
+ */
+static void _lockList(uint8_t prio) {
+    if (!WORKERTRACE_ACTIVE()) {
+        pthread_mutex_lock(&_mutexList[prio]);
+    } else if (pthread_mutex_trylock(&_mutexList[prio]) != 0) {
+        WORKERTRACE_RECORD(WORKERTRACE_LOCK, WORKERTRACE_BEGIN, prio, NULL);
+        pthread_mutex_lock(&_mutexList[prio]);
+        WORKERTRACE_RECORD(WORKERTRACE_LOCK, WORKERTRACE_FINISH, prio, NULL);
+    }
+}
+
+/**
+ * @brief Read the monotonic clock in nanoseconds.
+ */
+uint64_t workerManager_nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Join a thread, giving up after timeout µs (0 = wait forever).
+ */
+int workerManager_joinThread(pthread_t thread, uint32_t timeout) {
+    if (timeout == 0u) {
+        return pthread_join(thread, NULL);
+    }
+
+    /* pthread_timedjoin_np() only takes CLOCK_REALTIME deadlines. */
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t deadline = ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec +
+                        ((uint64_t)timeout * 1000ull);
+    ts.tv_sec = (time_t)(deadline / 1000000000ull);
+    ts.tv_nsec = (long)(deadline % 1000000000ull);
+    return pthread_timedjoin_np(thread, NULL, &ts);
+}
+
+/**
+ * @brief Deliver a watchdog event to the configured callback.
+ */
+static void _reportEvent(uint8_t event, worker_t *worker, uint64_t elapsed) {
+    static const char *const eventName[] = { "overrun", "stuck", "isolated", "recovered", "join timeout" };
+
+    if (_config.watchdog.callback != NULL) {
+        _config.watchdog.callback(event, worker, elapsed, _config.watchdog.callbackArg);
+    } else if (event != WORKERMANAGER_EVENT_OVERRUN) {
+        printf("Warning: worker %s %s after %llu us\n", (worker != NULL) ? worker->metadata.name : "-",
+               eventName[event], (unsigned long long)(elapsed / 1000ull));
+    }
+}
+
+/**
+ * @brief Mark a completed run in the ready mask of each successor and
+ *        notify the successors whose predecessors have all completed.
+ *
+ * The successor that sees its mask complete resets it, so a predecessor
+ * running twice before the others only counts once.
+ */
+static void _releaseSuccessors(worker_t *worker) {
+    uint8_t count = __atomic_load_n(&worker->dependency.successorCount, __ATOMIC_ACQUIRE);
+
+    for (uint8_t i = 0; i < count; i++) {
+        worker_t *successor = (worker_t *)worker->dependency.successor[i];
+        uint8_t predecessors = __atomic_load_n(&successor->dependency.predecessorCount, __ATOMIC_ACQUIRE);
+        uint32_t all = (predecessors >= WORKER_MAX_PREDECESSORS) ? UINT32_MAX : ((1u << predecessors) - 1u);
+
+        uint32_t ready = __atomic_or_fetch(&successor->dependency.readyMask, worker->dependency.successorBit[i],
+                                           __ATOMIC_ACQ_REL);
+        if ((ready == all) &&
+            __atomic_compare_exchange_n(&successor->dependency.readyMask, &ready, 0u, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            workerManager_notify(successor);
         }
-        pthread_mutex_unlock(mutex);
     }
+}
+
+/**
+ * @brief Run, or resume, the run handler of a worker.
+ *
+ * @return 1 if the run completed, 0 if a coroutine yielded.
+ */
+static uint8_t _runHandler(worker_t *worker, const workerRun_t *run) {
+    if (worker->coroutine.enabled) {
+        return workerCoroutine_resume(worker, run);
+    }
+
+    if (run->handler != NULL) {
+        WORKERTRACE_RECORD(WORKERTRACE_RUN, WORKERTRACE_BEGIN, worker->metadata.priority, worker->metadata.name);
+        run->handler(run->args);
+        WORKERTRACE_RECORD(WORKERTRACE_RUN, WORKERTRACE_FINISH, worker->metadata.priority, worker->metadata.name);
+    }
+    return 1;
+}
+
+/**
+ * @brief Run the run handler of a worker with the manager instrumentation.
+ *
+ * The run is only timed when statistics are compiled in, the watchdog is
+ * active or the worker declares a budget.
+ */
+void workerManager_runWorker(worker_t *worker, const workerRun_t *run, uint64_t scheduled) {
+    uint32_t callerLevels = _callerLevels;
+    _callerLevels |= (1u << worker->metadata.priority);
 
-    while (workerManagerRunning) {
-        pthread_mutex_lock(mutex);
-        Node_t **workerList = threadArgs->workerList;
-        while ((*workerList) != NULL) {
-            worker_t *worker = (worker_t *)(*workerList)->item;
-            worker_handleRun(worker);
-            workerList = (Node_t **)&((*workerList)->next);
+    uint8_t watched = _watchdogActive;
+    if (!WORKERMANAGER_STATS && !watched && (worker->watchdog.budget == 0u)) {
+        (void)scheduled;
+        if (_runHandler(worker, run) && (worker->dependency.successorCount != 0u)) {
+            _releaseSuccessors(worker);
         }
-        pthread_mutex_unlock(mutex);
-        usleep(threadArgs->sleepTime);
+        _callerLevels = callerLevels;
+        return;
     }
 
-    pthread_mutex_lock(mutex);
-    Node_t **workerList = threadArgs->workerList;
-    while ((*workerList) != NULL) {
-        worker_t *worker = (worker_t *)(*workerList)->item;
-        worker_handleEnd(worker);
-        workerList = (Node_t **)&((*workerList)->next);
+    uint8_t resumed = (worker->coroutine.context != NULL);
+    uint64_t start = workerManager_nowNs();
+    if (watched) {
+        __atomic_store_n(&worker->watchdog.runStart, start, __ATOMIC_RELEASE);
+    }
+    uint8_t completed = _runHandler(worker, run);
+    uint64_t end = workerManager_nowNs();
+    if (watched) {
+        __atomic_store_n(&worker->watchdog.runStart, 0u, __ATOMIC_RELEASE);
     }
-    pthread_mutex_unlock(mutex);
 
-    return NULL;
+    /* The budget bounds each slice: that is how long the thread is held. */
+    uint8_t overBudget = (worker->watchdog.budget != 0u) &&
+                         ((end - start) > ((uint64_t)worker->watchdog.budget * 1000ull));
+
+#if WORKERMANAGER_STATS
+    if (worker->stats != NULL) {
+        uint64_t runStart = start;
+        uint64_t runScheduled = scheduled;
+        uint64_t runTime = end - start;
+
+        /* A coroutine run is accounted once, when it completes, for all its slices. */
+        if (worker->coroutine.enabled) {
+            if (!resumed) {
+                worker->coroutine.runStart = start;
+                worker->coroutine.runScheduled = scheduled;
+                worker->coroutine.runTime = 0;
+            }
+            worker->coroutine.runTime += runTime;
+            runStart = worker->coroutine.runStart;
+            runScheduled = worker->coroutine.runScheduled;
+            runTime = worker->coroutine.runTime;
+        }
+
+        /* A periodic run overruns when it completes past its next activation;
+         * triggered and non-periodic workers have no activation to miss. */
+        uint8_t missedPeriod = completed && (run->period != 0u) && (runScheduled != 0u) &&
+                               (end > (runScheduled + run->period));
+        if (completed) {
+            workerStats_record(worker->stats, runStart, runTime, runScheduled);
+        }
+        /* One overrun per run, even when it both misses its period and exceeds its budget. */
+        if (missedPeriod || overBudget) {
+            workerStats_recordOverrun(worker->stats);
+        }
+    }
+#else
+    (void)resumed;
+#endif
+
+    if (overBudget) {
+        worker->watchdog.skip = _config.watchdog.overrunSkip;
+        _reportEvent(WORKERMANAGER_EVENT_OVERRUN, worker, end - start);
+    }
+
+    if (completed && (worker->dependency.successorCount != 0u)) {
+        _releaseSuccessors(worker);
+    }
+    _callerLevels = callerLevels;
 }
 
-/*************** PUBLIC SECTION ***************/
+/**
+ * @brief Convert an absolute CLOCK_MONOTONIC time in ns to a timespec.
+ */
+static void _nsToTimespec(uint64_t ns, struct timespec *ts) {
+    ts->tv_sec = (time_t)(ns / 1000000000ull);
+    ts->tv_nsec = (long)(ns % 1000000000ull);
+}
 
 /**
- * @brief Initialize the worker manager and start priority threads.
+ * @brief Wait of a level watching descriptors: same contract as
+ *        _waitForWork(), plus a run for every worker whose descriptor is ready.
  */
-void workerManager_init(void) {
-    workerManagerRunning = 1;
+static uint8_t _waitForEvents(threadArgs_t *threadArgs, levelIo_t *io, uint64_t deadline) {
+    uint8_t prio = threadArgs->prio;
+    int timeout = -1;
 
-    for (uint8_t i = 0; i < WORKERMANAGER_PRIORITY_NUM; i++) {
-        _workersList[i] = NULL;
-        pthread_mutex_init(&_mutexList[i], NULL);
+    pthread_mutex_lock(&threadArgs->wakeMutex);
+    uint8_t pending = __atomic_load_n(&threadArgs->wakePending, __ATOMIC_RELAXED) || !workerManagerRunning;
+    pthread_mutex_unlock(&threadArgs->wakeMutex);
 
-        //_pthreadList[i] = malloc(sizeof(Node_t));
-        void *item = malloc(sizeof(threadNode_t));
-        _pthreadList[i] = linkedListDynamic_createNode(item);
+    if (pending || ((deadline != UINT64_MAX) && (deadline <= workerManager_nowNs()))) {
+        timeout = 0;  /* Only collect what is already ready. */
+    } else if (deadline != io->timerDeadline) {
+        struct itimerspec spec;
+        memset(&spec, 0x00, sizeof(spec));
+        if (deadline != UINT64_MAX) {
+            _nsToTimespec(deadline, &spec.it_value);
+        }
+        (void)timerfd_settime(io->timerFd, TFD_TIMER_ABSTIME, &spec, NULL);
+        io->timerDeadline = deadline;
+    }
 
-        threadNode_t *threadNode = (threadNode_t *)_pthreadList[i]->item;
-        threadNode->metadata.threadArgs.workerList = &_workersList[i];
-        threadNode->metadata.threadArgs.sleepTime = 100000; // 100ms
-        threadNode->metadata.threadArgs.mutex = &_mutexList[i];
+    struct epoll_event events[WORKERMANAGER_EPOLL_EVENTS];
+    if (timeout != 0) {
+        WORKERTRACE_RECORD(WORKERTRACE_SLEEP, WORKERTRACE_BEGIN, prio, NULL);
+    }
+    int count = epoll_wait(io->epollFd, events, (int)WORKERMANAGER_EPOLL_EVENTS, timeout);
+    if (timeout != 0) {
+        WORKERTRACE_RECORD(WORKERTRACE_SLEEP, WORKERTRACE_FINISH, prio, NULL);
+    }
 
-        threadNode->metadata.thread = malloc(sizeof(pthread_t));
-        pthread_create(threadNode->metadata.thread, NULL, _workManagerHandler,
-                       (void *)&threadNode->metadata.threadArgs);
+    for (int i = 0; i < count; i++) {
+        uint64_t value;
+        if (events[i].data.ptr == &io->wakeFd) {
+            (void)read(io->wakeFd, &value, sizeof(value));
+        } else if (events[i].data.ptr == &io->timerFd) {
+            (void)read(io->timerFd, &value, sizeof(value));
+            io->timerDeadline = UINT64_MAX;
+        } else {
+            /* Armed descriptors only belong to dispatched workers of this level. */
+            worker_t *worker = (worker_t *)events[i].data.ptr;
+            __atomic_store_n(&worker->schedule.notified, 1, __ATOMIC_RELEASE);
+            __atomic_store_n(&_notifyPending[prio], 1, __ATOMIC_RELEASE);
+        }
     }
+
+    pthread_mutex_lock(&threadArgs->wakeMutex);
+    uint8_t runAll = threadArgs->runAllPending;
+    __atomic_store_n(&threadArgs->wakePending, 0, __ATOMIC_RELAXED);
+    threadArgs->runAllPending = 0;
+    pthread_mutex_unlock(&threadArgs->wakeMutex);
+
+    return runAll;
 }
 
- /**
-  * @brief Add a worker to a given priority level.
-  * 
-  * @param worker Pointer to the worker definition.
-  * @param prio Priority index [0 - N). Lower index = higher priority.
-  */
-void workerManager_addWorker(worker_t *worker, uint8_t prio) {
-    if (prio >= WORKERMANAGER_PRIORITY_NUM) {
-        printf("Error: Priority %d exceeds allowed range\n", prio);
-        return;
+/**
+ * @brief Tell the CPU the thread is busy-waiting.
+ */
+static inline void _cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ * @brief Poll for work without sleeping, for at most limit ns.
+ *
+ * Work is a notification, the deadline or, on an epoll level, a ready
+ * descriptor (seen through the readiness of the epoll set itself, so no
+ * event is consumed here).
+ *
+ * @param limit Spin length in ns, UINT64_MAX = until there is work.
+ * @return 1 if there is work, 0 if the limit was reached first.
+ */
+static uint8_t _spinForWork(threadArgs_t *threadArgs, levelIo_t *io, uint64_t deadline, uint64_t limit) {
+    uint64_t now = workerManager_nowNs();
+    uint64_t end = (limit == UINT64_MAX) ? UINT64_MAX : (now + limit);
+
+    for (uint32_t round = 0; ; round++) {
+        if (__atomic_load_n(&threadArgs->wakePending, __ATOMIC_ACQUIRE) || !workerManagerRunning || (now >= deadline)) {
+            return 1;
+        }
+        if ((io != NULL) && ((round & WORKERMANAGER_SPIN_POLL_MASK) == 0u)) {
+            struct pollfd pfd = { io->epollFd, POLLIN, 0 };
+            if (poll(&pfd, 1, 0) > 0) {
+                return 1;
+            }
+        }
+        if (now >= end) {
+            return 0;
+        }
+        _cpuRelax();
+        now = workerManager_nowNs();
     }
+}
 
-    pthread_mutex_lock(&_mutexList[prio]);
+/**
+ * @brief Spin and yield ahead of a blocking wait, as the level's idle policy says.
+ *
+ * The adaptive spin doubles when work shows up while spinning or yielding
+ * and halves when the thread had to block, between WORKERMANAGER_SPIN_MIN_NS
+ * and WORKERMANAGER_SPIN_MAX_NS.
+ *
+ * @return 1 if there is work, 0 if the thread should block.
+ */
+static uint8_t _idleSpin(threadArgs_t *threadArgs, levelIo_t *io, uint64_t deadline) {
+    uint8_t policy = __atomic_load_n(&threadArgs->idlePolicy, __ATOMIC_RELAXED);
 
-    Node_t **workerList = &_workersList[prio];
-    while ((*workerList) != NULL) {
-        workerList = (Node_t **)&((*workerList)->next);
+    if (policy == WORKERMANAGER_IDLE_SPIN) {
+        return _spinForWork(threadArgs, io, deadline, UINT64_MAX);
+    }
+    if (policy != WORKERMANAGER_IDLE_ADAPTIVE) {
+        return 0;
     }
 
-    *workerList = malloc(sizeof(Node_t));
-    (*workerList)->item = worker;
-    (*workerList)->next = NULL;
+    uint8_t found = _spinForWork(threadArgs, io, deadline, threadArgs->spinNs);
+    for (uint32_t i = 0; !found && (i < WORKERMANAGER_IDLE_YIELDS); i++) {
+        sched_yield();
+        found = _spinForWork(threadArgs, io, deadline, 0u);
+    }
 
-    pthread_mutex_unlock(&_mutexList[prio]);
+    if (found) {
+        threadArgs->spinNs = (threadArgs->spinNs >= (WORKERMANAGER_SPIN_MAX_NS / 2u)) ? WORKERMANAGER_SPIN_MAX_NS
+                           : (threadArgs->spinNs * 2u);
+    } else {
+        threadArgs->spinNs = (threadArgs->spinNs <= (WORKERMANAGER_SPIN_MIN_NS * 2u)) ? WORKERMANAGER_SPIN_MIN_NS
+                           : (threadArgs->spinNs / 2u);
+    }
+    return found;
 }
 
 /**
- * @brief Remove a worker from any priority level.
- * 
- * @param worker Pointer to the worker to remove.
+ * @brief Block the calling priority thread until it is notified, the
+ *        manager stops, or the absolute deadline is reached.
+ *
+ * A notification posted while the thread was busy running its workers is
+ * not lost: wakePending stays set and the next wait returns immediately.
+ *
+ * @param deadline Absolute CLOCK_MONOTONIC time in ns, UINT64_MAX = no timeout.
+ * @return 1 if the whole list was notified, 0 otherwise.
  */
-void workerManager_removeWorker(worker_t *worker) {
-    for (uint8_t prio = 0; prio < WORKERMANAGER_PRIORITY_NUM; prio++) {
-        pthread_mutex_lock(&_mutexList[prio]);
-        Node_t **workerList = &_workersList[prio];
-        Node_t *prev = NULL;
-
-        while (*workerList != NULL) {
-            if ((*workerList)->item == worker) {
-                Node_t *toDelete = *workerList;
-                if (prev) {
-                    prev->next = toDelete->next;
-                } else {
-                    _workersList[prio] = toDelete->next;
-                }
-                free(toDelete);
-                pthread_mutex_unlock(&_mutexList[prio]);
-                return;
-            }
-            prev = *workerList;
-            workerList = (Node_t **)&((*workerList)->next);
+static uint8_t _waitForWork(threadArgs_t *threadArgs, uint64_t deadline) {
+    levelIo_t *io = __atomic_load_n(&_levelIo[threadArgs->prio], __ATOMIC_ACQUIRE);
+
+    /* When the spin finds work, the wait below returns without sleeping. */
+    (void)_idleSpin(threadArgs, io, deadline);
+
+    if (io != NULL) {
+        return _waitForEvents(threadArgs, io, deadline);
+    }
+
+    pthread_mutex_lock(&threadArgs->wakeMutex);
+
+    if (deadline == UINT64_MAX) {
+        WORKERTRACE_RECORD(WORKERTRACE_SLEEP, WORKERTRACE_BEGIN, threadArgs->prio, NULL);
+        while (!threadArgs->wakePending && workerManagerRunning) {
+            pthread_cond_wait(&threadArgs->wakeCond, &threadArgs->wakeMutex);
         }
-        pthread_mutex_unlock(&_mutexList[prio]);
+        WORKERTRACE_RECORD(WORKERTRACE_SLEEP, WORKERTRACE_FINISH, threadArgs->prio, NULL);
+    } else if (deadline > workerManager_nowNs()) {
+        struct timespec ts;
+        _nsToTimespec(deadline, &ts);
+
+        int rc = 0;
+        WORKERTRACE_RECORD(WORKERTRACE_SLEEP, WORKERTRACE_BEGIN, threadArgs->prio, NULL);
+        while (!threadArgs->wakePending && workerManagerRunning && (rc == 0)) {
+            rc = pthread_cond_timedwait(&threadArgs->wakeCond, &threadArgs->wakeMutex, &ts);
+        }
+        WORKERTRACE_RECORD(WORKERTRACE_SLEEP, WORKERTRACE_FINISH, threadArgs->prio, NULL);
     }
+
+    uint8_t runAll = threadArgs->runAllPending;
+    __atomic_store_n(&threadArgs->wakePending, 0, __ATOMIC_RELAXED);
+    threadArgs->runAllPending = 0;
+    pthread_mutex_unlock(&threadArgs->wakeMutex);
+
+    return runAll;
 }
 
 /**
- * @brief Stop all worker threads and cleanup resources.
+ * @brief Wake the thread serving the given priority list.
+ *
+ * @param runAll 1 to run every non-periodic worker of the list, 0 to only
+ *               break the wait (per-worker notification).
  */
-void workerManager_end(void) {
-    workerManagerRunning = 0;
+static void _wakeThread(uint8_t prio, uint8_t runAll) {
+    Node_t *pthreadNode = __atomic_load_n(&_pthreadList[prio], __ATOMIC_ACQUIRE);
+    if (pthreadNode == NULL) {
+        return;
+    }
 
-    for (uint8_t i = 0; i < WORKERMANAGER_PRIORITY_NUM; i++) {
-        threadNode_t *threadNode = (threadNode_t *)_pthreadList[i]->item;
-        pthread_join(*(threadNode->metadata.thread), NULL);
+    threadNode_t *threadNode = (threadNode_t *)pthreadNode->item;
+    threadArgs_t *threadArgs = &threadNode->metadata.threadArgs;
 
-        free(threadNode->metadata.thread);
-        free(threadNode);
-        linkedListDynamic_destroyList(_pthreadList[i]);
+    pthread_mutex_lock(&threadArgs->wakeMutex);
+    uint8_t wasPending = threadArgs->wakePending;
+    threadArgs->runAllPending |= runAll;
+    __atomic_store_n(&threadArgs->wakePending, 1, __ATOMIC_RELEASE);
+    pthread_cond_signal(&threadArgs->wakeCond);
+    pthread_mutex_unlock(&threadArgs->wakeMutex);
 
-        pthread_mutex_destroy(&_mutexList[i]);
+    /* A level in epoll mode sleeps on its eventfd; one write per wait is enough. */
+    levelIo_t *io = __atomic_load_n(&_levelIo[prio], __ATOMIC_ACQUIRE);
+    if ((io != NULL) && !wasPending) {
+        uint64_t one = 1;
+        (void)write(io->wakeFd, &one, sizeof(one));
+    }
+}
 
-        Node_t *node = _workersList[i];
-        while (node != NULL) {
-            Node_t *next = node->next;
-            worker_t *worker = (worker_t *)node->item;
-            if (worker->end.handler) {
-                worker->end.handler(worker->end.args);
+/**
+ * @brief Release the epoll state of a level.
+ */
+static void _levelIoDestroy(levelIo_t *io) {
+    if (io->epollFd >= 0) {
+        close(io->epollFd);
+    }
+    if (io->wakeFd >= 0) {
+        close(io->wakeFd);
+    }
+    if (io->timerFd >= 0) {
+        close(io->timerFd);
+    }
+#if !WORKERMANAGER_STATIC_POOLS
+    free(io);
+#endif
+}
+
+/**
+ * @brief Switch a level to epoll mode. Must be called with the list writer mutex held.
+ *
+ * @return The epoll state of the level, NULL on failure.
+ */
+static levelIo_t *_levelIoCreate(uint8_t prio) {
+    if (_levelIo[prio] != NULL) {
+        return _levelIo[prio];
+    }
+
+#if WORKERMANAGER_STATIC_POOLS
+    levelIo_t *io = &_levelIoStorage[prio];
+#else
+    levelIo_t *io = malloc(sizeof(levelIo_t));
+#endif
+    if (io == NULL) {
+        printf("Error: unable to allocate epoll state for priority %d\n", prio);
+        return NULL;
+    }
+
+    io->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    io->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    io->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    io->timerDeadline = UINT64_MAX;
+
+    struct epoll_event event;
+    memset(&event, 0x00, sizeof(event));
+    event.events = EPOLLIN;
+    uint8_t ok = (io->epollFd >= 0) && (io->wakeFd >= 0) && (io->timerFd >= 0);
+    if (ok) {
+        event.data.ptr = &io->wakeFd;
+        ok = (epoll_ctl(io->epollFd, EPOLL_CTL_ADD, io->wakeFd, &event) == 0);
+    }
+    if (ok) {
+        event.data.ptr = &io->timerFd;
+        ok = (epoll_ctl(io->epollFd, EPOLL_CTL_ADD, io->timerFd, &event) == 0);
+    }
+    if (!ok) {
+        printf("Error: unable to set up epoll for priority %d (%d)\n", prio, errno);
+        _levelIoDestroy(io);
+        return NULL;
+    }
+
+    __atomic_store_n(&_levelIo[prio], io, __ATOMIC_RELEASE);
+    return io;
+}
+
+/**
+ * @brief Add (arm = 1) or remove the descriptors of a worker from the
+ *        epoll set of its level. Must be called with the list writer mutex held.
+ *
+ * Arming is all or nothing: if a descriptor cannot be added, the ones
+ * already added are removed and the worker stays disarmed, so a later
+ * call tries again.
+ *
+ * @return 0 on success, -1 if a descriptor could not be added.
+ */
+static int _armWorkerIo(uint8_t prio, worker_t *worker, uint8_t arm) {
+    levelIo_t *io = _levelIo[prio];
+    if ((io == NULL) || (worker->io.armed == arm)) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < worker->io.count; i++) {
+        struct epoll_event event;
+        memset(&event, 0x00, sizeof(event));
+        event.events = worker->io.events[i];
+        event.data.ptr = worker;
+        if (!arm) {
+            (void)epoll_ctl(io->epollFd, EPOLL_CTL_DEL, worker->io.fd[i], &event);
+        } else if (epoll_ctl(io->epollFd, EPOLL_CTL_ADD, worker->io.fd[i], &event) != 0) {
+            printf("Warning: unable to watch fd %d of worker %s (%d)\n", worker->io.fd[i], worker->metadata.name, errno);
+            while (i > 0u) {
+                i--;
+                (void)epoll_ctl(io->epollFd, EPOLL_CTL_DEL, worker->io.fd[i], &event);
             }
-            node = next;
+            return -1;
         }
+    }
+    worker->io.armed = arm;
+    return 0;
+}
+
+/**
+ * @brief Free the retired snapshots the dispatch thread can no longer see.
+ *
+ * Must be called with the list writer mutex held.
+ */
+static void _reclaimSnapshots(uint8_t prio) {
+    uint32_t seq[WORKERMANAGER_READER_SLOTS];
+    for (uint8_t slot = 0; slot < WORKERMANAGER_READER_SLOTS; slot++) {
+        seq[slot] = __atomic_load_n(&_readerSeq[prio][slot], __ATOMIC_SEQ_CST);
+    }
+    workerSnapshot_t **retired = &_retiredList[prio];
 
-        node = _workersList[i];
-        linkedListDynamic_destroyList(node);
+    while (*retired != NULL) {
+        workerSnapshot_t *snapshot = *retired;
+        /* Each reader was idle at retire time, or its pass in progress then is over. */
+        uint8_t busy = 0;
+        for (uint8_t slot = 0; slot < WORKERMANAGER_READER_SLOTS; slot++) {
+            busy |= ((snapshot->retireSeq[slot] & 1u) != 0u) && (snapshot->retireSeq[slot] == seq[slot]);
+        }
+        if (!busy) {
+            __atomic_store_n(retired, snapshot->nextRetired, __ATOMIC_RELAXED);
+            _snapshotFree(snapshot);
+        } else {
+            retired = &snapshot->nextRetired;
+        }
     }
 }
 
 /**
-* @brief Set the sleep time for the specific priority list.
-*/
-void workerManager_setPriorityListSleepTime(uint8_t prio, uint32_t sleepTime)
-{
-    if (prio >= WORKERMANAGER_PRIORITY_NUM) {
-        printf("Error: Priority %d exceeds allowed range\n", prio);
+ * @brief Rebuild the snapshot of a priority list and publish it.
+ *
+ * Only the workers marked dispatched are part of it: stopped workers are
+ * not even looked at by the dispatch thread. Handler, arguments and period
+ * are copied into the entries here, so they are captured when a worker
+ * joins the dispatch set.
+ *
+ * Must be called with the list writer mutex held. Never waits for the
+ * dispatch thread: the old snapshot is retired and reclaimed later. If no
+ * snapshot can be allocated the generation still moves on, so that the
+ * dispatch thread skips the workers that left, and the level thread
+ * publishes again before its next pass.
+ *
+ * @return 0 on success, -1 if the snapshot could not be allocated.
+ */
+static int _publishSnapshot(uint8_t prio) {
+    uint32_t count = 0;
+    for (Node_t *node = _workersList[prio]; node != NULL; node = node->next) {
+        count += ((worker_t *)node->item)->lifecycle.dispatched;
     }
-    else{
-        threadNode_t *threadNode = (threadNode_t *)_pthreadList[prio]->item;
-        threadNode->metadata.threadArgs.sleepTime = sleepTime;
+
+    __atomic_store_n(&_snapshotGeneration[prio], _snapshotGeneration[prio] + 1u, __ATOMIC_RELEASE);
+    workerSnapshot_t *snapshot = _snapshotAlloc(count);
+    if (snapshot == NULL) {
+        _reclaimSnapshots(prio);
+        snapshot = _snapshotAlloc(count);
+    }
+    if (snapshot == NULL) {
+        printf("Error: unable to allocate worker snapshot for priority %d\n", prio);
+        __atomic_store_n(&_republishPending[prio], 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+    __atomic_store_n(&_republishPending[prio], 0, __ATOMIC_RELAXED);
+
+    snapshot->nextRetired = NULL;
+    snapshot->generation = _snapshotGeneration[prio];
+    snapshot->count = 0;
+    for (Node_t *node = _workersList[prio]; node != NULL; node = node->next) {
+        worker_t *worker = (worker_t *)node->item;
+        if (worker->lifecycle.dispatched) {
+            workerEntry_t *entry = &snapshot->entries[snapshot->count++];
+            entry->run.handler = worker->run.handler;
+            entry->run.args = worker->run.args;
+            entry->triggered = (worker->dependency.predecessorCount != 0u);
+            entry->successors = (worker->dependency.successorCount != 0u);
+            /* A triggered worker ignores its period. */
+            entry->run.period = entry->triggered ? 0u : ((uint64_t)worker->schedule.period * 1000ull);
+            entry->nextDeadline = 0;
+            entry->worker = worker;
+            entry->supervised = (worker->watchdog.budget != 0u) || worker->coroutine.enabled;
+        }
+    }
+
+    workerSnapshot_t *old = __atomic_exchange_n(&_snapshotList[prio], snapshot, __ATOMIC_SEQ_CST);
+    if (old != NULL) {
+        for (uint8_t slot = 0; slot < WORKERMANAGER_READER_SLOTS; slot++) {
+            old->retireSeq[slot] = __atomic_load_n(&_readerSeq[prio][slot], __ATOMIC_SEQ_CST);
+        }
+        old->nextRetired = _retiredList[prio];
+        __atomic_store_n(&_retiredList[prio], old, __ATOMIC_RELAXED);
+    }
+
+    _reclaimSnapshots(prio);
+    return 0;
+}
+
+/**
+ * @brief Enter a dispatch pass and return the current snapshot (may be NULL).
+ */
+static workerSnapshot_t *_snapshotAcquire(const threadArgs_t *threadArgs) {
+    __atomic_fetch_add(&_readerSeq[threadArgs->prio][threadArgs->readerSlot], 1u, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&_snapshotList[threadArgs->prio], __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Leave a dispatch pass; opportunistically free retired snapshots.
+ */
+static void _snapshotRelease(threadArgs_t *threadArgs) {
+    __atomic_fetch_add(&_readerSeq[threadArgs->prio][threadArgs->readerSlot], 1u, __ATOMIC_SEQ_CST);
+
+    if ((__atomic_load_n(&_retiredList[threadArgs->prio], __ATOMIC_RELAXED) != NULL) &&
+        (pthread_mutex_trylock(threadArgs->mutex) == 0)) {
+        _reclaimSnapshots(threadArgs->prio);
+        pthread_mutex_unlock(threadArgs->mutex);
+    }
+}
+
+static void _lifecycleInit(void) {
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_lifecycleCond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+}
+
+/**
+ * @brief Record a status change of a worker and hand it to its level thread.
+ *
+ * Must be called with the list writer mutex held. A worker sits in the
+ * queue at most once: the level thread applies the latest requested status,
+ * so quick start/stop sequences coalesce.
+ */
+static void _queueLifecycle(worker_t *worker) {
+    uint8_t prio = worker->metadata.priority;
+
+    __atomic_add_fetch(&worker->lifecycle.requestSeq, 1u, __ATOMIC_SEQ_CST);
+    if (__atomic_exchange_n(&worker->lifecycle.queued, 1, __ATOMIC_ACQ_REL) == 0u) {
+        worker_t *head = __atomic_load_n(&_lifecycleQueue[prio], __ATOMIC_RELAXED);
+        do {
+            worker->lifecycle.next = head;
+        } while (!__atomic_compare_exchange_n(&_lifecycleQueue[prio], &head, worker, 1,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+}
+
+/**
+ * @brief Apply the queued status changes of a level. Level thread only.
+ *
+ * A started worker gets its init handler run, then joins the dispatch set;
+ * a stopped or removed one has already left it and gets its end handler
+ * run. Handlers run without any lock held.
+ */
+static void _applyLifecycle(uint8_t prio) {
+    if (__atomic_load_n(&_republishPending[prio], __ATOMIC_RELAXED)) {
+        /* Outside of a pass: at least the snapshots retired during it are free now. */
+        _lockList(prio);
+        if (_republishPending[prio]) {
+            (void)_publishSnapshot(prio);
+        }
+        pthread_mutex_unlock(&_mutexList[prio]);
+    }
+
+    if (__atomic_load_n(&_lifecycleQueue[prio], __ATOMIC_RELAXED) == NULL) {
+        return;
+    }
+
+    worker_t *stack = __atomic_exchange_n(&_lifecycleQueue[prio], NULL, __ATOMIC_ACQUIRE);
+    worker_t *fifo = NULL;
+    while (stack != NULL) {
+        worker_t *next = (worker_t *)stack->lifecycle.next;
+        stack->lifecycle.next = fifo;
+        fifo = stack;
+        stack = next;
+    }
+
+    while (fifo != NULL) {
+        worker_t *worker = fifo;
+        fifo = (worker_t *)worker->lifecycle.next;
+        /* From here a new request queues the worker again. */
+        __atomic_store_n(&worker->lifecycle.queued, 0, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&worker->lifecycle.isolated, __ATOMIC_ACQUIRE)) {
+            /* Its stuck run has not returned: the isolated thread queues it again. */
+            continue;
+        }
+        uint32_t seq = __atomic_load_n(&worker->lifecycle.requestSeq, __ATOMIC_SEQ_CST);
+
+        uint8_t active = __atomic_load_n(&worker->metadata.status, __ATOMIC_ACQUIRE) == WORKER_STATUS_ACTIVE;
+        if (active && !worker->lifecycle.initialized) {
+            worker_handleInit(worker);
+            worker->lifecycle.initialized = 1;
+        } else if (!active && worker->lifecycle.initialized) {
+            workerCoroutine_discard(worker);
+            worker_handleEnd(worker);
+            worker->lifecycle.initialized = 0;
+        }
+
+        _lockList(prio);
+        uint8_t dispatched = worker->lifecycle.registered && worker->lifecycle.initialized &&
+                             (worker->metadata.status == WORKER_STATUS_ACTIVE);
+        if (dispatched != worker->lifecycle.dispatched) {
+            __atomic_store_n(&worker->lifecycle.dispatched, dispatched, __ATOMIC_RELAXED);
+            worker->schedule.nextDeadline = 0;
+            (void)_publishSnapshot(prio);
+        }
+        (void)_armWorkerIo(prio, worker, dispatched);
+        pthread_mutex_unlock(&_mutexList[prio]);
+
+        __atomic_store_n(&worker->lifecycle.appliedSeq, seq, __ATOMIC_SEQ_CST);
+    }
+
+    pthread_once(&_lifecycleOnce, _lifecycleInit);
+    if (__atomic_load_n(&_lifecycleWaiters, __ATOMIC_SEQ_CST) != 0u) {
+        pthread_mutex_lock(&_lifecycleMutex);
+        pthread_cond_broadcast(&_lifecycleCond);
+        pthread_mutex_unlock(&_lifecycleMutex);
+    }
+}
+
+/**
+ * @brief Compute the first activation of a periodic worker at or after now.
+ *
+ * Activations lie on the grid epoch + phase + k * period, so a worker keeps
+ * its phase relation with every other worker no matter when it was added
+ * or how many activations it had to skip.
+ */
+static uint64_t _alignDeadline(const worker_t *worker, uint64_t now) {
+    uint64_t period = (uint64_t)worker->schedule.period * 1000ull;
+    uint64_t first = _epochNs + ((uint64_t)worker->schedule.phase * 1000ull);
+
+    if (now <= first) {
+        return first;
+    }
+
+    return first + (((now - first) + period - 1u) / period) * period;
+}
+
+/**
+ * @brief Run a worker inline or hand it to the executor pool.
+ *
+ * Workers without a budget run straight from their entry unless
+ * statistics or the watchdog need the instrumented path. An activation is
+ * dropped while the worker still has cycles to skip after an overrun.
+ */
+static void _dispatchWorker(threadArgs_t *threadArgs, const workerEntry_t *entry, uint64_t scheduled) {
+    if (!WORKERMANAGER_STATS && !_watchdogActive && !entry->supervised && !threadArgs->useExecutor &&
+        !WORKERTRACE_ACTIVE()) {
+        if (entry->run.handler != NULL) {
+            entry->run.handler(entry->run.args);
+        }
+        if (entry->successors) {
+            _releaseSuccessors(entry->worker);
+        }
+        return;
+    }
+
+    worker_t *worker = entry->worker;
+    if (worker->watchdog.skip != 0u) {
+        worker->watchdog.skip--;
+        return;
+    }
+
+    if (threadArgs->useExecutor) {
+        workerExecutor_submit(worker, &entry->run, threadArgs->prio, scheduled, &threadArgs->batch);
+    } else {
+        __atomic_store_n(&threadArgs->currentWorker, worker, __ATOMIC_RELEASE);
+        workerManager_runWorker(worker, &entry->run, scheduled);
+        __atomic_store_n(&threadArgs->currentWorker, NULL, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @brief Return 1 while the thread still serves its level.
+ */
+static uint8_t _threadServing(threadArgs_t *threadArgs) {
+    return __atomic_load_n(&threadArgs->state, __ATOMIC_ACQUIRE) == THREAD_STATE_RUNNING;
+}
+
+/**
+ * @brief Run one pass over the list and return the next absolute wake time.
+ *
+ * Workers with a period run when their absolute deadline has passed and are
+ * rescheduled on the next grid slot, so their rate does not depend on how
+ * long the other workers of the list take. Workers without a period run
+ * every cycle, as before, when runCycle is set. A worker notified through
+ * workerManager_notify() runs in this pass regardless of its schedule.
+ * A periodic worker that fell more than one period behind runs once as
+ * soon as possible and then resumes on the grid, the older missed slots
+ * are dropped.
+ *
+ * In executor mode the due workers are spread over the pool and the pass
+ * ends when all of them have completed, so a worker never runs twice
+ * concurrently and the snapshot stays valid for the pool threads.
+ *
+ * A thread abandoned while stuck in a handler leaves the pass without
+ * touching the snapshot again: a replacement thread may own the list.
+ */
+static uint64_t _runCycle(threadArgs_t *threadArgs, uint8_t runCycle, uint64_t cycleScheduled) {
+    uint8_t prio = threadArgs->prio;
+    uint64_t now = workerManager_nowNs();
+    uint64_t nextWake = UINT64_MAX;
+    uint8_t notified = __atomic_exchange_n(&_notifyPending[prio], 0, __ATOMIC_ACQ_REL);
+
+    workerSnapshot_t *snapshot = _snapshotAcquire(threadArgs);
+    uint32_t count = (snapshot != NULL) ? snapshot->count : 0u;
+    workerEntry_t *entries = (snapshot != NULL) ? snapshot->entries : NULL;
+
+    /* New snapshot: deadlines live in the workers between snapshots. */
+    if ((snapshot != NULL) && (snapshot->generation != threadArgs->generation)) {
+        threadArgs->generation = snapshot->generation;
+        for (uint32_t i = 0; i < count; i++) {
+            entries[i].nextDeadline = entries[i].worker->schedule.nextDeadline;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        workerEntry_t *entry = &entries[i];
+        uint8_t due = 0;
+        uint64_t scheduled = 0;
+
+        if (entry->run.period == 0u) {
+            due = runCycle && !entry->triggered;
+            scheduled = cycleScheduled;
+        } else {
+            if (entry->nextDeadline == 0u) {
+                entry->nextDeadline = _alignDeadline(entry->worker, now);
+                entry->worker->schedule.nextDeadline = entry->nextDeadline;
+            }
+            if (now >= entry->nextDeadline) {
+                due = 1;
+                scheduled = entry->nextDeadline;
+                entry->nextDeadline += entry->run.period;
+                entry->worker->schedule.nextDeadline = entry->nextDeadline;
+            }
+        }
+
+        if (notified && __atomic_exchange_n(&entry->worker->schedule.notified, 0, __ATOMIC_ACQ_REL) && !due) {
+            due = 1;
+            scheduled = 0;
+        }
+
+        if (!due) {
+            continue;
+        }
+
+        /* Stopped or removed since this snapshot was published. */
+        if ((__atomic_load_n(&_snapshotGeneration[prio], __ATOMIC_RELAXED) != snapshot->generation) &&
+            !__atomic_load_n(&entry->worker->lifecycle.dispatched, __ATOMIC_RELAXED)) {
+            continue;
+        }
+
+        _dispatchWorker(threadArgs, entry, scheduled);
+        if (!_threadServing(threadArgs)) {
+            return UINT64_MAX;
+        }
+        /* A successor later in this list runs in this very pass. */
+        if (entry->successors && !threadArgs->useExecutor) {
+            notified |= __atomic_load_n(&_notifyPending[prio], __ATOMIC_ACQUIRE);
+        }
+    }
+
+    if (threadArgs->useExecutor) {
+        workerExecutor_waitBatch(&threadArgs->batch, prio);
+        if (!_threadServing(threadArgs)) {
+            return UINT64_MAX;
+        }
+    }
+
+    now = workerManager_nowNs();
+    for (uint32_t i = 0; i < count; i++) {
+        workerEntry_t *entry = &entries[i];
+        if (entry->run.period == 0u) {
+            continue;
+        }
+        if ((entry->nextDeadline + entry->run.period) <= now) {
+            /* Missed slots: keep only the latest one instead of bursting. */
+            uint64_t latest = _alignDeadline(entry->worker, now);
+            entry->nextDeadline = (latest > now) ? (latest - entry->run.period) : latest;
+            entry->worker->schedule.nextDeadline = entry->nextDeadline;
+        }
+        if (entry->nextDeadline < nextWake) {
+            nextWake = entry->nextDeadline;
+        }
+    }
+    _snapshotRelease(threadArgs);
+
+    return nextWake;
+}
+
+/**
+ * @brief Thread routine for managing workers by priority
+ */
+static void *_workManagerHandler(void *args) {
+    threadArgs_t *threadArgs = (threadArgs_t *)args;
+
+    uint8_t runCycle = 1;
+    uint64_t cycleDeadline = 0;
+    uint64_t cycleScheduled = 0;
+    uint64_t passEnd = 0;
+    uint32_t armedSleep = 0;
+    _callerLevels |= (1u << threadArgs->prio);
+    workerTrace_setThreadName("priority", threadArgs->prio);
+    while (workerManagerRunning && _threadServing(threadArgs)) {
+        _applyLifecycle(threadArgs->prio);
+        (void)workerTask_runPending(threadArgs->prio);
+        WORKERTRACE_RECORD(WORKERTRACE_CYCLE, WORKERTRACE_BEGIN, threadArgs->prio, NULL);
+        uint64_t nextWake = _runCycle(threadArgs, runCycle, cycleScheduled);
+        WORKERTRACE_RECORD(WORKERTRACE_CYCLE, WORKERTRACE_FINISH, threadArgs->prio, NULL);
+        if (!_threadServing(threadArgs)) {
+            break;
+        }
+
+        /* The plain cycle keeps its relative sleep: sleepTime after the pass.
+         * A new sleep time re-arms the wait from the same pass. */
+        uint32_t sleepTime = __atomic_load_n(&threadArgs->sleepTime, __ATOMIC_RELAXED);
+        if (runCycle) {
+            passEnd = workerManager_nowNs();
+        }
+        if (runCycle || (sleepTime != armedSleep)) {
+            armedSleep = sleepTime;
+            cycleDeadline = (sleepTime == WORKERMANAGER_SLEEP_FOREVER) ? UINT64_MAX
+                          : passEnd + ((uint64_t)sleepTime * 1000ull);
+        }
+        if (cycleDeadline < nextWake) {
+            nextWake = cycleDeadline;
+        }
+
+        runCycle = _waitForWork(threadArgs, nextWake);
+        cycleScheduled = 0;
+        if (workerManager_nowNs() >= cycleDeadline) {
+            runCycle = 1;
+            cycleScheduled = cycleDeadline;
+        }
+    }
+
+    uint8_t state = THREAD_STATE_ISOLATED;
+    if (__atomic_compare_exchange_n(&threadArgs->state, &state, THREAD_STATE_EXITING, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        /* The stuck run returned: give the reader slot back, hand the worker
+         * to the level thread for its end handler and leave. */
+        worker_t *worker = threadArgs->stuckWorker;
+        _snapshotRelease(threadArgs);
+        pthread_mutex_lock(threadArgs->mutex);
+        _readerSlots[threadArgs->prio] &= (uint8_t)~(1u << threadArgs->readerSlot);
+        pthread_mutex_unlock(threadArgs->mutex);
+        _reportEvent(WORKERMANAGER_EVENT_RECOVERED, worker, workerManager_nowNs() - threadArgs->stuckSince);
+
+        _lockList(threadArgs->prio);
+        __atomic_store_n(&worker->lifecycle.isolated, 0, __ATOMIC_RELEASE);
+        _queueLifecycle(worker);
+        pthread_mutex_unlock(&_mutexList[threadArgs->prio]);
+        _wakeThread(threadArgs->prio, 0);
+        return NULL;
+    }
+    if (state == THREAD_STATE_ORPHANED) {
+        return NULL;
+    }
+
+    /* Requests and tasks still queued are applied so that no waiter is left hanging. */
+    _applyLifecycle(threadArgs->prio);
+    (void)workerTask_runPending(threadArgs->prio);
+
+    /* Every worker still dispatched is initialized: end it once. */
+    workerSnapshot_t *snapshot = _snapshotAcquire(threadArgs);
+    uint32_t count = (snapshot != NULL) ? snapshot->count : 0u;
+    for (uint32_t i = 0; (i < count) && _threadServing(threadArgs); i++) {
+        worker_t *worker = snapshot->entries[i].worker;
+        __atomic_store_n(&threadArgs->currentWorker, worker, __ATOMIC_RELEASE);
+        workerCoroutine_discard(worker);
+        worker_handleEnd(worker);
+        worker->lifecycle.initialized = 0;
+    }
+    __atomic_store_n(&threadArgs->currentWorker, NULL, __ATOMIC_RELEASE);
+    if (_threadServing(threadArgs)) {
+        _snapshotRelease(threadArgs);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Apply the scheduling configuration of a priority level to attr.
+ *
+ * @return 1 if attr carries an explicit policy or affinity, 0 otherwise.
+ */
+static uint8_t _setThreadAttributes(pthread_attr_t *attr, uint8_t prio) {
+    const workerManagerPriorityConfig_t *prioConfig = &_config.priority[prio];
+    uint8_t custom = 0;
+
+    if (prioConfig->schedPolicy != SCHED_OTHER) {
+        struct sched_param param;
+        memset(&param, 0x00, sizeof(param));
+        param.sched_priority = prioConfig->schedPriority;
+
+        pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(attr, prioConfig->schedPolicy);
+        pthread_attr_setschedparam(attr, &param);
+        custom = 1;
+    }
+
+    if (prioConfig->cpuAffinity != 0u) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (uint8_t cpu = 0; cpu < 64u; cpu++) {
+            if ((prioConfig->cpuAffinity & (1ull << cpu)) != 0u) {
+                CPU_SET(cpu, &cpuSet);
+            }
+        }
+        pthread_attr_setaffinity_np(attr, sizeof(cpuSet), &cpuSet);
+        custom = 1;
+    }
+
+    return custom;
+}
+
+/**
+ * @brief Create the thread serving a priority list.
+ *
+ * Called with the list writer mutex held (or before any worker thread
+ * exists). If the real-time policy or affinity is refused (typically EPERM
+ * without CAP_SYS_NICE) the thread is started with default attributes.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+static int _createThread(uint8_t prio) {
+    uint8_t slot = 0;
+    while ((slot < WORKERMANAGER_READER_SLOTS) && ((_readerSlots[prio] & (1u << slot)) != 0u)) {
+        slot++;
+    }
+    if (slot == WORKERMANAGER_READER_SLOTS) {
+        printf("Error: too many threads for priority %d\n", prio);
+        return -1;
+    }
+
+    Node_t *pthreadNode = _threadNodeAlloc();
+    if (pthreadNode == NULL) {
+        printf("Error: unable to allocate thread for priority %d\n", prio);
+        return -1;
+    }
+
+    threadNode_t *threadNode = (threadNode_t *)pthreadNode->item;
+    threadNode->metadata.threadArgs.prio = prio;
+    threadNode->metadata.threadArgs.readerSlot = slot;
+    threadNode->metadata.threadArgs.state = THREAD_STATE_RUNNING;
+    threadNode->metadata.threadArgs.currentWorker = NULL;
+    threadNode->metadata.threadArgs.stuckWorker = NULL;
+    threadNode->metadata.threadArgs.stuckSince = 0;
+    threadNode->metadata.threadArgs.generation = 0;
+    threadNode->metadata.threadArgs.sleepTime = _config.priority[prio].sleepTime;
+    threadNode->metadata.threadArgs.mutex = &_mutexList[prio];
+    threadNode->metadata.threadArgs.wakePending = 0;
+    threadNode->metadata.threadArgs.idlePolicy = _config.priority[prio].idlePolicy;
+    threadNode->metadata.threadArgs.spinNs = WORKERMANAGER_SPIN_MIN_NS;
+    threadNode->metadata.threadArgs.runAllPending = 0;
+    threadNode->metadata.threadArgs.useExecutor = _config.priority[prio].useExecutor && workerExecutor_isRunning();
+    workerExecutor_initBatch(&threadNode->metadata.threadArgs.batch);
+
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&threadNode->metadata.threadArgs.wakeMutex, NULL);
+    pthread_cond_init(&threadNode->metadata.threadArgs.wakeCond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if ((_config.stackSize != 0u) && (_config.stackSize >= (size_t)PTHREAD_STACK_MIN)) {
+        pthread_attr_setstacksize(&attr, _config.stackSize);
+    }
+    uint8_t custom = _setThreadAttributes(&attr, prio);
+
+    int rc = pthread_create(threadNode->metadata.thread, &attr, _workManagerHandler,
+                            (void *)&threadNode->metadata.threadArgs);
+    pthread_attr_destroy(&attr);
+
+    if ((rc != 0) && custom) {
+        printf("Warning: priority %d thread attributes refused (%d), using defaults\n", prio, rc);
+        pthread_attr_init(&attr);
+        if ((_config.stackSize != 0u) && (_config.stackSize >= (size_t)PTHREAD_STACK_MIN)) {
+            pthread_attr_setstacksize(&attr, _config.stackSize);
+        }
+        rc = pthread_create(threadNode->metadata.thread, &attr, _workManagerHandler,
+                            (void *)&threadNode->metadata.threadArgs);
+        pthread_attr_destroy(&attr);
+    }
+
+    if (rc != 0) {
+        printf("Error: unable to start thread for priority %d (%d)\n", prio, rc);
+        pthread_cond_destroy(&threadNode->metadata.threadArgs.wakeCond);
+        pthread_mutex_destroy(&threadNode->metadata.threadArgs.wakeMutex);
+        workerExecutor_destroyBatch(&threadNode->metadata.threadArgs.batch);
+        _threadNodeFree(pthreadNode);
+        return -1;
+    }
+
+    _readerSlots[prio] |= (uint8_t)(1u << slot);
+    __atomic_store_n(&_pthreadList[prio], pthreadNode, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * @brief Unlink a worker from the writer-side list of a level.
+ *
+ * The worker leaves the dispatch set right away and is marked idle. Must be
+ * called with the list writer mutex held.
+ *
+ * @return 1 if the worker was found, 0 otherwise.
+ */
+static uint8_t _unlinkWorker(uint8_t prio, worker_t *worker) {
+    Node_t *prev = NULL;
+    for (Node_t *node = _workersList[prio]; node != NULL; node = node->next) {
+        if (node->item == worker) {
+            if (prev != NULL) {
+                prev->next = node->next;
+            } else {
+                _workersList[prio] = node->next;
+            }
+            _nodeFree(node);
+            worker->lifecycle.registered = 0;
+            __atomic_store_n(&worker->metadata.status, WORKER_STATUS_IDLE, __ATOMIC_RELEASE);
+            if (worker->lifecycle.dispatched) {
+                __atomic_store_n(&worker->lifecycle.dispatched, 0, __ATOMIC_RELAXED);
+                (void)_publishSnapshot(prio);
+            }
+            return 1;
+        }
+        prev = node;
+    }
+    return 0;
+}
+
+/**
+ * @brief Move a level away from the thread stuck in a worker.
+ *
+ * The worker is removed from the list and a new thread takes over the
+ * level; the stuck thread is parked on _isolatedList and leaves on its own
+ * once the handler returns, queueing the end of the worker on its way out.
+ * Until then the worker has a pending request, so workerManager_waitWorker()
+ * blocks. Must be called with the list writer mutex held.
+ *
+ * @return 1 if a new thread serves the level, 0 otherwise.
+ */
+static uint8_t _isolateWorker(uint8_t prio, worker_t *worker, uint64_t runStart) {
+    if (_readerSlots[prio] == (uint8_t)((1u << WORKERMANAGER_READER_SLOTS) - 1u)) {
+        return 0;
+    }
+
+    Node_t *pthreadNode = _pthreadList[prio];
+    threadArgs_t *threadArgs = &((threadNode_t *)pthreadNode->item)->metadata.threadArgs;
+
+    (void)_unlinkWorker(prio, worker);
+    __atomic_store_n(&worker->lifecycle.isolated, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&worker->lifecycle.requestSeq, 1u, __ATOMIC_SEQ_CST);
+    threadArgs->stuckWorker = worker;
+    threadArgs->stuckSince = runStart;
+    __atomic_store_n(&threadArgs->state, THREAD_STATE_ISOLATED, __ATOMIC_RELEASE);
+    __atomic_store_n(&_pthreadList[prio], NULL, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&_isolatedMutex);
+    pthreadNode->next = _isolatedList;
+    _isolatedList = pthreadNode;
+    pthread_mutex_unlock(&_isolatedMutex);
+
+    /* On failure the level gets a thread again on the next addWorker/submit. */
+    return (_createThread(prio) == 0) ? 1u : 0u;
+}
+
+/**
+ * @brief Look for stuck runs on one level and report them.
+ *
+ * Callbacks are invoked without the list mutex held, the scan then starts
+ * over; a run is reported once (see worker_t::watchdog.reportedStart).
+ */
+static void _watchdogScan(uint8_t prio) {
+    uint64_t timeout = (uint64_t)_config.watchdog.stuckTimeout * 1000ull;
+    uint8_t rescan = 1;
+
+    while (rescan) {
+        rescan = 0;
+        worker_t *stuck = NULL;
+        uint64_t elapsed = 0;
+        uint8_t isolated = 0;
+
+        _lockList(prio);
+        uint64_t now = workerManager_nowNs();
+        for (Node_t *node = _workersList[prio]; node != NULL; node = node->next) {
+            worker_t *worker = (worker_t *)node->item;
+            uint64_t runStart = __atomic_load_n(&worker->watchdog.runStart, __ATOMIC_ACQUIRE);
+            if ((runStart == 0u) || (runStart == worker->watchdog.reportedStart) || ((now - runStart) < timeout)) {
+                continue;
+            }
+
+            worker->watchdog.reportedStart = runStart;
+            stuck = worker;
+            elapsed = now - runStart;
+
+            Node_t *pthreadNode = _pthreadList[prio];
+            if ((_config.watchdog.action == WORKERMANAGER_WATCHDOG_ISOLATE) && (pthreadNode != NULL) &&
+                (__atomic_load_n(&((threadNode_t *)pthreadNode->item)->metadata.threadArgs.currentWorker,
+                                 __ATOMIC_ACQUIRE) == worker)) {
+                isolated = _isolateWorker(prio, worker, runStart);
+            }
+            break;
+        }
+        pthread_mutex_unlock(&_mutexList[prio]);
+
+        if (stuck != NULL) {
+            _reportEvent(WORKERMANAGER_EVENT_STUCK, stuck, elapsed);
+            if (isolated) {
+                _reportEvent(WORKERMANAGER_EVENT_ISOLATED, stuck, elapsed);
+            }
+            rescan = 1;
+        }
+    }
+}
+
+/**
+ * @brief Watchdog thread routine: scan every level each checkPeriod.
+ */
+static void *_watchdogHandler(void *args) {
+    (void)args;
+
+    pthread_mutex_lock(&_watchdogMutex);
+    while (_watchdogRunning) {
+        struct timespec ts;
+        _nsToTimespec(workerManager_nowNs() + ((uint64_t)_config.watchdog.checkPeriod * 1000ull), &ts);
+        int rc = 0;
+        while (_watchdogRunning && (rc == 0)) {
+            rc = pthread_cond_timedwait(&_watchdogCond, &_watchdogMutex, &ts);
+        }
+        if (!_watchdogRunning) {
+            break;
+        }
+        pthread_mutex_unlock(&_watchdogMutex);
+
+        for (uint8_t prio = 0; prio < _priorityNum; prio++) {
+            _watchdogScan(prio);
+        }
+
+        pthread_mutex_lock(&_watchdogMutex);
+    }
+    pthread_mutex_unlock(&_watchdogMutex);
+
+    return NULL;
+}
+
+/**
+ * @brief Start the watchdog thread if the configuration asks for one.
+ */
+static void _startWatchdog(void) {
+    _watchdogActive = 0;
+    if ((_config.watchdog.checkPeriod == 0u) || (_config.watchdog.stuckTimeout == 0u)) {
+        return;
+    }
+
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_watchdogCond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+
+    _watchdogRunning = 1;
+    if (pthread_create(&_watchdogThread, NULL, _watchdogHandler, NULL) != 0) {
+        printf("Warning: unable to start the watchdog thread\n");
+        _watchdogRunning = 0;
+        pthread_cond_destroy(&_watchdogCond);
+        return;
+    }
+    _watchdogActive = 1;
+}
+
+/**
+ * @brief Stop and join the watchdog thread.
+ */
+static void _stopWatchdog(void) {
+    if (!_watchdogActive) {
+        return;
+    }
+
+    pthread_mutex_lock(&_watchdogMutex);
+    _watchdogRunning = 0;
+    pthread_cond_signal(&_watchdogCond);
+    pthread_mutex_unlock(&_watchdogMutex);
+
+    pthread_join(_watchdogThread, NULL);
+    pthread_cond_destroy(&_watchdogCond);
+}
+
+/**
+ * @brief Join a dispatch thread within the configured join timeout.
+ *
+ * A thread still stuck after the timeout is reported, marked ORPHANED and
+ * detached; it leaves without touching anything once its handler returns.
+ *
+ * @return 1 if the thread was joined, 0 if it was orphaned.
+ */
+static uint8_t _joinDispatchThread(threadNode_t *threadNode) {
+    threadArgs_t *threadArgs = &threadNode->metadata.threadArgs;
+
+    if (workerManager_joinThread(*(threadNode->metadata.thread), _config.watchdog.joinTimeout) == 0) {
+        return 1;
+    }
+
+    uint8_t state = __atomic_load_n(&threadArgs->state, __ATOMIC_ACQUIRE);
+    if ((state == THREAD_STATE_EXITING) ||
+        !__atomic_compare_exchange_n(&threadArgs->state, &state, THREAD_STATE_ORPHANED, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        /* Already on its way out. */
+        pthread_join(*(threadNode->metadata.thread), NULL);
+        return 1;
+    }
+
+    pthread_detach(*(threadNode->metadata.thread));
+    worker_t *worker = __atomic_load_n(&threadArgs->currentWorker, __ATOMIC_ACQUIRE);
+    if (worker == NULL) {
+        worker = threadArgs->stuckWorker;
+    }
+    uint64_t runStart = (worker != NULL) ? __atomic_load_n(&worker->watchdog.runStart, __ATOMIC_ACQUIRE) : 0u;
+    _reportEvent(WORKERMANAGER_EVENT_JOIN_TIMEOUT, worker, (runStart != 0u) ? (workerManager_nowNs() - runStart) : 0u);
+    return 0;
+}
+
+/**
+ * @brief Release the resources of a joined dispatch thread.
+ */
+static void _destroyThreadNode(Node_t *pthreadNode) {
+    threadNode_t *threadNode = (threadNode_t *)pthreadNode->item;
+    pthread_cond_destroy(&threadNode->metadata.threadArgs.wakeCond);
+    pthread_mutex_destroy(&threadNode->metadata.threadArgs.wakeMutex);
+    workerExecutor_destroyBatch(&threadNode->metadata.threadArgs.batch);
+    _threadNodeFree(pthreadNode);
+}
+
+/*************** PUBLIC SECTION ***************/
+
+/**
+ * @brief Fill a configuration with the defaults used by workerManager_init().
+ */
+void workerManager_getDefaultConfig(workerManagerConfig_t *config) {
+    if (config == NULL) {
+        return;
+    }
+
+    memset(config, 0x00, sizeof(workerManagerConfig_t));
+    config->priorityNum = WORKERMANAGER_PRIORITY_NUM;
+    config->stackSize = 0;
+    for (uint8_t i = 0; i < WORKERMANAGER_PRIORITY_NUM; i++) {
+        config->priority[i].threadMode = WORKERMANAGER_THREAD_EAGER;
+        config->priority[i].cpuAffinity = 0;
+        config->priority[i].schedPolicy = SCHED_OTHER;
+        config->priority[i].schedPriority = 0;
+        config->priority[i].sleepTime = WORKERMANAGER_DEFAULT_SLEEP_TIME;
+        config->priority[i].useExecutor = 0;
+        config->priority[i].idlePolicy = WORKERMANAGER_IDLE_BLOCK;
+    }
+    config->executorThreads = 0;
+}
+
+/**
+ * @brief Initialize the worker manager and start priority threads.
+ */
+void workerManager_init(void) {
+    workerManagerConfig_t config;
+    workerManager_getDefaultConfig(&config);
+    (void)workerManager_initEx(&config);
+}
+
+/**
+ * @brief Initialize the worker manager with an explicit configuration.
+ */
+int workerManager_initEx(const workerManagerConfig_t *config) {
+    if ((config == NULL) || (config->priorityNum == 0u) ||
+        (config->priorityNum > WORKERMANAGER_PRIORITY_NUM)) {
+        printf("Error: invalid worker manager configuration\n");
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < config->priorityNum; i++) {
+        int policy = config->priority[i].schedPolicy;
+        if ((config->priority[i].threadMode > WORKERMANAGER_THREAD_DISABLED) ||
+            (config->priority[i].idlePolicy > WORKERMANAGER_IDLE_ADAPTIVE) ||
+            ((policy != SCHED_OTHER) && (policy != SCHED_FIFO) && (policy != SCHED_RR))) {
+            printf("Error: invalid configuration for priority %d\n", i);
+            return -1;
+        }
+    }
+
+    if (config->watchdog.action > WORKERMANAGER_WATCHDOG_ISOLATE) {
+        printf("Error: invalid watchdog action\n");
+        return -1;
+    }
+
+    _config = *config;
+    _priorityNum = config->priorityNum;
+    workerManagerRunning = 1;
+    _epochNs = workerManager_nowNs();
+
+    for (uint8_t i = 0; i < WORKERMANAGER_PRIORITY_NUM; i++) {
+        _workersList[i] = NULL;
+        _snapshotList[i] = NULL;
+        _retiredList[i] = NULL;
+        memset(_readerSeq[i], 0x00, sizeof(_readerSeq[i]));
+        _readerSlots[i] = 0;
+        _pthreadList[i] = NULL;
+        pthread_mutex_init(&_mutexList[i], NULL);
+    }
+
+    /* Before any dispatch thread: they read _watchdogActive without synchronization. */
+    _startWatchdog();
+
+    uint8_t executorNeeded = 0;
+    for (uint8_t i = 0; i < _priorityNum; i++) {
+        executorNeeded |= _config.priority[i].useExecutor;
+    }
+    if (executorNeeded && (_config.executorThreads != 0u)) {
+        uint16_t threads = (_config.executorThreads == WORKERMANAGER_EXECUTOR_AUTO) ? 0u : _config.executorThreads;
+        if (workerExecutor_start(threads, _priorityNum, _config.stackSize) != 0) {
+            printf("Warning: executor pool unavailable, levels run on their own thread\n");
+        }
+    }
+
+    for (uint8_t i = 0; i < _priorityNum; i++) {
+        if (_config.priority[i].threadMode == WORKERMANAGER_THREAD_EAGER) {
+            (void)_createThread(i);
+        }
+    }
+
+    return 0;
+}
+
+ /**
+  * @brief Add a worker to a given priority level.
+  * 
+  * @param worker Pointer to the worker definition.
+  * @param prio Priority index [0 - N). Lower index = higher priority.
+  */
+void workerManager_addWorker(worker_t *worker, uint8_t prio) {
+    if (prio >= _priorityNum) {
+        printf("Error: Priority %d exceeds allowed range\n", prio);
+        return;
+    }
+
+    if (_config.priority[prio].threadMode == WORKERMANAGER_THREAD_DISABLED) {
+        printf("Error: Priority %d has no thread\n", prio);
+        return;
+    }
+
+    if (worker->lifecycle.registered || __atomic_load_n(&worker->lifecycle.isolated, __ATOMIC_ACQUIRE) ||
+        (__atomic_load_n(&worker->lifecycle.queued, __ATOMIC_ACQUIRE) && (worker->metadata.priority != prio))) {
+        /* Still owned by a level: wait for it with workerManager_waitWorker(). */
+        printf("Error: worker %s is still registered\n", worker->metadata.name);
+        return;
+    }
+
+    _lockList(prio);
+
+    Node_t **workerList = &_workersList[prio];
+    while ((*workerList) != NULL) {
+        workerList = (Node_t **)&((*workerList)->next);
+    }
+
+    *workerList = _nodeAlloc(worker);
+    if (*workerList == NULL) {
+        printf("Error: unable to add worker %s\n", worker->metadata.name);
+        pthread_mutex_unlock(&_mutexList[prio]);
+        return;
+    }
+    if (worker->io.count != 0u) {
+        (void)_levelIoCreate(prio);
+    }
+    worker->metadata.priority = prio;
+    worker->lifecycle.registered = 1;
+    /* A notification sent while the worker was out of the level is stale. */
+    __atomic_store_n(&worker->schedule.notified, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&worker->metadata.status, WORKER_STATUS_ACTIVE, __ATOMIC_RELEASE);
+    _queueLifecycle(worker);
+
+    if (workerManagerRunning && (_pthreadList[prio] == NULL)) {
+        (void)_createThread(prio);
+    }
+
+    pthread_mutex_unlock(&_mutexList[prio]);
+    _wakeThread(prio, 0);
+}
+
+/**
+ * @brief Remove a worker from any priority level.
+ *
+ * The level thread applies the removal between two passes, so once it has
+ * no run of the worker is in progress. Waiting for that from a thread the
+ * pass depends on would never return: such callers only queue the removal.
+ * 
+ * @param worker Pointer to the worker to remove.
+ */
+void workerManager_removeWorker(worker_t *worker) {
+    for (uint8_t prio = 0; prio < _priorityNum; prio++) {
+        _lockList(prio);
+        uint8_t found = _unlinkWorker(prio, worker);
+        uint8_t served = 0;
+        if (found) {
+            _queueLifecycle(worker);
+            served = (_pthreadList[prio] != NULL);
+        }
+        pthread_mutex_unlock(&_mutexList[prio]);
+        if (found) {
+            _wakeThread(prio, 0);
+            /* A thread leaving on workerManager_end() may already be past its last apply. */
+            while (served && ((_callerLevels & (1u << prio)) == 0u) &&
+                   (workerManager_waitWorker(worker, WORKERMANAGER_REMOVE_POLL) != 0) && workerManagerRunning) {
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Stop all worker threads and cleanup resources.
+ */
+void workerManager_end(void) {
+    __atomic_store_n(&workerManagerRunning, 0, __ATOMIC_SEQ_CST);
+    _stopWatchdog();
+
+    for (uint8_t i = 0; i < _priorityNum; i++) {
+        _wakeThread(i, 0);
+    }
+
+    Node_t *joinedList[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+    uint8_t orphaned[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+    for (uint8_t i = 0; i < _priorityNum; i++) {
+        /* Serialize with a lazy thread creation still in progress. */
+        _lockList(i);
+        joinedList[i] = _pthreadList[i];
+        __atomic_store_n(&_pthreadList[i], NULL, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&_mutexList[i]);
+
+        if ((joinedList[i] != NULL) && !_joinDispatchThread((threadNode_t *)joinedList[i]->item)) {
+            joinedList[i] = NULL;
+            orphaned[i] = 1;
+        }
+    }
+
+    pthread_mutex_lock(&_isolatedMutex);
+    Node_t *isolatedList = _isolatedList;
+    _isolatedList = NULL;
+    pthread_mutex_unlock(&_isolatedMutex);
+    Node_t *joinedIsolated = NULL;
+    while (isolatedList != NULL) {
+        Node_t *next = isolatedList->next;
+        threadNode_t *threadNode = (threadNode_t *)isolatedList->item;
+        if (_joinDispatchThread(threadNode)) {
+            isolatedList->next = joinedIsolated;
+            joinedIsolated = isolatedList;
+        } else {
+            orphaned[threadNode->metadata.threadArgs.prio] = 1;
+        }
+        isolatedList = next;
+    }
+
+    /* Pool threads may still be signalling a batch: stop them first. */
+    uint8_t poolStopped = (workerExecutor_stop(_config.watchdog.joinTimeout) == 0);
+    if (!poolStopped) {
+        _reportEvent(WORKERMANAGER_EVENT_JOIN_TIMEOUT, NULL, 0u);
+    }
+
+    /* An isolated thread leaves without waiting for its batch: free it only once
+     * no pool thread can still run one of its jobs, otherwise leak it. */
+    while (poolStopped && (joinedIsolated != NULL)) {
+        Node_t *next = joinedIsolated->next;
+        _destroyThreadNode(joinedIsolated);
+        joinedIsolated = next;
+    }
+
+    /* Requests queued once the level thread was gone (an isolated worker
+     * released late, a racing add or stop) are applied here, and the workers
+     * they initialized are ended, as the level thread would have done. */
+    for (uint8_t i = 0; i < _priorityNum; i++) {
+        if (orphaned[i] || (__atomic_load_n(&_lifecycleQueue[i], __ATOMIC_ACQUIRE) == NULL)) {
+            continue;
+        }
+        _applyLifecycle(i);
+        for (Node_t *node = _workersList[i]; node != NULL; node = node->next) {
+            worker_t *worker = (worker_t *)node->item;
+            if (worker->lifecycle.initialized) {
+                workerCoroutine_discard(worker);
+                worker_handleEnd(worker);
+                worker->lifecycle.initialized = 0;
+            }
+        }
+    }
+
+    /* Tasks pushed after their level thread left are never run: fail their handles. */
+    while (__atomic_load_n(&_submitters, __ATOMIC_SEQ_CST) != 0u) {
+        sched_yield();
+    }
+    for (uint8_t i = 0; i < _priorityNum; i++) {
+        (void)workerTask_cancelPending(i);
+    }
+
+    uint8_t anyOrphaned = 0;
+    for (uint8_t i = 0; i < _priorityNum; i++) {
+        anyOrphaned |= orphaned[i];
+    }
+    if (!anyOrphaned) {
+        workerCoroutine_releasePool();
+    }
+
+    for (uint8_t i = 0; i < _priorityNum; i++) {
+        if (joinedList[i] != NULL) {
+            _destroyThreadNode(joinedList[i]);
+        }
+
+        /* An orphaned thread may still read this level: leak it. */
+        if (!orphaned[i]) {
+            pthread_mutex_destroy(&_mutexList[i]);
+
+            /* end handlers already ran on the level thread. */
+            for (Node_t *node = _workersList[i]; node != NULL; node = node->next) {
+                worker_t *worker = (worker_t *)node->item;
+                (void)_armWorkerIo(i, worker, 0);
+                worker->lifecycle.registered = 0;
+                __atomic_store_n(&worker->lifecycle.dispatched, 0, __ATOMIC_RELAXED);
+                __atomic_store_n(&worker->metadata.status, WORKER_STATUS_IDLE, __ATOMIC_RELEASE);
+            }
+
+            if (_levelIo[i] != NULL) {
+                _levelIoDestroy(_levelIo[i]);
+            }
+            if (_snapshotList[i] != NULL) {
+                _snapshotFree(_snapshotList[i]);
+            }
+            while (_retiredList[i] != NULL) {
+                workerSnapshot_t *next = _retiredList[i]->nextRetired;
+                _snapshotFree(_retiredList[i]);
+                _retiredList[i] = next;
+            }
+        }
+
+        while (_workersList[i] != NULL) {
+            Node_t *next = _workersList[i]->next;
+            _nodeFree(_workersList[i]);
+            _workersList[i] = next;
+        }
+        _republishPending[i] = 0;
+        _snapshotList[i] = NULL;
+        _retiredList[i] = NULL;
+        _lifecycleQueue[i] = NULL;
+        _levelIo[i] = NULL;
+    }
+}
+
+/**
+* @brief Set the sleep time for the specific priority list.
+*/
+void workerManager_setPriorityListSleepTime(uint8_t prio, uint32_t sleepTime)
+{
+    if (prio >= _priorityNum) {
+        printf("Error: Priority %d exceeds allowed range\n", prio);
+    }
+    else{
+        _lockList(prio);
+        _config.priority[prio].sleepTime = sleepTime;
+        if (_pthreadList[prio] != NULL) {
+            threadNode_t *threadNode = (threadNode_t *)_pthreadList[prio]->item;
+            __atomic_store_n(&threadNode->metadata.threadArgs.sleepTime, sleepTime, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&_mutexList[prio]);
+        _wakeThread(prio, 0);
+    }
+}
+
+/**
+ * @brief Set the idle policy of the specific priority list.
+ */
+void workerManager_setPriorityListIdlePolicy(uint8_t prio, workerManagerIdlePolicy_t policy)
+{
+    if (prio >= _priorityNum) {
+        printf("Error: Priority %d exceeds allowed range\n", prio);
+    }
+    else if (policy > WORKERMANAGER_IDLE_ADAPTIVE) {
+        printf("Error: invalid idle policy %d\n", policy);
+    }
+    else{
+        _lockList(prio);
+        _config.priority[prio].idlePolicy = (uint8_t)policy;
+        if (_pthreadList[prio] != NULL) {
+            threadNode_t *threadNode = (threadNode_t *)_pthreadList[prio]->item;
+            __atomic_store_n(&threadNode->metadata.threadArgs.idlePolicy, (uint8_t)policy, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&_mutexList[prio]);
+        /* A thread spinning forever must see the change. */
+        _wakeThread(prio, 0);
+    }
+}
+
+/**
+ * @brief Resume a stopped worker.
+ */
+void workerManager_startWorker(worker_t *worker)
+{
+    if ((worker == NULL) || (worker->metadata.priority >= _priorityNum)) {
+        return;
+    }
+
+    uint8_t prio = worker->metadata.priority;
+    _lockList(prio);
+    uint8_t queued = 0;
+    if (worker->lifecycle.registered && (worker->metadata.status != WORKER_STATUS_ACTIVE)) {
+        /* A notification sent while the worker was stopped is stale. */
+        __atomic_store_n(&worker->schedule.notified, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&worker->metadata.status, WORKER_STATUS_ACTIVE, __ATOMIC_RELEASE);
+        _queueLifecycle(worker);
+        queued = 1;
+    }
+    pthread_mutex_unlock(&_mutexList[prio]);
+
+    if (queued) {
+        _wakeThread(prio, 0);
+    }
+}
+
+/**
+ * @brief Pause a worker without removing it from its level.
+ */
+void workerManager_stopWorker(worker_t *worker)
+{
+    if ((worker == NULL) || (worker->metadata.priority >= _priorityNum)) {
+        return;
+    }
+
+    uint8_t prio = worker->metadata.priority;
+    _lockList(prio);
+    uint8_t queued = 0;
+    if (worker->lifecycle.registered && (worker->metadata.status == WORKER_STATUS_ACTIVE)) {
+        __atomic_store_n(&worker->metadata.status, WORKER_STATUS_IDLE, __ATOMIC_RELEASE);
+        if (worker->lifecycle.dispatched) {
+            __atomic_store_n(&worker->lifecycle.dispatched, 0, __ATOMIC_RELAXED);
+            (void)_publishSnapshot(prio);
+        }
+        _queueLifecycle(worker);
+        queued = 1;
+    }
+    pthread_mutex_unlock(&_mutexList[prio]);
+
+    if (queued) {
+        _wakeThread(prio, 0);
+    }
+}
+
+/**
+ * @brief Wait until the priority thread applied the last request on a worker.
+ */
+int workerManager_waitWorker(worker_t *worker, uint32_t timeout)
+{
+    if (worker == NULL) {
+        return -1;
+    }
+
+    pthread_once(&_lifecycleOnce, _lifecycleInit);
+
+    struct timespec ts;
+    if (timeout != WORKERMANAGER_SLEEP_FOREVER) {
+        _nsToTimespec(workerManager_nowNs() + ((uint64_t)timeout * 1000ull), &ts);
+    }
+
+    int rc = 0;
+    pthread_mutex_lock(&_lifecycleMutex);
+    __atomic_fetch_add(&_lifecycleWaiters, 1u, __ATOMIC_SEQ_CST);
+    while ((__atomic_load_n(&worker->lifecycle.appliedSeq, __ATOMIC_SEQ_CST) !=
+            __atomic_load_n(&worker->lifecycle.requestSeq, __ATOMIC_SEQ_CST)) && (rc == 0)) {
+        if (timeout == WORKERMANAGER_SLEEP_FOREVER) {
+            rc = pthread_cond_wait(&_lifecycleCond, &_lifecycleMutex);
+        } else {
+            rc = pthread_cond_timedwait(&_lifecycleCond, &_lifecycleMutex, &ts);
+        }
+    }
+    __atomic_fetch_sub(&_lifecycleWaiters, 1u, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&_lifecycleMutex);
+
+    return (__atomic_load_n(&worker->lifecycle.appliedSeq, __ATOMIC_SEQ_CST) ==
+            __atomic_load_n(&worker->lifecycle.requestSeq, __ATOMIC_SEQ_CST)) ? 0 : -1;
+}
+
+/**
+ * @brief Return 1 if target can be reached from worker through successor edges.
+ */
+static uint8_t _reachable(const worker_t *worker, const worker_t *target) {
+    if (worker == target) {
+        return 1;
+    }
+
+    for (uint8_t i = 0; i < worker->dependency.successorCount; i++) {
+        if (_reachable((const worker_t *)worker->dependency.successor[i], target)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Make a worker run after another one completes.
+ */
+int workerManager_addDependency(worker_t *worker, worker_t *dependsOn)
+{
+    if ((worker == NULL) || (dependsOn == NULL)) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&_dependencyMutex);
+
+    for (uint8_t i = 0; i < dependsOn->dependency.successorCount; i++) {
+        if (dependsOn->dependency.successor[i] == worker) {
+            printf("Error: %s already depends on %s\n", worker->metadata.name, dependsOn->metadata.name);
+            pthread_mutex_unlock(&_dependencyMutex);
+            return -1;
+        }
+    }
+
+    if (_reachable(worker, dependsOn)) {
+        printf("Error: dependency %s -> %s would create a cycle\n", dependsOn->metadata.name, worker->metadata.name);
+        pthread_mutex_unlock(&_dependencyMutex);
+        return -1;
+    }
+
+    if ((dependsOn->dependency.successorCount >= WORKER_MAX_SUCCESSORS) ||
+        (worker->dependency.predecessorCount >= WORKER_MAX_PREDECESSORS)) {
+        printf("Error: too many dependencies between %s and %s\n", dependsOn->metadata.name, worker->metadata.name);
+        pthread_mutex_unlock(&_dependencyMutex);
+        return -1;
+    }
+
+    /* Fill the edge before publishing the counts read by running threads. */
+    uint8_t index = dependsOn->dependency.successorCount;
+    dependsOn->dependency.successor[index] = worker;
+    dependsOn->dependency.successorBit[index] = 1u << worker->dependency.predecessorCount;
+    __atomic_store_n(&worker->dependency.predecessorCount, worker->dependency.predecessorCount + 1u, __ATOMIC_RELEASE);
+    __atomic_store_n(&dependsOn->dependency.successorCount, index + 1u, __ATOMIC_RELEASE);
+
+    /* Entries of running workers carry the trigger flags: rebuild them. */
+    worker_t *changed[2] = { worker, dependsOn };
+    for (uint8_t i = 0; i < 2u; i++) {
+        uint8_t prio = changed[i]->metadata.priority;
+        if (workerManagerRunning && (prio < _priorityNum)) {
+            _lockList(prio);
+            if (changed[i]->lifecycle.dispatched) {
+                (void)_publishSnapshot(prio);
+            }
+            pthread_mutex_unlock(&_mutexList[prio]);
+        }
+    }
+
+    pthread_mutex_unlock(&_dependencyMutex);
+    return 0;
+}
+
+/**
+ * @brief Run a worker whenever a file descriptor becomes ready.
+ */
+int workerManager_addWorkerFd(worker_t *worker, int fd, uint32_t events)
+{
+    if ((worker == NULL) || (fd < 0)) {
+        return -1;
+    }
+
+    /* Descriptors of a worker not added yet are armed by its first start. */
+    uint8_t prio = worker->metadata.priority;
+    uint8_t locked = workerManagerRunning && (prio < _priorityNum);
+    if (locked) {
+        _lockList(prio);
+    }
+
+    int rc = -1;
+    uint8_t known = 0;
+    for (uint8_t i = 0; i < worker->io.count; i++) {
+        known |= (worker->io.fd[i] == fd);
+    }
+
+    if (known) {
+        printf("Error: fd %d already watched for worker %s\n", fd, worker->metadata.name);
+    } else if (worker->io.count >= WORKER_MAX_FDS) {
+        printf("Error: too many fds for worker %s\n", worker->metadata.name);
+    } else if (locked && worker->lifecycle.registered && (_levelIoCreate(prio) == NULL)) {
+        /* Reported by _levelIoCreate(). */
+    } else if (worker->io.armed) {
+        struct epoll_event event;
+        memset(&event, 0x00, sizeof(event));
+        event.events = events;
+        event.data.ptr = worker;
+        if (epoll_ctl(_levelIo[prio]->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            printf("Error: unable to watch fd %d of worker %s (%d)\n", fd, worker->metadata.name, errno);
+        } else {
+            worker->io.fd[worker->io.count] = fd;
+            worker->io.events[worker->io.count] = events;
+            worker->io.count++;
+            rc = 0;
+        }
+    } else {
+        worker->io.fd[worker->io.count] = fd;
+        worker->io.events[worker->io.count] = events;
+        worker->io.count++;
+        rc = 0;
+        /* First descriptor of a running worker: a descriptor epoll refuses is not kept. */
+        if (locked && worker->lifecycle.dispatched && (_armWorkerIo(prio, worker, 1) != 0)) {
+            worker->io.count--;
+            rc = -1;
+        }
+    }
+
+    uint8_t wake = locked && worker->lifecycle.registered && (rc == 0);
+    if (locked) {
+        pthread_mutex_unlock(&_mutexList[prio]);
+    }
+    /* Moves a thread waiting on its condition variable to epoll. */
+    if (wake) {
+        _wakeThread(prio, 0);
+    }
+    return rc;
+}
+
+/**
+ * @brief Stop watching a descriptor registered with workerManager_addWorkerFd().
+ */
+int workerManager_removeWorkerFd(worker_t *worker, int fd)
+{
+    if (worker == NULL) {
+        return -1;
+    }
+
+    uint8_t prio = worker->metadata.priority;
+    uint8_t locked = workerManagerRunning && (prio < _priorityNum);
+    if (locked) {
+        _lockList(prio);
+    }
+
+    int rc = -1;
+    for (uint8_t i = 0; i < worker->io.count; i++) {
+        if (worker->io.fd[i] != fd) {
+            continue;
+        }
+        if (worker->io.armed && (_levelIo[prio] != NULL)) {
+            struct epoll_event event;
+            memset(&event, 0x00, sizeof(event));
+            (void)epoll_ctl(_levelIo[prio]->epollFd, EPOLL_CTL_DEL, fd, &event);
+        }
+        worker->io.count--;
+        worker->io.fd[i] = worker->io.fd[worker->io.count];
+        worker->io.events[i] = worker->io.events[worker->io.count];
+        rc = 0;
+        break;
+    }
+
+    if (locked) {
+        pthread_mutex_unlock(&_mutexList[prio]);
+    }
+    return rc;
+}
+
+/**
+ * @brief Wake the priority thread owning the worker so it runs the worker now.
+ */
+void workerManager_notify(worker_t *worker)
+{
+    if ((worker == NULL) || (worker->metadata.priority >= _priorityNum)) {
+        return;
+    }
+
+    __atomic_store_n(&worker->schedule.notified, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&_notifyPending[worker->metadata.priority], 1, __ATOMIC_RELEASE);
+    _wakeThread(worker->metadata.priority, 0);
+}
+
+/**
+ * @brief workerManager_notify() with a generic signature.
+ */
+void workerManager_notifyHook(void *worker)
+{
+    workerManager_notify((worker_t *)worker);
+}
+
+/**
+ * @brief Submit a one-shot task to the thread of a priority level.
+ */
+workerTaskHandle_t workerManager_submit(workerTaskFn_t handler, void *arg, uint8_t prio)
+{
+    workerTaskHandle_t handle = { NULL, 0 };
+
+    if ((handler == NULL) || (prio >= _priorityNum) ||
+        (_config.priority[prio].threadMode == WORKERMANAGER_THREAD_DISABLED)) {
+        return handle;
+    }
+
+    /* Announced before the running check: workerManager_end() waits for the
+     * push, then cancels whatever no level thread will run any more. */
+    __atomic_add_fetch(&_submitters, 1u, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&workerManagerRunning, __ATOMIC_SEQ_CST)) {
+        __atomic_sub_fetch(&_submitters, 1u, __ATOMIC_SEQ_CST);
+        return handle;
+    }
+
+    if (__atomic_load_n(&_pthreadList[prio], __ATOMIC_ACQUIRE) == NULL) {
+        _lockList(prio);
+        if (workerManagerRunning && (_pthreadList[prio] == NULL)) {
+            (void)_createThread(prio);
+        }
+        pthread_mutex_unlock(&_mutexList[prio]);
+    }
+
+    void *task = workerTask_acquire(handler, arg, &handle);
+    if (task != NULL) {
+        workerTask_push(prio, task);
+        _wakeThread(prio, 0);
+    }
+    __atomic_sub_fetch(&_submitters, 1u, __ATOMIC_SEQ_CST);
+
+    return handle;
+}
+
+/**
+ * @brief Wake the thread of a priority list so it runs a cycle now.
+ */
+void workerManager_notifyPriority(uint8_t prio)
+{
+    if (prio >= _priorityNum) {
+        printf("Error: Priority %d exceeds allowed range\n", prio);
+        return;
+    }
+
+    _wakeThread(prio, 1);
+}
+
+/**
+ * @brief Copy the runtime statistics of a worker.
+ */
+int workerManager_getStats(const worker_t *worker, workerStats_t *stats)
+{
+#if WORKERMANAGER_STATS
+    if ((worker == NULL) || (stats == NULL)) {
+        return -1;
+    }
+
+    if (worker->stats == NULL) {
+        return -1;
+    }
+
+    workerStats_copy(stats, worker->stats);
+    return 0;
+#else
+    (void)worker;
+    (void)stats;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Clear the runtime statistics of a worker.
+ */
+void workerManager_resetStats(worker_t *worker)
+{
+#if WORKERMANAGER_STATS
+    if ((worker != NULL) && (worker->stats != NULL)) {
+        workerStats_reset(worker->stats);
+    }
+#else
+    (void)worker;
+#endif
+}
+
+/**
+ * @brief Print the statistics of every registered worker on stdout.
+ */
+void workerManager_dumpStats(void)
+{
+#if WORKERMANAGER_STATS
+    for (uint8_t prio = 0; prio < _priorityNum; prio++) {
+        _lockList(prio);
+        for (Node_t *node = _workersList[prio]; node != NULL; node = node->next) {
+            worker_t *worker = (worker_t *)node->item;
+            if (worker->stats != NULL) {
+                workerStats_print(worker->metadata.name, prio, worker->stats);
+            }
+        }
+        pthread_mutex_unlock(&_mutexList[prio]);
     }
+#else
+    printf("workerManager: statistics disabled (build with WORKERMANAGER_STATS=1)\n");
+#endif
 }
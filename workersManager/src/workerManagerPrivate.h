@@ -0,0 +1,94 @@
+/**
+ * @file workerManagerPrivate.h
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 12 APR 2025
+ * @brief Hooks shared between the workersManager translation units.
+ *
+ * This header is private to the workersManager sources.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#ifndef WORKER_MANAGER_PRIVATE_H
+#define WORKER_MANAGER_PRIVATE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "worker.h"
+#include "workerStats.h"
+
+/**
+ * @brief Read the monotonic clock in nanoseconds.
+ */
+uint64_t workerManager_nowNs(void);
+
+/**
+ * @brief Join a thread, giving up after timeout µs.
+ *
+ * @param thread Thread to join.
+ * @param timeout Maximum wait in µs, 0 = wait forever.
+ * @return 0 once joined, an error number (ETIMEDOUT) otherwise.
+ */
+int workerManager_joinThread(pthread_t thread, uint32_t timeout);
+
+/**
+ * @brief Run parameters copied from a worker when it was started.
+ *
+ * Every dispatch path runs the worker from this copy, never from the live
+ * worker_t fields, so that editing a started worker has no effect until it
+ * is stopped and started again.
+ */
+typedef struct {
+    void (*handler)(void *args);   /**< Copy of run.handler. */
+    void *args;                    /**< Copy of run.args. */
+    uint64_t period;               /**< Activation period in ns, 0 = not periodic (triggered workers included). */
+} workerRun_t;
+
+/**
+ * @brief Run the run handler of a worker with the manager instrumentation.
+ *
+ * Every dispatch path (priority threads and executor pool) goes through
+ * this function.
+ *
+ * @param worker Worker to run.
+ * @param run Run parameters of the worker, valid until the call returns.
+ * @param scheduled Time the run was due at in ns, 0 if unknown.
+ */
+void workerManager_runWorker(worker_t *worker, const workerRun_t *run, uint64_t scheduled);
+
+#if WORKERMANAGER_STATS
+/**
+ * @brief Account for one completed run. Called by the thread running the worker only.
+ *
+ * @param stats Statistics of the worker.
+ * @param start Time the run started at in ns.
+ * @param duration Time spent running in ns (every slice of a coroutine run).
+ * @param scheduled Time the run was due at in ns, 0 if unknown.
+ */
+void workerStats_record(workerStats_t *stats, uint64_t start, uint64_t duration, uint64_t scheduled);
+
+/**
+ * @brief Count an overrun. Called by the thread running the worker only.
+ */
+void workerStats_recordOverrun(workerStats_t *stats);
+
+/**
+ * @brief Copy statistics updated concurrently by a dispatch thread.
+ */
+void workerStats_copy(workerStats_t *dst, const workerStats_t *src);
+
+/**
+ * @brief Clear statistics.
+ */
+void workerStats_reset(workerStats_t *stats);
+
+/**
+ * @brief Print a one-line summary of a worker's statistics on stdout.
+ */
+void workerStats_print(const char *name, uint8_t prio, const workerStats_t *stats);
+#endif
+
+#endif // WORKER_MANAGER_PRIVATE_H
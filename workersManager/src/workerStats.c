@@ -0,0 +1,163 @@
+/**
+ *  \file workerStats.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 12 APR 2025
+ *
+ *  \brief Per-worker runtime statistics and latency histograms.
+ *
+ *  Each worker is only ever run by one thread at a time, so counters are
+ *  written with plain read-modify-write sequences published through relaxed
+ *  atomic stores; readers copy them with relaxed atomic loads.
+ *
+ *  \copyright
+ *  Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdio.h>
+ #include <string.h>
+
+ #include "workerManagerPrivate.h"
+
+ #define STATS_LOAD(field)          __atomic_load_n(&(field), __ATOMIC_RELAXED)
+ #define STATS_STORE(field, value)  __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+
+ uint32_t workerStats_bucket(uint64_t value)
+ {
+     if (value < WORKERSTATS_SUB_BUCKETS)
+         return (uint32_t)value;
+
+     uint32_t exponent = 63u - (uint32_t)__builtin_clzll(value);
+     if (exponent > WORKERSTATS_MAX_EXPONENT)
+         return WORKERSTATS_BUCKETS - 1u;
+
+     uint32_t sub = (uint32_t)(value >> (exponent - WORKERSTATS_SUB_BITS)) & (WORKERSTATS_SUB_BUCKETS - 1u);
+     return ((exponent - WORKERSTATS_SUB_BITS + 1u) * WORKERSTATS_SUB_BUCKETS) + sub;
+ }
+
+ uint64_t workerStats_bucketValue(uint32_t bucket)
+ {
+     if (bucket < WORKERSTATS_SUB_BUCKETS)
+         return bucket;
+
+     uint32_t exponent = (bucket / WORKERSTATS_SUB_BUCKETS) + WORKERSTATS_SUB_BITS - 1u;
+     uint64_t sub = bucket % WORKERSTATS_SUB_BUCKETS;
+     return (1ull << exponent) + (sub << (exponent - WORKERSTATS_SUB_BITS));
+ }
+
+ uint64_t workerStats_percentile(const uint32_t *histogram, double percentile)
+ {
+     uint64_t total = 0;
+     for (uint32_t i = 0; i < WORKERSTATS_BUCKETS; i++)
+         total += STATS_LOAD(histogram[i]);
+
+     if (total == 0u)
+         return 0;
+
+     uint64_t rank = (uint64_t)(((double)total * percentile) / 100.0);
+     if (rank >= total)
+         rank = total - 1u;
+
+     uint64_t seen = 0;
+     for (uint32_t i = 0; i < WORKERSTATS_BUCKETS; i++) {
+         seen += STATS_LOAD(histogram[i]);
+         if (seen > rank)
+             return workerStats_bucketValue(i);
+     }
+     return workerStats_bucketValue(WORKERSTATS_BUCKETS - 1u);
+ }
+
+ #if WORKERMANAGER_STATS
+
+ void workerStats_record(workerStats_t *stats, uint64_t start, uint64_t duration, uint64_t scheduled)
+ {
+     uint64_t count = stats->invocations;
+
+     if ((count == 0u) || (duration < stats->runMin))
+         STATS_STORE(stats->runMin, duration);
+     if (duration > stats->runMax)
+         STATS_STORE(stats->runMax, duration);
+     STATS_STORE(stats->runTotal, stats->runTotal + duration);
+     uint32_t bucket = workerStats_bucket(duration);
+     STATS_STORE(stats->runHistogram[bucket], stats->runHistogram[bucket] + 1u);
+
+     if ((scheduled != 0u) && (start >= scheduled)) {
+         uint64_t latency = start - scheduled;
+         if ((stats->latencySamples == 0u) || (latency < stats->latencyMin))
+             STATS_STORE(stats->latencyMin, latency);
+         if (latency > stats->latencyMax)
+             STATS_STORE(stats->latencyMax, latency);
+         STATS_STORE(stats->latencyTotal, stats->latencyTotal + latency);
+         bucket = workerStats_bucket(latency);
+         STATS_STORE(stats->latencyHistogram[bucket], stats->latencyHistogram[bucket] + 1u);
+         STATS_STORE(stats->latencySamples, stats->latencySamples + 1u);
+     }
+
+     STATS_STORE(stats->invocations, count + 1u);
+ }
+
+ void workerStats_recordOverrun(workerStats_t *stats)
+ {
+     STATS_STORE(stats->overruns, stats->overruns + 1u);
+ }
+
+ void workerStats_copy(workerStats_t *dst, const workerStats_t *src)
+ {
+     dst->invocations = STATS_LOAD(src->invocations);
+     dst->runMin = STATS_LOAD(src->runMin);
+     dst->runMax = STATS_LOAD(src->runMax);
+     dst->runTotal = STATS_LOAD(src->runTotal);
+     dst->latencySamples = STATS_LOAD(src->latencySamples);
+     dst->latencyMin = STATS_LOAD(src->latencyMin);
+     dst->latencyMax = STATS_LOAD(src->latencyMax);
+     dst->latencyTotal = STATS_LOAD(src->latencyTotal);
+     dst->overruns = STATS_LOAD(src->overruns);
+     for (uint32_t i = 0; i < WORKERSTATS_BUCKETS; i++) {
+         dst->runHistogram[i] = STATS_LOAD(src->runHistogram[i]);
+         dst->latencyHistogram[i] = STATS_LOAD(src->latencyHistogram[i]);
+     }
+ }
+
+ void workerStats_reset(workerStats_t *stats)
+ {
+     STATS_STORE(stats->invocations, 0u);
+     STATS_STORE(stats->runMin, 0u);
+     STATS_STORE(stats->runMax, 0u);
+     STATS_STORE(stats->runTotal, 0u);
+     STATS_STORE(stats->latencySamples, 0u);
+     STATS_STORE(stats->latencyMin, 0u);
+     STATS_STORE(stats->latencyMax, 0u);
+     STATS_STORE(stats->latencyTotal, 0u);
+     STATS_STORE(stats->overruns, 0u);
+     for (uint32_t i = 0; i < WORKERSTATS_BUCKETS; i++) {
+         STATS_STORE(stats->runHistogram[i], 0u);
+         STATS_STORE(stats->latencyHistogram[i], 0u);
+     }
+ }
+
+ void workerStats_print(const char *name, uint8_t prio, const workerStats_t *stats)
+ {
+     workerStats_t copy;
+     workerStats_copy(&copy, stats);
+
+     uint64_t runAvg = (copy.invocations != 0u) ? (copy.runTotal / copy.invocations) : 0u;
+     uint64_t latAvg = (copy.latencySamples != 0u) ? (copy.latencyTotal / copy.latencySamples) : 0u;
+
+     printf("%-24s prio=%u runs=%llu run(ns) min=%llu avg=%llu p99=%llu max=%llu "
+            "latency(ns) min=%llu avg=%llu p99=%llu max=%llu overruns=%llu\n",
+            name, prio,
+            (unsigned long long)copy.invocations,
+            (unsigned long long)copy.runMin, (unsigned long long)runAvg,
+            (unsigned long long)workerStats_percentile(copy.runHistogram, 99.0),
+            (unsigned long long)copy.runMax,
+            (unsigned long long)copy.latencyMin, (unsigned long long)latAvg,
+            (unsigned long long)workerStats_percentile(copy.latencyHistogram, 99.0),
+            (unsigned long long)copy.latencyMax,
+            (unsigned long long)copy.overruns);
+ }
+
+ #endif /* WORKERMANAGER_STATS */
@@ -0,0 +1,287 @@
+/**
+ * @file workerTask.c
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 12 APR 2025
+ * @brief One-shot task pool, submission queues and completion handles.
+ *
+ * A task carries a sequence number: odd while queued or running, even once
+ * complete. A handle remembers the odd value it was issued with, so it
+ * keeps reporting completion after the task object has been recycled. A
+ * task cancelled instead of run also records that value in cancelledSeq.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "workerTask.h"
+
+/**
+ * @brief Pooled one-shot task.
+ */
+typedef struct workerTask {
+    struct workerTask *next;       /**< Link in the submission queue. */
+    uint32_t nextFree;             /**< Free list link (index + 1, 0 = end). */
+    uint32_t seq;                  /**< Odd while pending, even when complete. */
+    uint32_t cancelledSeq;         /**< Last pending seq completed without running. */
+    uint8_t lock;                  /**< Guards seq transitions against taskThen. */
+    workerTaskFn_t handler;        /**< Task function. */
+    void *arg;                     /**< Task argument. */
+    workerTaskFn_t thenHandler;    /**< Continuation, run after handler. */
+    void *thenArg;                 /**< Continuation argument. */
+} workerTask_t;
+
+/*************** STATIC SECTION ***************/
+
+static workerTask_t _taskPool[WORKERMANAGER_TASK_POOL_SIZE];
+static pthread_once_t _taskPoolOnce = PTHREAD_ONCE_INIT;
+/* Free list head: ABA tag in the upper 32 bits, index + 1 in the lower. */
+static uint64_t _taskFreeHead = 0;
+/* Submission stacks, reversed by the consumer to restore FIFO order. */
+static workerTask_t *_taskQueue[WORKERMANAGER_PRIORITY_NUM] = { 0 };
+
+static pthread_mutex_t _taskDoneMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _taskDoneCond;
+static uint32_t _taskWaiters = 0;
+
+static void _taskPoolInit(void) {
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_taskDoneCond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+
+    for (uint32_t i = 0; i < WORKERMANAGER_TASK_POOL_SIZE; i++) {
+        _taskPool[i].nextFree = (i + 1u < WORKERMANAGER_TASK_POOL_SIZE) ? (i + 2u) : 0u;
+        _taskPool[i].seq = 0;
+        _taskPool[i].cancelledSeq = 0;
+    }
+    _taskFreeHead = 1u;
+}
+
+static void _taskLock(workerTask_t *task) {
+    while (__atomic_test_and_set(&task->lock, __ATOMIC_ACQUIRE)) {
+        /* Held for a handful of instructions only. */
+    }
+}
+
+static void _taskUnlock(workerTask_t *task) {
+    __atomic_clear(&task->lock, __ATOMIC_RELEASE);
+}
+
+static workerTask_t *_taskPop(void) {
+    uint64_t head = __atomic_load_n(&_taskFreeHead, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t index = (uint32_t)head;
+        if (index == 0u) {
+            return NULL;
+        }
+        uint32_t next = __atomic_load_n(&_taskPool[index - 1u].nextFree, __ATOMIC_RELAXED);
+        uint64_t newHead = ((head >> 32) + 1u) << 32 | next;
+        if (__atomic_compare_exchange_n(&_taskFreeHead, &head, newHead, 1,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return &_taskPool[index - 1u];
+        }
+    }
+}
+
+static void _taskRelease(workerTask_t *task) {
+    uint32_t index = (uint32_t)(task - _taskPool) + 1u;
+    uint64_t head = __atomic_load_n(&_taskFreeHead, __ATOMIC_RELAXED);
+    do {
+        __atomic_store_n(&task->nextFree, (uint32_t)head, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&_taskFreeHead, &head, ((head >> 32) + 1u) << 32 | index, 1,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+}
+
+/**
+ * @brief Run or cancel a task, mark it complete, run its continuation if
+ *        the task ran and recycle it.
+ */
+static void _taskComplete(workerTask_t *task, uint8_t run) {
+    if (run) {
+        task->handler(task->arg);
+    }
+
+    _taskLock(task);
+    if (!run) {
+        __atomic_store_n(&task->cancelledSeq, task->seq, __ATOMIC_RELAXED);
+    }
+    __atomic_add_fetch(&task->seq, 1u, __ATOMIC_SEQ_CST);
+    workerTaskFn_t thenHandler = task->thenHandler;
+    void *thenArg = task->thenArg;
+    task->thenHandler = NULL;
+    _taskUnlock(task);
+
+    if (run && (thenHandler != NULL)) {
+        thenHandler(thenArg);
+    }
+
+    _taskRelease(task);
+
+    if (__atomic_load_n(&_taskWaiters, __ATOMIC_SEQ_CST) != 0u) {
+        pthread_mutex_lock(&_taskDoneMutex);
+        pthread_cond_broadcast(&_taskDoneCond);
+        pthread_mutex_unlock(&_taskDoneMutex);
+    }
+}
+
+/**
+ * @brief Complete every task queued on a level, running them or not.
+ */
+static uint32_t _taskDrain(uint8_t prio, uint8_t run) {
+    if (__atomic_load_n(&_taskQueue[prio], __ATOMIC_RELAXED) == NULL) {
+        return 0;
+    }
+
+    workerTask_t *stack = __atomic_exchange_n(&_taskQueue[prio], NULL, __ATOMIC_ACQUIRE);
+    workerTask_t *fifo = NULL;
+    while (stack != NULL) {
+        workerTask_t *next = stack->next;
+        stack->next = fifo;
+        fifo = stack;
+        stack = next;
+    }
+
+    uint32_t count = 0;
+    while (fifo != NULL) {
+        workerTask_t *next = fifo->next;
+        _taskComplete(fifo, run);
+        fifo = next;
+        count++;
+    }
+
+    return count;
+}
+
+/*************** INTERNAL SECTION ***************/
+
+void *workerTask_acquire(workerTaskFn_t handler, void *arg, workerTaskHandle_t *handle) {
+    pthread_once(&_taskPoolOnce, _taskPoolInit);
+
+    workerTask_t *task = _taskPop();
+    if (task == NULL) {
+        return NULL;
+    }
+
+    task->next = NULL;
+    task->handler = handler;
+    task->arg = arg;
+    task->thenHandler = NULL;
+    task->thenArg = NULL;
+
+    handle->task = task;
+    handle->seq = __atomic_add_fetch(&task->seq, 1u, __ATOMIC_SEQ_CST);
+    return task;
+}
+
+void workerTask_push(uint8_t prio, void *task) {
+    workerTask_t *node = (workerTask_t *)task;
+    workerTask_t *head = __atomic_load_n(&_taskQueue[prio], __ATOMIC_RELAXED);
+    do {
+        node->next = head;
+    } while (!__atomic_compare_exchange_n(&_taskQueue[prio], &head, node, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+uint32_t workerTask_runPending(uint8_t prio) {
+    return _taskDrain(prio, 1);
+}
+
+uint32_t workerTask_cancelPending(uint8_t prio) {
+    return _taskDrain(prio, 0);
+}
+
+/*************** PUBLIC SECTION ***************/
+
+/**
+ * @brief Return 1 if the task behind the handle has completed, -1 for an
+ *        empty handle or a cancelled task.
+ */
+int workerManager_taskPoll(workerTaskHandle_t handle) {
+    const workerTask_t *task = (const workerTask_t *)handle.task;
+    if (task == NULL) {
+        return -1;
+    }
+
+    if (__atomic_load_n(&task->seq, __ATOMIC_ACQUIRE) == handle.seq) {
+        return 0;
+    }
+    return (__atomic_load_n(&task->cancelledSeq, __ATOMIC_RELAXED) == handle.seq) ? -1 : 1;
+}
+
+/**
+ * @brief Wait for the task behind the handle to complete.
+ */
+int workerManager_taskWait(workerTaskHandle_t handle, uint32_t timeout) {
+    if (handle.task == NULL) {
+        return -1;
+    }
+    int state = workerManager_taskPoll(handle);
+    if (state != 0) {
+        return (state == 1) ? 0 : -1;
+    }
+
+    struct timespec ts;
+    if (timeout != WORKERMANAGER_SLEEP_FOREVER) {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t deadline = ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec +
+                            ((uint64_t)timeout * 1000ull);
+        ts.tv_sec = (time_t)(deadline / 1000000000ull);
+        ts.tv_nsec = (long)(deadline % 1000000000ull);
+    }
+
+    int rc = 0;
+    pthread_mutex_lock(&_taskDoneMutex);
+    __atomic_fetch_add(&_taskWaiters, 1u, __ATOMIC_SEQ_CST);
+    while ((workerManager_taskPoll(handle) == 0) && (rc == 0)) {
+        if (timeout == WORKERMANAGER_SLEEP_FOREVER) {
+            rc = pthread_cond_wait(&_taskDoneCond, &_taskDoneMutex);
+        } else {
+            rc = pthread_cond_timedwait(&_taskDoneCond, &_taskDoneMutex, &ts);
+        }
+    }
+    __atomic_fetch_sub(&_taskWaiters, 1u, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&_taskDoneMutex);
+
+    return (workerManager_taskPoll(handle) == 1) ? 0 : -1;
+}
+
+/**
+ * @brief Attach a continuation to the task behind the handle.
+ */
+int workerManager_taskThen(workerTaskHandle_t handle, workerTaskFn_t handler, void *arg) {
+    workerTask_t *task = (workerTask_t *)handle.task;
+    if ((task == NULL) || (handler == NULL)) {
+        return -1;
+    }
+
+    int rc = 0;
+    uint8_t pending = 0;
+    _taskLock(task);
+    if (__atomic_load_n(&task->seq, __ATOMIC_ACQUIRE) == handle.seq) {
+        pending = 1;
+        if (task->thenHandler == NULL) {
+            task->thenHandler = handler;
+            task->thenArg = arg;
+        } else {
+            rc = -1;
+        }
+    }
+    _taskUnlock(task);
+
+    if (!pending) {
+        if (workerManager_taskPoll(handle) != 1) {
+            return -1;
+        }
+        handler(arg);
+    }
+
+    return rc;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file workerTask.h
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 12 APR 2025
+ * @brief Internal one-shot task pool and per-priority submission queues.
+ *
+ * Task objects come from a fixed pool and travel to the priority threads
+ * through lock-free intrusive queues, so workerManager_submit() never
+ * allocates. This header is private to the workersManager sources.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#ifndef WORKER_TASK_H
+#define WORKER_TASK_H
+
+#include <stdint.h>
+
+#include "workerManager.h"
+
+/**
+ * @brief Take a task from the pool and fill it.
+ *
+ * @param handler Function to run.
+ * @param arg Argument of the function.
+ * @param handle Receives the completion handle.
+ * @return Opaque task, NULL if the pool is exhausted.
+ */
+void *workerTask_acquire(workerTaskFn_t handler, void *arg, workerTaskHandle_t *handle);
+
+/**
+ * @brief Queue an acquired task on a priority level.
+ */
+void workerTask_push(uint8_t prio, void *task);
+
+/**
+ * @brief Run every task queued on a priority level, in submission order.
+ *
+ * Called by the priority thread only.
+ *
+ * @return Number of tasks run.
+ */
+uint32_t workerTask_runPending(uint8_t prio);
+
+/**
+ * @brief Complete every task queued on a priority level without running it.
+ *
+ * Their handles report a failure and their continuations never run. Called
+ * once no thread serves the level any more.
+ *
+ * @return Number of tasks cancelled.
+ */
+uint32_t workerTask_cancelPending(uint8_t prio);
+
+#endif // WORKER_TASK_H
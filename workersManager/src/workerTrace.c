@@ -0,0 +1,307 @@
+/**
+ * @file workerTrace.c
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 12 APR 2025
+ * @brief Per-thread trace rings and Chrome trace-event export.
+ *
+ * A ring has a single writer, its thread. Events are written word by word
+ * with relaxed atomic stores and published by bumping the ring head; the
+ * dump copies a window of events and then drops the ones the writer may
+ * have overwritten meanwhile, seqlock style, so it never stops the
+ * recording threads.
+ *
+ * Rings are never freed: a ring left by an exiting thread is adopted by
+ * the next thread that records, so the number of rings is bounded by the
+ * number of threads alive at the same time. With WORKERMANAGER_STATIC_POOLS
+ * they come from a static array of WORKERTRACE_RING_POOL_SIZE rings and
+ * the dump copies through a static buffer, so tracing never calls the heap.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#define _GNU_SOURCE                /* syscall(SYS_gettid) */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "workerManager.h"
+#include "workerManagerPrivate.h"
+#include "workerTrace.h"
+
+#if WORKERMANAGER_TRACE
+
+#define WORKERTRACE_NAME_WORDS     (WORKERTRACE_NAME_LEN / sizeof(uint64_t))
+
+/**
+ * @brief Recorded event, stored as words so it can be copied atomically.
+ */
+typedef struct {
+    uint64_t timestamp;                        /**< CLOCK_MONOTONIC ns. */
+    uint64_t name[WORKERTRACE_NAME_WORDS];     /**< Worker name, not terminated if truncated. */
+    uint64_t meta;                             /**< kind | phase << 8 | prio << 16. */
+} workerTraceEvent_t;
+
+/**
+ * @brief Event ring owned by one thread.
+ */
+typedef struct workerTraceRing {
+    struct workerTraceRing *next;              /**< Link in the ring registry. */
+    uint8_t inUse;                             /**< Owned by a live thread. */
+    uint32_t tid;                              /**< Kernel id of the owner. */
+    const char *label;                         /**< Thread label, NULL = unnamed. */
+    uint32_t index;                            /**< Number appended to the label. */
+    uint64_t base;                             /**< First event of the current owner. */
+    uint64_t head;                             /**< Events written so far. */
+    workerTraceEvent_t events[WORKERTRACE_RING_SIZE];
+} workerTraceRing_t;
+
+/*************** STATIC SECTION ***************/
+
+uint8_t workerTrace_enabled = 1;
+
+static workerTraceRing_t *_traceRings = NULL;  /**< Registry, push only. */
+static __thread workerTraceRing_t *_traceRing = NULL;
+static pthread_key_t _traceKey;
+static pthread_once_t _traceOnce = PTHREAD_ONCE_INIT;
+
+#if WORKERMANAGER_STATIC_POOLS
+static workerTraceRing_t _traceRingStorage[WORKERTRACE_RING_POOL_SIZE];
+static uint32_t _traceRingsTaken = 0;          /**< Rings of _traceRingStorage handed out. */
+static workerTraceEvent_t _traceCopy[WORKERTRACE_RING_SIZE];
+static pthread_mutex_t _traceCopyMutex = PTHREAD_MUTEX_INITIALIZER;  /**< Serializes dumps over _traceCopy. */
+#endif
+
+static const char *const _traceKindName[] = { "cycle", "init", "run", "end", "lock wait", "sleep" };
+
+/**
+ * @brief Give the ring back when its thread exits.
+ */
+static void _traceRelease(void *ring) {
+    __atomic_store_n(&((workerTraceRing_t *)ring)->inUse, 0, __ATOMIC_RELEASE);
+}
+
+static void _traceKeyInit(void) {
+    (void)pthread_key_create(&_traceKey, _traceRelease);
+}
+
+/**
+ * @brief Adopt a free ring or allocate a new one for the calling thread.
+ */
+static workerTraceRing_t *_traceAttach(void) {
+    workerTraceRing_t *ring = NULL;
+
+    pthread_once(&_traceOnce, _traceKeyInit);
+
+    for (workerTraceRing_t *it = __atomic_load_n(&_traceRings, __ATOMIC_ACQUIRE); it != NULL; it = it->next) {
+        uint8_t idle = 0;
+        if (__atomic_compare_exchange_n(&it->inUse, &idle, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            ring = it;
+            break;
+        }
+    }
+
+    if (ring == NULL) {
+#if WORKERMANAGER_STATIC_POOLS
+        uint32_t slot = __atomic_load_n(&_traceRingsTaken, __ATOMIC_RELAXED);
+        do {
+            if (slot >= WORKERTRACE_RING_POOL_SIZE) {
+                return NULL;
+            }
+        } while (!__atomic_compare_exchange_n(&_traceRingsTaken, &slot, slot + 1u, 1,
+                                              __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        ring = &_traceRingStorage[slot];
+#else
+        ring = calloc(1, sizeof(workerTraceRing_t));
+        if (ring == NULL) {
+            return NULL;
+        }
+#endif
+        ring->inUse = 1;
+        workerTraceRing_t *head = __atomic_load_n(&_traceRings, __ATOMIC_RELAXED);
+        do {
+            ring->next = head;
+        } while (!__atomic_compare_exchange_n(&_traceRings, &head, ring, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+
+    /* Events of the previous owner are not attributed to this thread. */
+    __atomic_store_n(&ring->tid, (uint32_t)syscall(SYS_gettid), __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->label, NULL, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->base, __atomic_load_n(&ring->head, __ATOMIC_RELAXED), __ATOMIC_RELEASE);
+    (void)pthread_setspecific(_traceKey, ring);
+    _traceRing = ring;
+    return ring;
+}
+
+/*************** INTERNAL SECTION ***************/
+
+void workerTrace_record(uint8_t kind, char phase, uint8_t prio, const char *name) {
+    workerTraceRing_t *ring = _traceRing;
+    if ((ring == NULL) && ((ring = _traceAttach()) == NULL)) {
+        return;
+    }
+
+    uint64_t head = ring->head;
+    workerTraceEvent_t *event = &ring->events[head & (WORKERTRACE_RING_SIZE - 1u)];
+    uint64_t words[WORKERTRACE_NAME_WORDS] = { 0 };
+
+    if (name != NULL) {
+        memcpy(words, name, WORKERTRACE_NAME_LEN);
+    }
+
+    __atomic_store_n(&event->timestamp, workerManager_nowNs(), __ATOMIC_RELAXED);
+    for (uint32_t i = 0; i < WORKERTRACE_NAME_WORDS; i++) {
+        __atomic_store_n(&event->name[i], words[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&event->meta, (uint64_t)kind | ((uint64_t)(uint8_t)phase << 8) | ((uint64_t)prio << 16),
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, head + 1u, __ATOMIC_RELEASE);
+}
+
+void workerTrace_setThreadName(const char *label, uint32_t index) {
+    workerTraceRing_t *ring = _traceRing;
+    if ((ring == NULL) && ((ring = _traceAttach()) == NULL)) {
+        return;
+    }
+
+    __atomic_store_n(&ring->index, index, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->label, label, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Write the events of one ring still present after the copy.
+ *
+ * @return Number of events written.
+ */
+static uint32_t _traceDumpRing(FILE *file, workerTraceRing_t *ring, workerTraceEvent_t *copy, uint8_t *first) {
+    int pid = (int)getpid();
+    uint32_t tid = __atomic_load_n(&ring->tid, __ATOMIC_RELAXED);
+    const char *label = __atomic_load_n(&ring->label, __ATOMIC_ACQUIRE);
+    uint32_t index = __atomic_load_n(&ring->index, __ATOMIC_RELAXED);
+    uint64_t base = __atomic_load_n(&ring->base, __ATOMIC_ACQUIRE);
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t start = (head > WORKERTRACE_RING_SIZE) ? (head - WORKERTRACE_RING_SIZE) : 0u;
+
+    if (start < base) {
+        start = base;
+    }
+
+    for (uint64_t i = start; i < head; i++) {
+        const workerTraceEvent_t *event = &ring->events[i & (WORKERTRACE_RING_SIZE - 1u)];
+        workerTraceEvent_t *dst = &copy[i - start];
+        dst->timestamp = __atomic_load_n(&event->timestamp, __ATOMIC_RELAXED);
+        for (uint32_t w = 0; w < WORKERTRACE_NAME_WORDS; w++) {
+            dst->name[w] = __atomic_load_n(&event->name[w], __ATOMIC_RELAXED);
+        }
+        dst->meta = __atomic_load_n(&event->meta, __ATOMIC_RELAXED);
+    }
+
+    /* Slots rewritten while copying are dropped. */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t after = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint64_t valid = (after >= WORKERTRACE_RING_SIZE) ? (after - WORKERTRACE_RING_SIZE + 1u) : 0u;
+
+    if (label != NULL) {
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                *first ? "" : ",", pid, tid, label, index);
+        *first = 0;
+    }
+
+    uint32_t written = 0;
+    for (uint64_t i = (valid > start) ? valid : start; i < head; i++) {
+        const workerTraceEvent_t *event = &copy[i - start];
+        uint8_t kind = (uint8_t)(event->meta & 0xFFu);
+        char phase = (char)((event->meta >> 8) & 0xFFu);
+        uint8_t prio = (uint8_t)((event->meta >> 16) & 0xFFu);
+        char name[WORKERTRACE_NAME_LEN + 1u];
+
+        if (kind >= (sizeof(_traceKindName) / sizeof(_traceKindName[0]))) {
+            continue;
+        }
+
+        memcpy(name, event->name, WORKERTRACE_NAME_LEN);
+        name[WORKERTRACE_NAME_LEN] = '\0';
+        for (char *c = name; *c != '\0'; c++) {
+            if ((*c == '"') || (*c == '\\') || ((unsigned char)*c < 0x20u)) {
+                *c = '_';
+            }
+        }
+
+        fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%d,\"tid\":%u,"
+                "\"args\":{\"prio\":%u}}",
+                *first ? "" : ",", (name[0] != '\0') ? name : _traceKindName[kind], _traceKindName[kind], phase,
+                (unsigned long long)(event->timestamp / 1000u), (unsigned)(event->timestamp % 1000u),
+                pid, tid, prio);
+        *first = 0;
+        written++;
+    }
+
+    return written;
+}
+
+#endif /* WORKERMANAGER_TRACE */
+
+/*************** PUBLIC SECTION ***************/
+
+/**
+ * @brief Pause or resume recording.
+ */
+void workerManager_traceEnable(uint8_t enable) {
+#if WORKERMANAGER_TRACE
+    __atomic_store_n(&workerTrace_enabled, enable ? 1u : 0u, __ATOMIC_RELAXED);
+#else
+    (void)enable;
+#endif
+}
+
+/**
+ * @brief Write the recorded events as Chrome trace-event JSON.
+ */
+int workerManager_traceDump(const char *path) {
+#if WORKERMANAGER_TRACE
+    if (path == NULL) {
+        return -1;
+    }
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Error: unable to open trace file %s\n", path);
+        return -1;
+    }
+
+#if WORKERMANAGER_STATIC_POOLS
+    workerTraceEvent_t *copy = _traceCopy;
+    pthread_mutex_lock(&_traceCopyMutex);
+#else
+    workerTraceEvent_t *copy = malloc(WORKERTRACE_RING_SIZE * sizeof(workerTraceEvent_t));
+    if (copy == NULL) {
+        printf("Error: unable to allocate trace buffer\n");
+        fclose(file);
+        return -1;
+    }
+#endif
+
+    uint8_t first = 1;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (workerTraceRing_t *ring = __atomic_load_n(&_traceRings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        (void)_traceDumpRing(file, ring, copy, &first);
+    }
+    fprintf(file, "\n]}\n");
+
+#if WORKERMANAGER_STATIC_POOLS
+    pthread_mutex_unlock(&_traceCopyMutex);
+#else
+    free(copy);
+#endif
+    return (fclose(file) == 0) ? 0 : -1;
+#else
+    (void)path;
+    printf("workerManager: tracing disabled (build with WORKERMANAGER_TRACE=1)\n");
+    return -1;
+#endif
+}
@@ -0,0 +1,125 @@
+/**
+ * @file workerTrace.h
+ * @author Bruno Ragucci - Embedded software engineer
+ * @date 12 APR 2025
+ * @brief Internal execution tracing into per-thread rings.
+ *
+ * Every thread that records gets its own ring of WORKERTRACE_RING_SIZE
+ * events on its first event, so recording is a clock read and a handful
+ * of stores with no lock and no shared cache line. The rings keep the
+ * most recent events; workerManager_traceDump() writes them out as Chrome
+ * trace-event JSON.
+ *
+ * Tracing is compiled in with WORKERMANAGER_TRACE=1 and can then be
+ * paused at run time with workerManager_traceEnable().
+ *
+ * This header is private to the workersManager sources.
+ *
+ * @copyright
+ * Copyright (c) 2025 Bruno Ragucci.
+ * MIT License.
+ */
+
+#ifndef WORKER_TRACE_H
+#define WORKER_TRACE_H
+
+#include <stdint.h>
+
+/**
+ * @def WORKERMANAGER_TRACE
+ * @brief Set to 1 to compile execution tracing in.
+ */
+#ifndef WORKERMANAGER_TRACE
+#define WORKERMANAGER_TRACE                    0
+#endif
+
+/**
+ * @def WORKERTRACE_RING_SIZE
+ * @brief Events kept per thread (power of two).
+ */
+#ifndef WORKERTRACE_RING_SIZE
+#define WORKERTRACE_RING_SIZE                  4096u
+#endif
+
+/**
+ * @def WORKERTRACE_RING_POOL_SIZE
+ * @brief Rings available with WORKERMANAGER_STATIC_POOLS: every dispatch
+ *        thread a level can have, the executor pool, plus a few for the
+ *        watchdog and application threads. Threads beyond it record nothing.
+ */
+#ifndef WORKERTRACE_RING_POOL_SIZE
+#define WORKERTRACE_RING_POOL_SIZE             ((WORKERMANAGER_PRIORITY_NUM * 4u) + \
+                                                WORKERMANAGER_MAX_EXECUTOR_THREADS + 4u)
+#endif
+
+/**
+ * @def WORKERTRACE_NAME_LEN
+ * @brief Bytes of the worker name copied into each event.
+ */
+#define WORKERTRACE_NAME_LEN                   24u
+
+/**
+ * @brief Traced activities.
+ */
+typedef enum {
+    WORKERTRACE_CYCLE = 0,         /**< Pass of a priority thread over its list. */
+    WORKERTRACE_INIT,              /**< worker_handleInit(). */
+    WORKERTRACE_RUN,               /**< Run handler of a worker. */
+    WORKERTRACE_END,               /**< worker_handleEnd(). */
+    WORKERTRACE_LOCK,              /**< Contended wait on a list mutex. */
+    WORKERTRACE_SLEEP              /**< Priority thread waiting for work. */
+} workerTraceKind_t;
+
+/**
+ * @def WORKERTRACE_BEGIN / WORKERTRACE_FINISH
+ * @brief Chrome trace-event phases.
+ */
+#define WORKERTRACE_BEGIN                      'B'
+#define WORKERTRACE_FINISH                     'E'
+
+#if WORKERMANAGER_TRACE
+
+extern uint8_t workerTrace_enabled;
+
+/**
+ * @brief Return 1 while events are being recorded.
+ */
+#define WORKERTRACE_ACTIVE()   (__atomic_load_n(&workerTrace_enabled, __ATOMIC_RELAXED) != 0u)
+
+/**
+ * @brief Record an event if tracing is enabled.
+ */
+#define WORKERTRACE_RECORD(kind, phase, prio, name)                         \
+    do {                                                                    \
+        if (WORKERTRACE_ACTIVE()) {                                         \
+            workerTrace_record((kind), (phase), (prio), (name));            \
+        }                                                                   \
+    } while (0)
+
+/**
+ * @brief Append an event to the calling thread's ring.
+ *
+ * @param kind One of workerTraceKind_t.
+ * @param phase WORKERTRACE_BEGIN or WORKERTRACE_FINISH.
+ * @param prio Priority level the event belongs to.
+ * @param name Worker name (at least WORKERTRACE_NAME_LEN readable bytes), NULL for none.
+ */
+void workerTrace_record(uint8_t kind, char phase, uint8_t prio, const char *name);
+
+/**
+ * @brief Label the calling thread in the trace, e.g. ("priority", 2).
+ *
+ * @param label Static string.
+ * @param index Number appended to the label.
+ */
+void workerTrace_setThreadName(const char *label, uint32_t index);
+
+#else
+
+#define WORKERTRACE_ACTIVE()                           0
+#define WORKERTRACE_RECORD(kind, phase, prio, name)    do { } while (0)
+#define workerTrace_setThreadName(label, index)        do { (void)(label); (void)(index); } while (0)
+
+#endif /* WORKERMANAGER_TRACE */
+
+#endif // WORKER_TRACE_H
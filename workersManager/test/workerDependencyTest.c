@@ -0,0 +1,164 @@
+/**
+ *  \file workerDependencyTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Worker dependency test: a fan-in released only once every
+ *         predecessor completed, a chain crossing priority levels and the
+ *         edges workerManager_addDependency() refuses.
+ *
+ *  Usage: workerDependencyTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdio.h>
+ #include <stdint.h>
+ #include <unistd.h>
+
+ #include "workerManager.h"
+
+ #define TEST_TIMEOUT_MS        2000u
+ #define TEST_QUIET_US          20000u   /* Time a blocked worker is watched for an early run. */
+ #define TEST_PERIODIC          0u       /* Level running a cycle every millisecond. */
+ #define TEST_ON_DEMAND         1u       /* Level running only when notified. */
+
+ /**
+  * @brief Worker under test and its run count.
+  */
+ typedef struct {
+     worker_t *worker;
+     uint32_t runs;                 /**< Completed runs (atomic). */
+ } testWorker_t;
+
+ static int test_failures = 0;
+
+ static void test_check(int condition, const char *what) {
+     if (condition == 0) {
+         printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static uint32_t test_load(const uint32_t *counter) {
+     return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+ }
+
+ /* Wait until *counter reaches value, 0 on timeout. */
+ static int test_waitFor(const uint32_t *counter, uint32_t value) {
+     for (uint32_t ms = 0; ms < TEST_TIMEOUT_MS; ms++) {
+         if (test_load(counter) >= value) {
+             return 1;
+         }
+         usleep(1000);
+     }
+     return 0;
+ }
+
+ /* The counter stays at value for a while. */
+ static int test_stays(const uint32_t *counter, uint32_t value) {
+     usleep(TEST_QUIET_US);
+     return test_load(counter) == value;
+ }
+
+ static void test_run(void *arg) {
+     __atomic_add_fetch(&((testWorker_t *)arg)->runs, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_make(testWorker_t *test, char *name) {
+     worker_makeWorker(name, &test->worker);
+     test->runs = 0;
+     test->worker->run.handler = test_run;
+     test->worker->run.args = test;
+ }
+
+ /* Notify a source worker and wait for its run. */
+ static int test_fire(testWorker_t *test) {
+     uint32_t runs = test_load(&test->runs);
+     workerManager_notify(test->worker);
+     return test_waitFor(&test->runs, runs + 1u);
+ }
+
+ static void test_nothing(void *arg) {
+     (void)arg;
+ }
+
+ /* The first pass of a level runs every worker without a period: let it go by. */
+ static int test_settle(uint8_t prio) {
+     workerTaskHandle_t handle = workerManager_submit(test_nothing, NULL, prio);
+     return workerManager_taskWait(handle, TEST_TIMEOUT_MS * 1000u) == 0;
+ }
+
+ int main(void) {
+     workerManagerConfig_t config;
+     testWorker_t a;
+     testWorker_t b;
+     testWorker_t join;
+     testWorker_t tail;
+
+     workerManager_getDefaultConfig(&config);
+     config.priorityNum = 2;
+     config.priority[TEST_PERIODIC].sleepTime = 1000;
+     config.priority[TEST_ON_DEMAND].sleepTime = WORKERMANAGER_SLEEP_FOREVER;
+     if (workerManager_initEx(&config) != 0) {
+         printf("Error: init\n");
+         return 1;
+     }
+     test_check(test_settle(TEST_PERIODIC) && test_settle(TEST_ON_DEMAND), "first pass");
+
+     /* a, b -> join (periodic level) -> tail (back on the on demand level). */
+     test_make(&a, "a");
+     test_make(&b, "b");
+     test_make(&join, "join");
+     test_make(&tail, "tail");
+     test_check(workerManager_addDependency(join.worker, a.worker) == 0, "edge a -> join");
+     test_check(workerManager_addDependency(join.worker, b.worker) == 0, "edge b -> join");
+     test_check(workerManager_addDependency(tail.worker, join.worker) == 0, "edge join -> tail");
+
+     test_check(workerManager_addDependency(join.worker, a.worker) == -1, "duplicate edge accepted");
+     test_check(workerManager_addDependency(a.worker, tail.worker) == -1, "cycle accepted");
+     test_check(workerManager_addDependency(a.worker, a.worker) == -1, "self edge accepted");
+
+     workerManager_addWorker(a.worker, TEST_ON_DEMAND);
+     workerManager_addWorker(b.worker, TEST_ON_DEMAND);
+     workerManager_addWorker(join.worker, TEST_PERIODIC);
+     workerManager_addWorker(tail.worker, TEST_ON_DEMAND);
+     test_check(workerManager_waitWorker(tail.worker, TEST_TIMEOUT_MS * 1000u) == 0, "add not applied");
+
+     /* The periodic cycle does not run a worker with predecessors. */
+     test_check(test_stays(&join.runs, 0u), "join ran on the level cycle");
+
+     /* Fan-in: released by the last predecessor only. */
+     test_check(test_fire(&a), "a not run");
+     test_check(test_stays(&join.runs, 0u), "join ran with b pending");
+     test_check(test_fire(&b), "b not run");
+     test_check(test_waitFor(&join.runs, 1u), "join not released");
+     test_check(test_waitFor(&tail.runs, 1u), "tail not released across levels");
+     test_check(test_stays(&join.runs, 1u) && (test_load(&tail.runs) == 1u), "released more than once");
+
+     /* Two runs of a count as one completion, b is still missing. */
+     test_check(test_fire(&a) && test_fire(&a), "a not run again");
+     test_check(test_stays(&join.runs, 1u), "join ran without b");
+     test_check(test_fire(&b), "b not run again");
+     test_check(test_waitFor(&tail.runs, 2u), "pipeline not released again");
+     test_check(test_stays(&join.runs, 2u) && (test_load(&tail.runs) == 2u), "released more than once");
+
+     /* Successors before their predecessors. */
+     workerManager_removeWorker(tail.worker);
+     workerManager_removeWorker(join.worker);
+     workerManager_removeWorker(a.worker);
+     workerManager_removeWorker(b.worker);
+     workerManager_end();
+
+     worker_destroyWorker(a.worker);
+     worker_destroyWorker(b.worker);
+     worker_destroyWorker(join.worker);
+     worker_destroyWorker(tail.worker);
+
+     return (test_failures == 0) ? 0 : 1;
+ }
@@ -0,0 +1,215 @@
+/**
+ *  \file workerLifecycleTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Worker lifecycle test: stop and start on a running level, init
+ *         and end alternating and running on the level thread, notifications
+ *         sent to a stopped worker and the end handlers run by
+ *         workerManager_end().
+ *
+ *  Usage: workerLifecycleTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <pthread.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #include <unistd.h>
+
+ #include "workerManager.h"
+
+ #define TEST_TIMEOUT_MS        2000u
+ #define TEST_QUIET_US          20000u   /* Time a stopped worker is watched for a late run. */
+ #define TEST_TOGGLES           100u
+ #define TEST_PERIODIC          0u       /* Level running a cycle every millisecond. */
+ #define TEST_ON_DEMAND         1u       /* Level running only when notified. */
+
+ /**
+  * @brief Worker under test and what its handlers saw.
+  */
+ typedef struct {
+     worker_t *worker;
+     uint32_t runs;                 /**< Completed runs (atomic). */
+     uint32_t inits;                /**< init handler calls (atomic). */
+     uint32_t ends;                 /**< end handler calls (atomic). */
+     uint32_t foreign;              /**< Handler calls off the thread of the first init. */
+     uint8_t known;                 /**< thread is set. */
+     pthread_t thread;              /**< Thread of the first init. */
+ } testWorker_t;
+
+ static int test_failures = 0;
+
+ static void test_check(int condition, const char *what) {
+     if (condition == 0) {
+         printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static uint32_t test_load(const uint32_t *counter) {
+     return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+ }
+
+ /* Wait until *counter reaches value, 0 on timeout. */
+ static int test_waitFor(const uint32_t *counter, uint32_t value) {
+     for (uint32_t ms = 0; ms < TEST_TIMEOUT_MS; ms++) {
+         if (test_load(counter) >= value) {
+             return 1;
+         }
+         usleep(1000);
+     }
+     return 0;
+ }
+
+ /* Every handler of a worker runs on the thread of its level. */
+ static void test_thread(testWorker_t *test) {
+     if (!test->known) {
+         test->thread = pthread_self();
+         test->known = 1;
+     } else if (!pthread_equal(test->thread, pthread_self())) {
+         test->foreign++;
+     }
+ }
+
+ static void test_init(void *arg) {
+     testWorker_t *test = (testWorker_t *)arg;
+     test_thread(test);
+     __atomic_add_fetch(&test->inits, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_end(void *arg) {
+     testWorker_t *test = (testWorker_t *)arg;
+     test_thread(test);
+     __atomic_add_fetch(&test->ends, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_run(void *arg) {
+     testWorker_t *test = (testWorker_t *)arg;
+     test_thread(test);
+     __atomic_add_fetch(&test->runs, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_make(testWorker_t *test, char *name) {
+     worker_makeWorker(name, &test->worker);
+     test->runs = 0;
+     test->inits = 0;
+     test->ends = 0;
+     test->foreign = 0;
+     test->known = 0;
+     test->worker->init.handler = test_init;
+     test->worker->init.args = test;
+     test->worker->run.handler = test_run;
+     test->worker->run.args = test;
+     test->worker->end.handler = test_end;
+     test->worker->end.args = test;
+ }
+
+ /* The worker does not run for a while. */
+ static int test_quiet(const testWorker_t *test) {
+     uint32_t runs = test_load(&test->runs);
+     usleep(TEST_QUIET_US);
+     return test_load(&test->runs) == runs;
+ }
+
+ static int test_applied(const testWorker_t *test) {
+     return workerManager_waitWorker(test->worker, TEST_TIMEOUT_MS * 1000u) == 0;
+ }
+
+ /* stop/start on a periodic level: end then init, no run while stopped. */
+ static void test_stopStart(testWorker_t *test) {
+     test_make(test, "periodic");
+     workerManager_addWorker(test->worker, TEST_PERIODIC);
+     test_check(test_applied(test) && (test_load(&test->inits) == 1u), "stop/start: init not run");
+     test_check(test_waitFor(&test->runs, 3u), "stop/start: not running");
+
+     workerManager_stopWorker(test->worker);
+     test_check(test->worker->metadata.status == WORKER_STATUS_IDLE, "stop/start: status not IDLE on return");
+     test_check(test_applied(test) && (test_load(&test->ends) == 1u), "stop/start: end not run");
+     test_check(test_quiet(test), "stop/start: stopped worker ran");
+
+     workerManager_startWorker(test->worker);
+     test_check(test->worker->metadata.status == WORKER_STATUS_ACTIVE, "stop/start: status not ACTIVE on return");
+     test_check(test_applied(test) && (test_load(&test->inits) == 2u), "stop/start: init not run again");
+     uint32_t runs = test_load(&test->runs);
+     test_check(test_waitFor(&test->runs, runs + 3u), "stop/start: not running after start");
+
+     /* Toggles the thread may not see one by one: init and end still alternate. */
+     for (uint32_t i = 0; i < TEST_TOGGLES; i++) {
+         workerManager_stopWorker(test->worker);
+         workerManager_startWorker(test->worker);
+     }
+     test_check(test_applied(test), "toggles: not applied");
+     test_check(test_load(&test->inits) == test_load(&test->ends) + 1u, "toggles: init/end not alternating");
+     runs = test_load(&test->runs);
+     test_check(test_waitFor(&test->runs, runs + 3u), "toggles: not running");
+ }
+
+ /* A notification sent while stopped is dropped, not run after the start. */
+ static void test_notifyStopped(testWorker_t *test) {
+     test_make(test, "onDemand");
+     workerManager_addWorker(test->worker, TEST_ON_DEMAND);
+     test_check(test_applied(test) && test_quiet(test) && (test_load(&test->runs) == 0u), "notify: ran unnotified");
+
+     workerManager_notify(test->worker);
+     test_check(test_waitFor(&test->runs, 1u), "notify: not run");
+     test_check(test_quiet(test) && (test_load(&test->runs) == 1u), "notify: ran more than once");
+
+     workerManager_stopWorker(test->worker);
+     test_check(test_applied(test), "notify: stop not applied");
+     workerManager_notify(test->worker);
+     test_check(test_quiet(test) && (test_load(&test->runs) == 1u), "notify: stopped worker ran");
+
+     workerManager_startWorker(test->worker);
+     test_check(test_applied(test) && (test_load(&test->inits) == 2u), "notify: start not applied");
+     test_check(test_quiet(test) && (test_load(&test->runs) == 1u), "notify: stale notification ran");
+
+     workerManager_notify(test->worker);
+     test_check(test_waitFor(&test->runs, 2u), "notify: not run after start");
+ }
+
+ static void test_nothing(void *arg) {
+     (void)arg;
+ }
+
+ /* The first pass of a level runs every worker without a period: let it go by. */
+ static int test_settle(uint8_t prio) {
+     workerTaskHandle_t handle = workerManager_submit(test_nothing, NULL, prio);
+     return workerManager_taskWait(handle, TEST_TIMEOUT_MS * 1000u) == 0;
+ }
+
+ int main(void) {
+     workerManagerConfig_t config;
+     testWorker_t periodic;
+     testWorker_t onDemand;
+
+     workerManager_getDefaultConfig(&config);
+     config.priorityNum = 2;
+     config.priority[TEST_PERIODIC].sleepTime = 1000;
+     config.priority[TEST_ON_DEMAND].sleepTime = WORKERMANAGER_SLEEP_FOREVER;
+     if (workerManager_initEx(&config) != 0) {
+         printf("Error: init\n");
+         return 1;
+     }
+     test_check(test_settle(TEST_ON_DEMAND), "first pass");
+
+     test_stopStart(&periodic);
+     test_notifyStopped(&onDemand);
+
+     /* Still active workers end with the manager. */
+     workerManager_end();
+     test_check(test_load(&periodic.ends) == test_load(&periodic.inits), "end: periodic worker not ended");
+     test_check(test_load(&onDemand.ends) == test_load(&onDemand.inits), "end: on demand worker not ended");
+     test_check((periodic.foreign == 0u) && (onDemand.foreign == 0u), "handlers off the level thread");
+
+     worker_destroyWorker(periodic.worker);
+     worker_destroyWorker(onDemand.worker);
+
+     return (test_failures == 0) ? 0 : 1;
+ }
@@ -0,0 +1,218 @@
+/**
+ *  \file workerSnapshotTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Worker list update test: workers added and removed while their
+ *         level runs, from another thread and from a handler of the same
+ *         level, checking that a removed worker has ended and never runs
+ *         again.
+ *
+ *  Usage: workerSnapshotTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <pthread.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #include <unistd.h>
+
+ #include "workerManager.h"
+
+ #define TEST_TIMEOUT_MS        2000u
+ #define TEST_QUIET_US          20000u   /* Time a removed worker is watched for a late run. */
+ #define TEST_CHURN             200u
+
+ /**
+  * @brief Worker under test and what its handlers saw.
+  */
+ typedef struct {
+     worker_t *worker;
+     uint32_t runs;                 /**< Completed runs (atomic). */
+     uint32_t inits;                /**< init handler calls (atomic). */
+     uint32_t ends;                 /**< end handler calls (atomic). */
+     uint32_t removeAt;             /**< Run that removes victim, 0 = never. */
+     worker_t *victim;              /**< Worker removed by that run, NULL = itself. */
+ } testWorker_t;
+
+ static int test_failures = 0;
+
+ static void test_check(int condition, const char *what) {
+     if (condition == 0) {
+         printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static uint32_t test_load(const uint32_t *counter) {
+     return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+ }
+
+ /* Wait until *counter reaches value, 0 on timeout. */
+ static int test_waitFor(const uint32_t *counter, uint32_t value) {
+     for (uint32_t ms = 0; ms < TEST_TIMEOUT_MS; ms++) {
+         if (test_load(counter) >= value) {
+             return 1;
+         }
+         usleep(1000);
+     }
+     return 0;
+ }
+
+ static void test_init(void *arg) {
+     __atomic_add_fetch(&((testWorker_t *)arg)->inits, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_end(void *arg) {
+     __atomic_add_fetch(&((testWorker_t *)arg)->ends, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_run(void *arg) {
+     testWorker_t *test = (testWorker_t *)arg;
+     uint32_t run = test->runs + 1u;
+
+     /* Removal queued before the run is visible to the main thread. */
+     if (run == test->removeAt) {
+         workerManager_removeWorker((test->victim != NULL) ? test->victim : test->worker);
+     }
+     __atomic_store_n(&test->runs, run, __ATOMIC_RELEASE);
+ }
+
+ static void test_make(testWorker_t *test, char *name) {
+     worker_makeWorker(name, &test->worker);
+     test->runs = 0;
+     test->inits = 0;
+     test->ends = 0;
+     test->removeAt = 0;
+     test->victim = NULL;
+     test->worker->init.handler = test_init;
+     test->worker->init.args = test;
+     test->worker->run.handler = test_run;
+     test->worker->run.args = test;
+     test->worker->end.handler = test_end;
+     test->worker->end.args = test;
+ }
+
+ /* A removed worker does not run for a while. */
+ static int test_quiet(const testWorker_t *test) {
+     uint32_t runs = test_load(&test->runs);
+     usleep(TEST_QUIET_US);
+     return test_load(&test->runs) == runs;
+ }
+
+ /* removeWorker() from another thread returns once the worker has ended. */
+ static void test_removeFromThread(void) {
+     testWorker_t kept;
+     testWorker_t removed;
+
+     test_make(&kept, "kept");
+     test_make(&removed, "removed");
+     workerManager_addWorker(kept.worker, 0);
+     workerManager_addWorker(removed.worker, 0);
+     test_check(test_waitFor(&kept.runs, 3u) && test_waitFor(&removed.runs, 3u), "thread: workers not running");
+
+     workerManager_removeWorker(removed.worker);
+     test_check(test_load(&removed.ends) == 1u, "thread: end not run on return");
+     test_check(test_quiet(&removed), "thread: removed worker ran");
+     uint32_t runs = test_load(&kept.runs);
+     test_check(test_waitFor(&kept.runs, runs + 3u), "thread: other worker stalled");
+     test_check(test_load(&kept.ends) == 0u, "thread: other worker ended");
+
+     workerManager_removeWorker(kept.worker);
+     test_check((test_load(&kept.inits) == 1u) && (test_load(&kept.ends) == 1u), "thread: init/end count");
+     worker_destroyWorker(kept.worker);
+     worker_destroyWorker(removed.worker);
+ }
+
+ /* A handler removes its own worker, then another worker of its level. */
+ static void test_removeFromHandler(void) {
+     testWorker_t self;
+     testWorker_t remover;
+     testWorker_t victim;
+
+     test_make(&self, "self");
+     self.removeAt = 3u;
+     workerManager_addWorker(self.worker, 0);
+     test_check(test_waitFor(&self.runs, 3u), "handler: self not running");
+     test_check(workerManager_waitWorker(self.worker, TEST_TIMEOUT_MS * 1000u) == 0, "handler: self removal not applied");
+     test_check(test_load(&self.ends) == 1u, "handler: self not ended");
+     test_check(test_quiet(&self) && (test_load(&self.runs) == 3u), "handler: self ran after its removal");
+
+     /* The victim follows the remover in the list: it must not run later in the same pass. */
+     test_make(&remover, "remover");
+     test_make(&victim, "victim");
+     workerManager_addWorker(remover.worker, 0);
+     workerManager_addWorker(victim.worker, 0);
+     test_check(test_waitFor(&victim.runs, 1u), "handler: victim not running");
+     uint32_t at = test_load(&remover.runs) + 2u;
+     remover.victim = victim.worker;
+     __atomic_store_n(&remover.removeAt, at, __ATOMIC_RELEASE);
+     test_check(test_waitFor(&remover.runs, at), "handler: remover not running");
+     test_check(workerManager_waitWorker(victim.worker, TEST_TIMEOUT_MS * 1000u) == 0, "handler: victim removal not applied");
+     test_check(test_load(&victim.ends) == 1u, "handler: victim not ended");
+     test_check(test_quiet(&victim), "handler: victim ran after its removal");
+
+     workerManager_removeWorker(remover.worker);
+     worker_destroyWorker(self.worker);
+     worker_destroyWorker(remover.worker);
+     worker_destroyWorker(victim.worker);
+ }
+
+ static void *test_churner(void *arg) {
+     testWorker_t *test = (testWorker_t *)arg;
+
+     for (uint32_t i = 0; i < TEST_CHURN; i++) {
+         workerManager_addWorker(test->worker, (uint8_t)(i & 1u));
+         workerManager_removeWorker(test->worker);
+     }
+     return NULL;
+ }
+
+ /* Adds and removes in a loop while the levels run: init and end stay paired. */
+ static void test_churn(void) {
+     testWorker_t steady;
+     testWorker_t churned;
+     pthread_t thread;
+
+     test_make(&steady, "steady");
+     test_make(&churned, "churned");
+     workerManager_addWorker(steady.worker, 0);
+     test_check(pthread_create(&thread, NULL, test_churner, &churned) == 0, "churn: thread");
+     (void)pthread_join(thread, NULL);
+
+     test_check(test_load(&churned.inits) == test_load(&churned.ends), "churn: init/end not paired");
+     test_check(test_quiet(&churned), "churn: removed worker ran");
+     uint32_t runs = test_load(&steady.runs);
+     test_check(test_waitFor(&steady.runs, runs + 3u), "churn: steady worker stalled");
+
+     workerManager_removeWorker(steady.worker);
+     worker_destroyWorker(steady.worker);
+     worker_destroyWorker(churned.worker);
+ }
+
+ int main(void) {
+     workerManagerConfig_t config;
+
+     workerManager_getDefaultConfig(&config);
+     config.priorityNum = 2;
+     config.priority[0].sleepTime = 1000;
+     config.priority[1].sleepTime = 1000;
+     if (workerManager_initEx(&config) != 0) {
+         printf("Error: init\n");
+         return 1;
+     }
+
+     test_removeFromThread();
+     test_removeFromHandler();
+     test_churn();
+
+     workerManager_end();
+
+     return (test_failures == 0) ? 0 : 1;
+ }
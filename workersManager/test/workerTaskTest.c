@@ -0,0 +1,259 @@
+/**
+ *  \file workerTaskTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief One-shot task test: submission order, continuations attached
+ *         before and after completion, empty handles, tasks queued when
+ *         workerManager_end() is called, and submissions racing it, which
+ *         must all end up run or cancelled.
+ *
+ *  Usage: workerTaskTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <pthread.h>
+ #include <sched.h>
+ #include <stdio.h>
+ #include <stdint.h>
+ #include <unistd.h>
+
+ #include "workerManager.h"
+
+ #define TEST_TIMEOUT_US        2000000u
+ #define TEST_ORDERED           64u
+ #define TEST_QUEUED            8u
+ #define TEST_ROUNDS            20u
+ #define TEST_SUBMITTERS        2u
+ #define TEST_PER_SUBMITTER     4096u
+
+ /**
+  * @brief Handles of one submitter thread racing workerManager_end().
+  */
+ typedef struct {
+     uint8_t prio;
+     uint32_t count;                               /**< Handles filled (atomic). */
+     uint8_t done;                                 /**< Submission failed or handles full (atomic). */
+     workerTaskHandle_t handle[TEST_PER_SUBMITTER];
+     uint8_t ran[TEST_PER_SUBMITTER];              /**< Set by the task of the same index. */
+ } testSubmitter_t;
+
+ static int test_failures = 0;
+ static uint32_t test_order[TEST_ORDERED];
+ static uint32_t test_next = 0;
+ static uint32_t test_ran = 0;
+ static uint32_t test_thens = 0;
+ static pthread_t test_thenThread;
+
+ static void test_check(int condition, const char *what) {
+     if (condition == 0) {
+         printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static workerManagerConfig_t *test_config(workerManagerConfig_t *config) {
+     workerManager_getDefaultConfig(config);
+     config->priorityNum = 2;
+     config->priority[0].sleepTime = 1000;
+     config->priority[1].sleepTime = 1000;
+     return config;
+ }
+
+ /* Tasks of a level run one at a time, on its thread. */
+ static void test_record(void *arg) {
+     if (test_next < TEST_ORDERED) {
+         test_order[test_next] = (uint32_t)(uintptr_t)arg;
+     }
+     test_next++;
+ }
+
+ static uint32_t test_started = 0;
+
+ static void test_slow(void *arg) {
+     __atomic_store_n(&test_started, 1u, __ATOMIC_RELEASE);
+     usleep((useconds_t)(uintptr_t)arg);
+     __atomic_add_fetch(&test_ran, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_count(void *arg) {
+     (void)arg;
+     __atomic_add_fetch(&test_ran, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_then(void *arg) {
+     (void)arg;
+     test_thenThread = pthread_self();
+     __atomic_add_fetch(&test_thens, 1u, __ATOMIC_RELEASE);
+ }
+
+ /* Tasks of a level run in submission order. */
+ static void test_fifo(void) {
+     workerTaskHandle_t handle;
+
+     test_next = 0;
+     for (uint32_t i = 0; i < TEST_ORDERED; i++) {
+         handle = workerManager_submit(test_record, (void *)(uintptr_t)i, 0);
+         test_check(handle.task != NULL, "fifo: submit");
+     }
+     test_check(workerManager_taskWait(handle, TEST_TIMEOUT_US) == 0, "fifo: wait");
+     test_check(workerManager_taskPoll(handle) == 1, "fifo: poll after wait");
+     test_check(test_next == TEST_ORDERED, "fifo: task count");
+     for (uint32_t i = 0; i < TEST_ORDERED; i++) {
+         if (test_order[i] != i) {
+             test_check(0, "fifo: order");
+             break;
+         }
+     }
+ }
+
+ /* A continuation runs after its task, on the level thread or on the caller once completed. */
+ static void test_continuation(void) {
+     test_ran = 0;
+     test_thens = 0;
+     workerTaskHandle_t handle = workerManager_submit(test_slow, (void *)(uintptr_t)5000u, 1);
+     test_check(workerManager_taskPoll(handle) == 0, "then: slow task not pending");
+     test_check(workerManager_taskThen(handle, test_then, NULL) == 0, "then: attach to a pending task");
+     test_check(workerManager_taskThen(handle, test_then, NULL) == -1, "then: second continuation accepted");
+     test_check(workerManager_taskWait(handle, TEST_TIMEOUT_US) == 0, "then: wait");
+     for (uint32_t ms = 0; (ms < 1000u) && (__atomic_load_n(&test_thens, __ATOMIC_ACQUIRE) == 0u); ms++) {
+         usleep(1000);
+     }
+     test_check((test_ran == 1u) && (test_thens == 1u), "then: continuation not run once");
+     test_check(!pthread_equal(test_thenThread, pthread_self()), "then: pending continuation run on the caller");
+
+     test_check(workerManager_taskThen(handle, test_then, NULL) == 0, "then: attach to a completed task");
+     test_check(test_thens == 2u, "then: completed task continuation not run");
+     test_check(pthread_equal(test_thenThread, pthread_self()), "then: completed continuation off the caller");
+ }
+
+ /* Failed submissions give handles that report a failure and never hang. */
+ static void test_empty(void) {
+     workerTaskHandle_t handle = workerManager_submit(test_count, NULL, WORKERMANAGER_PRIORITY_NUM);
+
+     test_check(handle.task == NULL, "empty: invalid level accepted");
+     test_check(workerManager_taskPoll(handle) == -1, "empty: poll");
+     test_check(workerManager_taskWait(handle, TEST_TIMEOUT_US) == -1, "empty: wait");
+     test_check(workerManager_taskThen(handle, test_then, NULL) == -1, "empty: then");
+ }
+
+ /* Tasks queued behind a running one when workerManager_end() is called still run before it returns. */
+ static void test_endDrain(void) {
+     workerManagerConfig_t config;
+     workerTaskHandle_t handle[TEST_QUEUED];
+
+     test_ran = 0;
+     test_thens = 0;
+     test_started = 0;
+     if (workerManager_initEx(test_config(&config)) != 0) {
+         test_check(0, "drain: init");
+         return;
+     }
+     (void)workerManager_submit(test_slow, (void *)(uintptr_t)50000u, 1);
+     while (__atomic_load_n(&test_started, __ATOMIC_ACQUIRE) == 0u) {
+         usleep(1000);
+     }
+     for (uint32_t i = 0; i < TEST_QUEUED; i++) {
+         handle[i] = workerManager_submit(test_count, NULL, 1);
+         test_check(handle[i].task != NULL, "drain: submit");
+     }
+     test_check(workerManager_taskThen(handle[0], test_then, NULL) == 0, "drain: attach");
+     workerManager_end();
+
+     test_check(test_ran == (TEST_QUEUED + 1u), "drain: queued task not run by end");
+     test_check(test_thens == 1u, "drain: continuation not run by end");
+     for (uint32_t i = 0; i < TEST_QUEUED; i++) {
+         test_check(workerManager_taskPoll(handle[i]) == 1, "drain: poll");
+     }
+     test_check(workerManager_submit(test_count, NULL, 1).task == NULL, "drain: submit after end");
+ }
+
+ static void test_mark(void *arg) {
+     __atomic_store_n((uint8_t *)arg, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void *test_submitter(void *arg) {
+     testSubmitter_t *submitter = (testSubmitter_t *)arg;
+
+     while (submitter->count < TEST_PER_SUBMITTER) {
+         uint32_t i = submitter->count;
+         submitter->ran[i] = 0;
+         submitter->handle[i] = workerManager_submit(test_mark, &submitter->ran[i], submitter->prio);
+         if (submitter->handle[i].task == NULL) {
+             break;
+         }
+         __atomic_store_n(&submitter->count, i + 1u, __ATOMIC_RELEASE);
+         /* Let the level run its tasks instead of exhausting the pool. */
+         sched_yield();
+     }
+     __atomic_store_n(&submitter->done, 1u, __ATOMIC_RELEASE);
+     return NULL;
+ }
+
+ /* Submissions racing workerManager_end(): every handle ends up completed or cancelled. */
+ static void test_endRace(void) {
+     static testSubmitter_t submitters[TEST_SUBMITTERS];
+     workerManagerConfig_t config;
+     pthread_t threads[TEST_SUBMITTERS];
+     uint32_t pending = 0;
+     uint32_t mismatched = 0;
+
+     for (uint32_t round = 0; round < TEST_ROUNDS; round++) {
+         if (workerManager_initEx(test_config(&config)) != 0) {
+             test_check(0, "race: init");
+             return;
+         }
+         for (uint32_t i = 0; i < TEST_SUBMITTERS; i++) {
+             submitters[i].prio = (uint8_t)i;
+             submitters[i].count = 0;
+             submitters[i].done = 0;
+             (void)pthread_create(&threads[i], NULL, test_submitter, &submitters[i]);
+         }
+         /* Stop the manager while the submitters are busy. */
+         for (uint32_t i = 0; i < TEST_SUBMITTERS; i++) {
+             while ((__atomic_load_n(&submitters[i].count, __ATOMIC_ACQUIRE) < (round + 1u) * 8u) &&
+                    !__atomic_load_n(&submitters[i].done, __ATOMIC_ACQUIRE)) {
+                 sched_yield();
+             }
+         }
+         workerManager_end();
+         for (uint32_t i = 0; i < TEST_SUBMITTERS; i++) {
+             (void)pthread_join(threads[i], NULL);
+         }
+
+         /* Completed handles are exactly the tasks that ran. */
+         for (uint32_t i = 0; i < TEST_SUBMITTERS; i++) {
+             for (uint32_t j = 0; j < submitters[i].count; j++) {
+                 int poll = workerManager_taskPoll(submitters[i].handle[j]);
+                 pending += (poll == 0) ? 1u : 0u;
+                 mismatched += ((poll == 1) != (submitters[i].ran[j] != 0u)) ? 1u : 0u;
+             }
+         }
+     }
+     test_check(pending == 0u, "race: handle still pending after end");
+     test_check(mismatched == 0u, "race: handle status and run differ");
+ }
+
+ int main(void) {
+     workerManagerConfig_t config;
+
+     if (workerManager_initEx(test_config(&config)) != 0) {
+         printf("Error: init\n");
+         return 1;
+     }
+     test_fifo();
+     test_continuation();
+     test_empty();
+     workerManager_end();
+
+     test_endDrain();
+     test_endRace();
+
+     return (test_failures == 0) ? 0 : 1;
+ }
@@ -0,0 +1,163 @@
+/**
+ *  \file workerWatchdogTest.c
+ *
+ *  \author Bruno Ragucci - Embedded Software Engineer
+ *  \n mail : bruno (at) ragucci.it
+ *
+ *  \date 17 APR 2025
+ *
+ *  @brief Watchdog isolation test: a worker stuck in its run handler is
+ *         isolated while the rest of its level keeps running on a new
+ *         thread, then ended once the stuck run returns, released through
+ *         workerManager_waitWorker() and added again.
+ *
+ *  Usage: workerWatchdogTest
+ *
+ *  \copyright Copyright (c) 2025 by Bruno Ragucci - All rights reserved.
+ *  \n
+ *  \license MIT
+ */
+
+ #include <stdio.h>
+ #include <stdint.h>
+ #include <unistd.h>
+
+ #include "workerManager.h"
+
+ #define TEST_TIMEOUT_MS        2000u
+ #define TEST_EVENTS            (WORKERMANAGER_EVENT_JOIN_TIMEOUT + 1)
+
+ /**
+  * @brief Worker under test and what its handlers saw.
+  */
+ typedef struct {
+     worker_t *worker;
+     uint32_t runs;                 /**< Started runs (atomic). */
+     uint32_t inits;                /**< init handler calls (atomic). */
+     uint32_t ends;                 /**< end handler calls (atomic). */
+     uint32_t hold;                 /**< The next run blocks while set (atomic). */
+ } testWorker_t;
+
+ static int test_failures = 0;
+ static uint32_t test_events[TEST_EVENTS];
+ static worker_t *test_isolated = NULL;
+
+ static void test_check(int condition, const char *what) {
+     if (condition == 0) {
+         printf("Error: %s\n", what);
+         test_failures++;
+     }
+ }
+
+ static uint32_t test_load(const uint32_t *counter) {
+     return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+ }
+
+ /* Wait until *counter reaches value, 0 on timeout. */
+ static int test_waitFor(const uint32_t *counter, uint32_t value) {
+     for (uint32_t ms = 0; ms < TEST_TIMEOUT_MS; ms++) {
+         if (test_load(counter) >= value) {
+             return 1;
+         }
+         usleep(1000);
+     }
+     return 0;
+ }
+
+ static void test_event(uint8_t event, worker_t *worker, uint64_t elapsed, void *arg) {
+     (void)elapsed;
+     (void)arg;
+     if (event == WORKERMANAGER_EVENT_ISOLATED) {
+         test_isolated = worker;
+     }
+     if (event < TEST_EVENTS) {
+         __atomic_add_fetch(&test_events[event], 1u, __ATOMIC_RELEASE);
+     }
+ }
+
+ static void test_init(void *arg) {
+     __atomic_add_fetch(&((testWorker_t *)arg)->inits, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_end(void *arg) {
+     __atomic_add_fetch(&((testWorker_t *)arg)->ends, 1u, __ATOMIC_RELEASE);
+ }
+
+ static void test_run(void *arg) {
+     testWorker_t *test = (testWorker_t *)arg;
+
+     __atomic_add_fetch(&test->runs, 1u, __ATOMIC_RELEASE);
+     while (test_load(&test->hold) != 0u) {
+         usleep(1000);
+     }
+ }
+
+ static void test_make(testWorker_t *test, char *name) {
+     worker_makeWorker(name, &test->worker);
+     test->runs = 0;
+     test->inits = 0;
+     test->ends = 0;
+     test->hold = 0;
+     test->worker->init.handler = test_init;
+     test->worker->init.args = test;
+     test->worker->run.handler = test_run;
+     test->worker->run.args = test;
+     test->worker->end.handler = test_end;
+     test->worker->end.args = test;
+ }
+
+ int main(void) {
+     workerManagerConfig_t config;
+     testWorker_t stuck;
+     testWorker_t sibling;
+
+     workerManager_getDefaultConfig(&config);
+     config.priorityNum = 1;
+     config.priority[0].sleepTime = 1000;
+     config.watchdog.checkPeriod = 10000;
+     config.watchdog.stuckTimeout = 50000;
+     config.watchdog.action = WORKERMANAGER_WATCHDOG_ISOLATE;
+     config.watchdog.callback = test_event;
+     if (workerManager_initEx(&config) != 0) {
+         printf("Error: init\n");
+         return 1;
+     }
+
+     test_make(&stuck, "stuck");
+     test_make(&sibling, "sibling");
+     stuck.hold = 1;
+     workerManager_addWorker(sibling.worker, 0);
+     workerManager_addWorker(stuck.worker, 0);
+
+     /* Isolated while stuck: the level goes on without it, the worker is still in use. */
+     test_check(test_waitFor(&test_events[WORKERMANAGER_EVENT_ISOLATED], 1u), "stuck worker not isolated");
+     test_check(test_isolated == stuck.worker, "isolated event on another worker");
+     uint32_t runs = test_load(&sibling.runs);
+     test_check(test_waitFor(&sibling.runs, runs + 3u), "level stalled behind the stuck worker");
+     test_check(test_load(&sibling.ends) == 0u, "sibling ended by the isolation");
+     test_check(workerManager_waitWorker(stuck.worker, 1000u) == -1, "isolated worker released while stuck");
+     test_check(test_load(&stuck.ends) == 0u, "end run while stuck");
+     test_check(test_load(&test_events[WORKERMANAGER_EVENT_RECOVERED]) == 0u, "recovered while stuck");
+
+     /* The stuck run returns: ended once, then released. */
+     __atomic_store_n(&stuck.hold, 0u, __ATOMIC_RELEASE);
+     test_check(workerManager_waitWorker(stuck.worker, TEST_TIMEOUT_MS * 1000u) == 0, "isolated worker not released");
+     test_check(test_load(&test_events[WORKERMANAGER_EVENT_RECOVERED]) == 1u, "recovery not reported");
+     test_check((test_load(&stuck.ends) == 1u) && (test_load(&stuck.runs) == 1u), "isolated worker not ended once");
+
+     /* Released: it can come back. */
+     workerManager_addWorker(stuck.worker, 0);
+     test_check(workerManager_waitWorker(stuck.worker, TEST_TIMEOUT_MS * 1000u) == 0, "add again not applied");
+     test_check(test_load(&stuck.inits) == 2u, "init not run again");
+     test_check(test_waitFor(&stuck.runs, 3u), "worker added again not running");
+
+     workerManager_end();
+     test_check(test_load(&stuck.ends) == 2u, "worker added again not ended");
+     test_check(test_load(&sibling.ends) == 1u, "sibling not ended");
+     test_check(test_load(&test_events[WORKERMANAGER_EVENT_ISOLATED]) == 1u, "isolated more than once");
+
+     worker_destroyWorker(stuck.worker);
+     worker_destroyWorker(sibling.worker);
+
+     return (test_failures == 0) ? 0 : 1;
+ }